@@ -0,0 +1,160 @@
+#!/bin/sh
+# TestCase/check.sh: regression checks of the compiler
+# and the TM, run by "make check" in the compiler
+# directory. Each check prints ok or FAIL
+cd "$(dirname "$0")/.." || exit 1
+T=`pwd`/TestCase
+C=`pwd`/cminus_semantic
+TM=`pwd`/tm
+W=${TMPDIR:-/tmp}/cmcheck$$
+mkdir -p $W || exit 1
+trap 'rm -rf $W' 0
+fails=0
+
+pass() { echo "ok   $1"; }
+fail() { echo "FAIL $1"; fails=`expr $fails + 1`; }
+# same NAME EXPECTED ACTUAL
+same()
+{ if cmp -s "$2" "$3"; then pass "$1"
+  else fail "$1"; diff "$2" "$3" | head -10
+  fi
+}
+
+# compile NAME [options]: compiles TestCase/NAME.cm in $W
+compile()
+{ n=$1; shift
+  cp $T/$n.cm $W/$n.cm
+  (cd $W && $C "$@" $n.cm > $n.lst)
+}
+
+# x86-64 code: parameters homed in registers
+compile params -S
+if gcc -o $W/params $W/params.s `pwd`/cmrt.c 2>/dev/null
+then $W/params < $T/params.in > $W/params.x 2>&1
+     same "params -S" $T/params.out $W/params.x
+else fail "params -S: no executable"
+fi
+compile params
+$TM -run $W/params.tm < $T/params.in > $W/params.run 2>&1
+same "params tm" $T/params.out $W/params.run
+
+# incremental re-analysis: incr_2.cm is incr_1.cm edited;
+# the functions kept must come out as a full analysis
+# of incr_2.cm gives them, line numbers shifted
+cp $T/incr_2.cm $W/incr_2.cm
+compile incr_1 -iincr_2.cm
+grep "analysed again" $W/incr_1.lst > $W/incr.again
+echo "Functions analysed again: twice sq usesq" > $W/incr.exp
+same "incr -i: functions analysed" $W/incr.exp $W/incr.again
+compile incr_2
+banner='^$|Building Symbol|Checking Types|analysed again'
+sed -n '/COMPILATION: incr_2/,$p' $W/incr_1.lst | grep -Ev "$banner" > $W/incr.kept
+grep -Ev "$banner" $W/incr_2.lst > $W/incr.full
+same "incr -i: symbols and errors" $W/incr.full $W/incr.kept
+
+# diagnostics: diag.cm has an error repeated on a line
+# (x = v twice on line 5), errors recorded after those
+# of later lines (a condition is checked after its body)
+# and more errors than -e9 lets through: the first nine
+# recorded are kept, the repeated one is listed once
+compile diag -e9
+same "diag -e9 listing" $T/diag.txt $W/diag.lst
+
+# superinstructions: fuse.tm has each fused sequence,
+# also entered in its middle. Output, steps, registers
+# and dMem (a checkpoint at the end) must not depend on
+# fusing, also when stopped inside a sequence (-atN)
+echo "3 5" > $W/fuse.in
+for opt in -nofuse -ref ""
+do $TM -run $opt -save$W/fuse$opt.tmc $T/fuse.tm < $W/fuse.in > $W/fuse$opt.out 2>&1
+done
+same "fuse.tm -run output" $W/fuse-nofuse.out $W/fuse.out
+same "fuse.tm -run steps and state" $W/fuse-nofuse.tmc $W/fuse.tmc
+same "fuse.tm -run -ref steps and state" $W/fuse-ref.tmc $W/fuse.tmc
+n=1; bad=0
+while test $n -le 130
+do for opt in -nofuse ""
+   do $TM -run $opt -at$n -save$W/at$opt.tmc $T/fuse.tm < $W/fuse.in > $W/at$opt.out 2>&1
+   done
+   cmp -s $W/at-nofuse.out $W/at.out && cmp -s $W/at-nofuse.tmc $W/at.tmc || bad=`expr $bad + 1`
+   n=`expr $n + 1`
+done
+if test $bad -eq 0; then pass "fuse.tm -atN"; else fail "fuse.tm -atN: $bad stops differ"; fi
+$TM -run -fstats $T/fuse.tm < $W/fuse.in 2>&1 > /dev/null | sed -n '/^fused/,/^compare/p' > $W/fuse.txt
+same "fuse.tm -fstats" $T/fuse.txt $W/fuse.txt
+
+# peephole optimizer: peep.cm must run the same without
+# it (-p0), with the code of the AST and of the IR (-ir);
+# each rule must be applied (-ps) in one of the two
+for ir in "" -ir
+do compile peep $ir -p0
+   mv $W/peep.tm $W/peep0.tm
+   compile peep $ir -ps
+   $TM -run $W/peep0.tm < $T/peep.in > $W/peep0.out 2>&1
+   $TM -run $W/peep.tm < $T/peep.in > $W/peep.out 2>&1
+   same "peep${ir:+ $ir} -p0" $T/peep.out $W/peep0.out
+   same "peep${ir:+ $ir}" $T/peep.out $W/peep.out
+   sed -n '/^Peephole/,/total/p' $W/peep.lst | sed '1d;$d' >> $W/peep.ps
+done
+unused=`awk '{ n = $NF; $NF = ""; hits[$0] += n }
+             END { for (r in hits) if (hits[r] == 0) print r }' $W/peep.ps`
+if test -z "$unused" && test -s $W/peep.ps
+then pass "peep -ps: every rule applied"
+else fail "peep -ps: rules not applied: $unused"
+fi
+
+# constant folding: folded comparisons must test the
+# wrapped difference as the code does at run time, and
+# an identity (x*0, x*1, x+0) must not drop a fault of
+# x. Input k, odd, runs a folded identity, k+1 the
+# same on variables: they must stop alike
+compile fold
+echo 0 | $TM -run $W/fold.tm > $W/fold.run 2>&1
+same "fold: comparisons" $T/fold.out $W/fold.run
+# foldrun K FILE: output and status of the run on input K
+foldrun()
+{ echo $1 | $TM -run $W/fold.tm > $W/fold.tmp 2>&1
+  echo "status $?" >> $W/fold.tmp
+  sed 's/ at location [0-9]*//' $W/fold.tmp > $2
+}
+for k in 1 3 5 7
+do foldrun $k $W/fold.k
+   foldrun `expr $k + 1` $W/fold.v
+   same "fold: identity $k" $W/fold.v $W/fold.k
+done
+
+# checkpoints: ckpt.cm stopped after N steps (-atN)
+# and saved, then restored, must give the output of
+# an uninterrupted run and end in the same state
+# (registers, dMem, steps, input read), whatever
+# the dMem size and wherever the input was left
+compile ckpt
+for d in "" -d2k -d1M
+do $TM -run $d -save$W/full.tmc $W/ckpt.tm < $T/ckpt.in > $W/full.out 2>&1
+   for n in 40 400 1000 1700
+   do $TM -run $d -at$n -save$W/mid.tmc $W/ckpt.tm < $T/ckpt.in > $W/part.out 2>/dev/null
+      $TM -run -restore$W/mid.tmc -save$W/end.tmc $W/ckpt.tm < $T/ckpt.in >> $W/part.out 2>&1
+      same "ckpt $d -at$n: output" $W/full.out $W/part.out
+      same "ckpt $d -at$n: state" $W/full.tmc $W/end.tmc
+   done
+done
+# input from a pipe is skipped by reading it
+$TM -run -save$W/full.tmc $W/ckpt.tm < $T/ckpt.in > $W/full.out 2>&1
+$TM -run -at400 -save$W/mid.tmc $W/ckpt.tm < $T/ckpt.in > $W/part.out 2>/dev/null
+cat $T/ckpt.in | $TM -run -restore$W/mid.tmc -save$W/end.tmc $W/ckpt.tm >> $W/part.out 2>&1
+same "ckpt piped input: output" $W/full.out $W/part.out
+same "ckpt piped input: state" $W/full.tmc $W/end.tmc
+
+# tm -run: an IN without a value is an error
+$TM -run $W/params.tm < /dev/null > $W/noin.run 2>&1
+status=$?
+# the location of the IN depends on the code generated
+echo "Illegal value at location N" > $W/noin.exp
+sed 's/ at location [0-9][0-9]*$/ at location N/' $W/noin.run > $W/noin.out
+same "tm -run without input" $W/noin.exp $W/noin.out
+if test $status -ne 0; then pass "tm -run without input: status"
+else fail "tm -run without input: status"
+fi
+
+echo "$fails failed"
+test $fails -eq 0
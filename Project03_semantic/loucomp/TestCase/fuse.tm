@@ -0,0 +1,82 @@
+* Every fused sequence of the fast engine of tm. The
+* program runs twice: in the second pass (reg 0 = 1)
+* each sequence is entered by a jump into its middle.
+* Reads a and b, prints values showing each path
+  0:     LD  6,0(0)	load mp
+  1:     ST  0,0(0)	clear location 0
+  2:     IN  1,0,0	a
+  3:     IN  2,0,0	b
+  4:    LDC  0,0(0)	first pass
+* ST;LD
+  5:    JNE  0,1(7)	pass 2: into the LD
+  6:     ST  1,-1(6)
+  7:     LD  3,-1(6)
+  8:    OUT  3,0,0
+* LD;LD
+  9:    JNE  0,1(7)	pass 2: into the second LD
+ 10:     LD  3,-2(6)
+ 11:     LD  4,-1(6)
+ 12:    ADD  3,3,4
+ 13:    OUT  3,0,0
+* LDC;ADD
+ 14:    JNE  0,1(7)	pass 2: into the ADD
+ 15:    LDC  3,5(0)
+ 16:    ADD  3,3,1
+ 17:    OUT  3,0,0
+* LDC;SUB
+ 18:    JNE  0,1(7)	pass 2: into the SUB
+ 19:    LDC  4,2(0)
+ 20:    SUB  4,1,4
+ 21:    OUT  4,0,0
+* SUB;Jcc for each Jcc
+ 22:    JNE  0,1(7)	pass 2: into the Jcc
+ 23:    SUB  5,1,2
+ 24:    JLT  5,1(7)
+ 25:    OUT  1,0,0
+ 26:    JNE  0,1(7)
+ 27:    SUB  5,1,2
+ 28:    JLE  5,1(7)
+ 29:    OUT  2,0,0
+ 30:    JNE  0,1(7)
+ 31:    SUB  5,1,2
+ 32:    JGT  5,1(7)
+ 33:    OUT  1,0,0
+ 34:    JNE  0,1(7)
+ 35:    SUB  5,1,2
+ 36:    JGE  5,1(7)
+ 37:    OUT  2,0,0
+ 38:    JNE  0,1(7)
+ 39:    SUB  5,1,2
+ 40:    JEQ  5,1(7)
+ 41:    OUT  1,0,0
+ 42:    JNE  0,1(7)
+ 43:    SUB  5,1,2
+ 44:    JNE  5,1(7)
+ 45:    OUT  2,0,0
+* compare: SUB; Jcc 2(7); LDC 0; LDA 7,1(7); LDC 1
+ 46:    JNE  0,1(7)	pass 2: into the Jcc
+ 47:    SUB  3,1,2
+ 48:    JLT  3,2(7)
+ 49:    LDC  3,0(0)
+ 50:    LDA  7,1(7)
+ 51:    LDC  3,1(0)
+ 52:    OUT  3,0,0
+ 53:    JNE  0,3(7)	pass 2: into the LDA
+ 54:    SUB  3,2,1
+ 55:    JGE  3,2(7)
+ 56:    LDC  3,0(0)
+ 57:    LDA  7,1(7)
+ 58:    LDC  3,1(0)
+ 59:    OUT  3,0,0
+ 60:    JNE  0,4(7)	pass 2: into the last LDC
+ 61:    SUB  4,1,1
+ 62:    JNE  4,2(7)
+ 63:    LDC  4,0(0)
+ 64:    LDA  7,1(7)
+ 65:    LDC  4,1(0)
+ 66:    OUT  4,0,0
+* second pass, then stop
+ 67:    JNE  0,2(7)
+ 68:    LDC  0,1(0)
+ 69:    LDA  7,-65(7)
+ 70:   HALT  0,0,0
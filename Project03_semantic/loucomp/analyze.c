@@ -6,16 +6,118 @@
 /* Kenneth C. Louden                                */
 /****************************************************/
 
+#include <pthread.h>
 #include "globals.h"
 #include "symtab.h"
 #include "analyze.h"
 #include "util.h"
+#include "diag.h"
 
 /* counter for variable memory locations */
 static int location = 0;
 
 //for catch function compound
-static int enterFunc = 0; // 0: flase, 1: true
+static _Thread_local int enterFunc = 0; // 0: flase, 1: true
+
+void addBuiltinFunc(Scope globalScope);
+static void reportRedefined(BucketList symbol, int lineno);
+
+/* Parallel analysis (AnalyzeThreads > 1) splits the
+ * program into one job per top-level declaration.
+ * Global declarations and function headers are
+ * entered on the main thread in source order, then
+ * the function bodies are analysed by worker threads.
+ * Everything a job would write to shared state (the
+ * diagnostics, the closed scopes and the line numbers
+ * of global symbols) is kept in the job and merged
+ * back in source order, so the listing is the same
+ * for any number of threads
+ */
+typedef struct
+   { BucketList symbol;
+     int lineno;
+   } GlobalRef;
+
+/* the line numbers printed with the redefinition of a
+ * global symbol are counted at the merge, when the
+ * line list of the symbol is complete
+ */
+typedef struct
+   { int diag; /* index of the error in the job's list */
+     int refCount; /* global references made before it */
+   } Redefinition;
+
+typedef struct
+   { TreeNode * decl; /* top-level declaration */
+     int visible; /* global symbols visible to the body */
+     int parallel; /* TRUE if the body is left to a worker */
+     DiagList diags; /* recorded errors */
+     Scope * scopes; /* scopes closed while analysing */
+     int scopeCount;
+     GlobalRef * refs; /* uses of global symbols */
+     int refCount;
+     int refSize;
+     Redefinition * redefs;
+     int redefCount;
+     char ** missing; /* names not found in any scope */
+     int missingCount;
+     struct FuncRecordRec * record; /* reused analysis, if any */
+     unsigned hash; /* hash of the function definition */
+   } AnalyzeJob;
+
+/* Incremental re-analysis (reanalyze) keeps a record of
+ * every analysed function definition. A definition is
+ * not analysed again if its text is unchanged (same
+ * hash, with line numbers counted from its first line)
+ * and every global symbol it used was declared again
+ * with the same declaration, before it, while none of
+ * the names it could not resolve has become visible.
+ * The scopes, diagnostics and global references of such
+ * a function are taken from its record and its analysed
+ * subtree is moved to the new syntax tree; if it has
+ * moved in the source their line numbers are shifted
+ */
+typedef struct FuncRecordRec
+   { char * name;
+     unsigned hash;
+     TreeNode * decl; /* analysed definition */
+     Scope * scopes;
+     int scopeCount;
+     GlobalRef * refs;
+     int refCount;
+     char ** missing;
+     int missingCount;
+     DiagList buildDiags; /* buildSymtab errors */
+     DiagList checkDiags; /* typeCheck errors */
+     int round; /* last round that used the record */
+     struct FuncRecordRec * next;
+   } * FuncRecord;
+
+/* size of the hash table of function records */
+#define RECORD_SIZE 4093
+
+static FuncRecord records[RECORD_SIZE];
+
+/* current analysis round, incremented by reanalyze */
+static int round = 0;
+
+/* global symbols of the previous round while the
+ * global scope is entered again (open addressing,
+ * poolSize is a power of two), NULL otherwise
+ */
+static BucketList * reusePool = NULL;
+static unsigned poolSize = 0;
+
+static Scope globalScope = NULL;
+
+static AnalyzeJob * jobs = NULL;
+static int jobCount = 0;
+static int nextJob = 0;
+static void (* jobProc) (AnalyzeJob *);
+static pthread_mutex_t jobLock = PTHREAD_MUTEX_INITIALIZER;
+
+/* job analysed by the current thread, NULL if none */
+static _Thread_local AnalyzeJob * curJob = NULL;
 
 
 // postProc : exit scope
@@ -39,7 +141,7 @@ static void exitScope(TreeNode *t){
 static void traverse( TreeNode * t,
                void (* preProc) (TreeNode *),
                void (* postProc) (TreeNode *) )
-{ if (t != NULL)
+{ if (t != NULL && !diagFull())
   { preProc(t);
     { int i;
       for (i=0; i < MAXCHILDREN; i++)
@@ -50,6 +152,19 @@ static void traverse( TreeNode * t,
   }
 }
 
+/* Procedure traverseNode is traverse for a single
+ * node: the siblings of t are not visited
+ */
+static void traverseNode( TreeNode * t,
+               void (* preProc) (TreeNode *),
+               void (* postProc) (TreeNode *) )
+{ int i;
+  preProc(t);
+  for (i=0; i < MAXCHILDREN; i++)
+    traverse(t->child[i],preProc,postProc);
+  postProc(t);
+}
+
 /* nullProc is a do-nothing procedure to 
  * generate preorder-only or postorder-only
  * traversals from traverse
@@ -59,6 +174,168 @@ static void nullProc(TreeNode * t)
   else return;
 }
 
+/* Procedure useSymbol records a reference to symbol
+ * at lineno. References to global symbols made while
+ * analysing a job are kept in the job until the merge
+ */
+static void useSymbol(BucketList symbol, int lineno)
+{ AnalyzeJob * job = curJob;
+  if (job != NULL && symbol->nestedLevel == 0)
+  { if (job->refCount == job->refSize)
+    { job->refSize = job->refSize ? job->refSize * 2 : 16;
+      job->refs = (GlobalRef *) realloc(job->refs, job->refSize * sizeof(GlobalRef));
+    }
+    job->refs[job->refCount].symbol = symbol;
+    job->refs[job->refCount].lineno = lineno;
+    job->refCount++;
+  }
+  else insertLineno(symbol, lineno);
+}
+
+/* Procedure noteMissing records that name could not
+ * be resolved while analysing the current job
+ */
+static void noteMissing(char * name)
+{ AnalyzeJob * job = curJob;
+  if (job == NULL) return;
+  if ((job->missingCount & (job->missingCount - 1)) == 0)
+    job->missing = (char **) realloc(job->missing,
+                     (job->missingCount ? job->missingCount * 2 : 1) * sizeof(char *));
+  job->missing[job->missingCount++] = name;
+}
+
+/* Function hashTree computes an FNV-1a hash of the
+ * syntax tree t (siblings included when sib is TRUE).
+ * Line numbers are taken relative to line base, so a
+ * definition moved in the source keeps its hash
+ */
+static unsigned hashTree(TreeNode * t, int sib, int base, unsigned h)
+{ const unsigned char * p;
+  int i;
+  for (; t != NULL; t = sib ? t->sibling : NULL)
+  { int key[5];
+    key[0] = t->nodekind; key[1] = t->kind.exp;
+    key[2] = t->nodekind == DeclK ? (int) t->type : 0; // others are set by analysis
+    key[3] = t->lineno - base; key[4] = 0;
+    if (t->nodekind == ExpK && t->kind.exp == OpK) key[4] = t->attr.op;
+    else if (t->nodekind == ExpK && t->kind.exp == ConstK) key[4] = t->attr.val;
+    for (p = (const unsigned char *) key; p < (const unsigned char *) (key+5); p++)
+      h = (h ^ *p) * 16777619u;
+    if ((t->nodekind == DeclK || (t->nodekind == ExpK &&
+         (t->kind.exp == IdK || t->kind.exp == CallK))) && t->attr.name != NULL)
+      for (p = (const unsigned char *) t->attr.name; *p; p++)
+        h = (h ^ *p) * 16777619u;
+    for (i = 0; i < MAXCHILDREN; i++)
+      h = hashTree(t->child[i], TRUE, base, h * 16777619u);
+  }
+  return h;
+}
+
+/* Function declHash hashes what other declarations may
+ * depend on: the return type and parameters of a
+ * function, nothing for a variable
+ */
+static unsigned declHash(TreeNode * t)
+{ if (t->nodekind == DeclK && t->kind.decl == FunK)
+    return hashTree(t->child[0], TRUE, t->lineno, 2166136261u ^ t->type);
+  return 0;
+}
+
+static unsigned poolHash(char * name)
+{ unsigned h = 2166136261u;
+  for (; *name; name++) h = (h ^ (unsigned char) *name) * 16777619u;
+  return h;
+}
+
+/* Procedure fillPool moves the symbols of scope to the
+ * reuse pool and empties scope
+ */
+static void fillPool(Scope scope)
+{ unsigned i, h;
+  BucketList l;
+  poolSize = 16;
+  while (poolSize < 2u * (unsigned) scope->symbolCount) poolSize *= 2;
+  reusePool = (BucketList *) calloc(poolSize, sizeof(BucketList));
+  for (i = 0; i < SIZE; i++)
+    for (l = scope->symbolTable[i]; l != NULL; l = l->next)
+    { h = poolHash(l->name);
+      while (reusePool[h & (poolSize-1)] != NULL) h++;
+      reusePool[h & (poolSize-1)] = l;
+    }
+  clearScope(scope);
+}
+
+static BucketList poolFind(char * name)
+{ unsigned h;
+  BucketList l;
+  if (reusePool == NULL) return NULL;
+  for (h = poolHash(name); (l = reusePool[h & (poolSize-1)]) != NULL; h++)
+    if (strcmp(l->name, name) == 0) return l;
+  return NULL;
+}
+
+/* Procedure setSignature stores the parameter count
+ * and types of the function symbol declared with the
+ * parameter list params, so that calls can be checked
+ * without visiting the declaration
+ */
+static void setSignature(BucketList symbol, TreeNode * params)
+{ TreeNode * p;
+  int n = 0;
+  for (p = params; p != NULL; p = p->sibling)
+    if (!(p->type == Void && p->attr.name == NULL)) n++; // (void)
+  symbol->paramCount = n;
+  symbol->paramTypes = (unsigned char *) malloc(n > 0 ? n : 1);
+  n = 0;
+  for (p = params; p != NULL; p = p->sibling)
+    if (!(p->type == Void && p->attr.name == NULL))
+      symbol->paramTypes[n++] = (unsigned char) p->type;
+}
+
+/* Procedure enterGlobal enters a global symbol. While
+ * the global scope is entered again the record of the
+ * previous round is kept if it has the same declaration
+ */
+static BucketList enterGlobal(SymbolKind kind, ExpType type, char * name,
+                              int lineno, int loc, unsigned hash)
+{ BucketList old = poolFind(name);
+  Scope scope = getCurScope();
+  if (old != NULL && old->stamp != round && old->kind == kind &&
+      old->type == type && old->declHash == hash)
+  { st_reinsert(scope, old, lineno, loc);
+    old->stamp = round;
+    return old;
+  }
+  old = st_insert(scope, kind, type, name, lineno, loc);
+  if (old != NULL)
+  { old->stamp = round;
+    old->declHash = hash;
+  }
+  return old;
+}
+
+/* Procedure declareSymbol enters the declaration t in
+ * the current scope, as addSymbol does. An array
+ * variable takes as many locations as it has elements
+ */
+static void declareSymbol(TreeNode * t, SymbolKind kind)
+{ Scope curScope = getCurScope();
+  BucketList symbol;
+  if (curScope->nestedLevel == 0)
+    symbol = enterGlobal(kind, t->type, t->attr.name, t->lineno, curScope->curloc++, declHash(t));
+  else symbol = addSymbol(t, kind);
+  if (t->kind.decl == VarK && t->child[0] != NULL)
+  { int n = t->child[0]->attr.val;
+    if (n > 1) curScope->curloc += n - 1;
+    if (symbol != NULL) symbol->size = n;
+  }
+  if (symbol == NULL) return;
+  t->symbol = symbol;
+  if (t->kind.decl == ParamK) symbol->isParam = TRUE;
+  if (kind == Function && symbol->paramCount < 0)
+    setSignature(symbol, t->child[0]);
+}
+
 /* Procedure insertNode inserts 
  * identifiers stored in t into 
  * the symbol table 
@@ -74,11 +351,11 @@ static void insertNode(TreeNode * t)
           symbol = checkScope(t->attr.name);
   
           if (symbol != NULL){ // already exist in current scope
-            printRedefinedError(symbol);
+            reportRedefined(symbol, t->lineno);
             break; // 
           } else{
 
-            addSymbol(t, Function); //add function symbol in current scope
+            declareSymbol(t, Function); //add function symbol in current scope
             insertScope(t->attr.name); // make new scope for function
             enterFunc = 1;
           }
@@ -88,15 +365,15 @@ static void insertNode(TreeNode * t)
           BucketList symbol = checkScope(t->attr.name);
          
           if (symbol != NULL){ // already exist in current scope
-            printRedefinedError(symbol);
-            insertLineno(symbol, t->lineno);
+            reportRedefined(symbol, t->lineno);
+            useSymbol(symbol, t->lineno);
           } 
 
           if(t->type == Void || t->type == VoidArray) { //void & voidarray type can not be declared
-            fprintf(listing, "Error: The void-type variable is declared at line %d (name : \"%s\")\n", t->lineno, t->attr.name);
+            diagReport(VoidVariable, t->lineno, t->attr.name);
           }
 
-          addSymbol(t, Variable);
+          declareSymbol(t, Variable);
           break;
         }
 
@@ -107,9 +384,9 @@ static void insertNode(TreeNode * t)
           
           BucketList symbol = checkScope(t->attr.name);
           if (symbol != NULL){ // already exist in current scope
-            printRedefinedError(symbol);
+            reportRedefined(symbol, t->lineno);
           }
-          addSymbol(t, Variable);
+          declareSymbol(t, Variable);
 
           break;
         }
@@ -142,22 +419,26 @@ static void insertNode(TreeNode * t)
           //undeclared check
           symbol = findSymbol(t->attr.name);
           if(symbol==NULL){
-            fprintf(listing, "Error: undeclared variable \"%s\" is used at line %d\n", t->attr.name, t->lineno);
-            addSymbolImplict(t,Variable);
+            diagReport(UndeclaredVariable, t->lineno, t->attr.name);
+            noteMissing(t->attr.name);
+            t->symbol = addSymbolImplict(t,Variable);
           } else{
             t->type = symbol->type;
-            insertLineno(symbol, t->lineno);
+            t->symbol = symbol;
+            useSymbol(symbol, t->lineno);
           }
           break;
         case CallK:
           //undeclared check
           symbol = findSymbol(t->attr.name);
           if(symbol==NULL){
-            fprintf(listing, "Error: undeclared function \"%s\" is called at line %d\n", t->attr.name, t->lineno);
-            addSymbolImplict(t,Function);
+            diagReport(UndeclaredFunction, t->lineno, t->attr.name);
+            noteMissing(t->attr.name);
+            t->symbol = addSymbolImplict(t,Function);
           } else{
             t->type = symbol->type;
-            insertLineno(symbol, t->lineno);
+            t->symbol = symbol;
+            useSymbol(symbol, t->lineno);
           }
           break;
         case AssignK:
@@ -173,17 +454,165 @@ static void insertNode(TreeNode * t)
   }
 }
 
+/* Procedure beginJob directs the diagnostics and the
+ * global references of the current thread to job
+ */
+static void beginJob(AnalyzeJob * job)
+{ curJob = job;
+  diagUseList(&job->diags);
+  collectScopes(TRUE);
+}
+
+static void endJob(AnalyzeJob * job)
+{ diagUseList(NULL);
+  curJob = NULL;
+  collectScopes(FALSE);
+  job->scopeCount = takeScopeList(&job->scopes);
+}
+
+/* Procedure emitJob merges job into the shared state:
+ * the global references are entered and the recorded
+ * errors are appended to the shared list
+ */
+static void emitJob(AnalyzeJob * job)
+{ int i, r = 0;
+  for (i = 0; i <= job->redefCount; i++)
+  { int refs = i < job->redefCount ? job->redefs[i].refCount : job->refCount;
+    for (; r < refs; r++)
+      insertLineno(job->refs[r].symbol, job->refs[r].lineno);
+    if (i < job->redefCount)
+    { DiagRec * rec = &job->diags.recs[job->redefs[i].diag];
+      LineList line;
+      rec->extra = 0;
+      for (line = rec->symbol->lines; line != NULL; line = line->next) rec->extra++;
+    }
+  }
+  diagAppend(&job->diags);
+}
+
+static void * jobWorker(void * arg)
+{ int i;
+  for (;;)
+  { pthread_mutex_lock(&jobLock);
+    i = nextJob++;
+    pthread_mutex_unlock(&jobLock);
+    if (i >= jobCount) break;
+    if (jobs[i].parallel) jobProc(&jobs[i]);
+  }
+  return arg;
+}
+
+/* Procedure runJobs applies proc to every parallel
+ * job on min(AnalyzeThreads, jobCount) threads
+ */
+static void runJobs(void (* proc) (AnalyzeJob *))
+{ int n = AnalyzeThreads < jobCount ? AnalyzeThreads : jobCount;
+  pthread_t * threads;
+  int i;
+  jobProc = proc;
+  nextJob = 0;
+  if (n <= 1)
+  { jobWorker(NULL);
+    return;
+  }
+  threads = (pthread_t *) malloc(n * sizeof(pthread_t));
+  for (i = 0; i < n; i++)
+    pthread_create(&threads[i], NULL, jobWorker, NULL);
+  for (i = 0; i < n; i++)
+    pthread_join(threads[i], NULL);
+  free(threads);
+}
+
+/* Function makeJobs creates one job for each
+ * top-level declaration of syntaxTree
+ */
+static void makeJobs(TreeNode * syntaxTree)
+{ TreeNode * t;
+  jobCount = 0;
+  for (t = syntaxTree; t != NULL; t = t->sibling) jobCount++;
+  jobs = (AnalyzeJob *) calloc(jobCount > 0 ? jobCount : 1, sizeof(AnalyzeJob));
+  jobCount = 0;
+  for (t = syntaxTree; t != NULL; t = t->sibling)
+    jobs[jobCount++].decl = t;
+}
+
+static void freeJobs(void)
+{ int i;
+  for (i = 0; i < jobCount; i++)
+  { diagFree(&jobs[i].diags);
+    free(jobs[i].scopes);
+    free(jobs[i].refs);
+    free(jobs[i].redefs);
+    free(jobs[i].missing);
+  }
+  free(jobs);
+  jobs = NULL;
+  jobCount = 0;
+}
+
+/* Procedure analyzeBody builds the scopes of the
+ * function body of job on a worker thread. The
+ * function symbol has already been entered
+ */
+static void analyzeBody(AnalyzeJob * job)
+{ TreeNode * t = job->decl;
+  Scope funcScope;
+  int i;
+  beginJob(job);
+  setVisibleGlobals(job->visible);
+  funcScope = createScope(t->attr.name); // same as insertScope below global
+  funcScope->parent = globalScope;
+  funcScope->nestedLevel = 1;
+  pushScopeToStack(funcScope);
+  enterFunc = 1;
+  for (i=0; i < MAXCHILDREN; i++)
+    traverse(t->child[i],insertNode,exitScope);
+  setVisibleGlobals(-1);
+  endJob(job);
+}
+
+/* Procedure buildSymtabParallel enters the global
+ * declarations in source order, analyses the function
+ * bodies in parallel and merges the results
+ */
+static void buildSymtabParallel(TreeNode * syntaxTree)
+{ int i;
+  makeJobs(syntaxTree);
+  for (i = 0; i < jobCount; i++)
+  { TreeNode * t = jobs[i].decl;
+    beginJob(&jobs[i]);
+    if (t->nodekind == DeclK && t->kind.decl == FunK &&
+        checkScope(t->attr.name) == NULL)
+    { declareSymbol(t, Function);
+      jobs[i].visible = globalScope->symbolCount;
+      jobs[i].parallel = TRUE;
+    }
+    else traverseNode(t,insertNode,exitScope);
+    endJob(&jobs[i]);
+  }
+  runJobs(analyzeBody);
+  for (i = 0; i < jobCount; i++)
+  { appendScopeList(jobs[i].scopes, jobs[i].scopeCount);
+    emitJob(&jobs[i]);
+  }
+  freeJobs();
+}
+
 /* Function buildSymtab constructs the symbol 
  * table by preorder traversal of the syntax tree
  */
 void buildSymtab(TreeNode * syntaxTree)
 { 
   
-  Scope globalScope = createScope("Global"); // have to make global scope first
+  globalScope = createScope("Global"); // have to make global scope first
   pushScopeToStack(globalScope); // push global scope to top of stack
   addBuiltinFunc(globalScope); // add built in function in lobal scope
-  traverse(syntaxTree,insertNode,exitScope);
+  if (AnalyzeThreads > 1)
+    buildSymtabParallel(syntaxTree);
+  else
+    traverse(syntaxTree,insertNode,exitScope);
   popScopeInStack();
+  diagFlush(listing);
 
   if (TraceAnalyze)
   { fprintf(listing,"\nSymbol table:\n\n");
@@ -212,10 +641,8 @@ static void checkNode(TreeNode * t)
         }
 
         // If parameter has void type but has a name, it's an error
-        if (t->type == Void) {
-            fprintf(listing, 
-                    "Error: The void-type variable is declared at line %d (name : \"%s\")\n",
-                    t->lineno, t->attr.name);
+        if (t->type == Void || t->type == VoidArray) {
+            diagReport(VoidVariable, t->lineno, t->attr.name);
         }
         break;
 
@@ -232,22 +659,20 @@ static void checkNode(TreeNode * t)
         case AssignK:
           if(t->child[0]->type == Integer){
             if (t->child[1]->type!=Integer)
-              fprintf(listing, "Error: invalid assignment at line %d\n", t->child[1]->lineno);
+              diagReport(InvalidAssignment, t->child[1]->lineno, NULL);
+            t->type = Integer; // value of the assignment
             break;
           }
-          else if(t->child[0]->type == IntegerArray){
-            
-            if(t->child[1]->type!=Integer)
-            fprintf(listing, "Error: invalid assignment at line %d\n", t->child[1]->lineno);
+          else if(t->child[0]->type == IntegerArray){ // whole array
+            diagReport(InvalidAssignment, t->child[1]->lineno, NULL);
           break;
           }
            t->type = t->child[0]->type;
           break;
         case OpK:
 
-          if (!((t->child[0]->type == Integer || t->child[0]->type == IntegerArray) &&
-                  (t->child[1]->type == Integer || t->child[1]->type == IntegerArray))){
-            fprintf(listing, "Error: invalid operation at line %d\n", t->child[0]->lineno);
+          if (t->child[0]->type != Integer || t->child[1]->type != Integer){
+            diagReport(InvalidOperation, t->child[0]->lineno, NULL);
           }
           t->type = Integer;
           break;
@@ -258,20 +683,30 @@ static void checkNode(TreeNode * t)
         case IdK:
           if (t->child[0] != NULL) { 
             if (t->type != IntegerArray) {
-              fprintf(listing, "Error: Invalid array indexing at line %d (name : \"%s\"). indexing can only allowed for int[] variables\n", t->lineno, t->attr.name);
+              diagReport(IndexNotArray, t->lineno, t->attr.name);
             } else if (t->child[0]->type != Integer) {
-              fprintf(listing, "Error: Invalid array indexing at line %d (name : \"%s\"). indicies should be integer\n", t->child[0]->lineno, t->attr.name);
+              diagReport(IndexNotInteger, t->child[0]->lineno, t->attr.name);
             }
+            t->type = Integer; // an element of the array
           }
           break;
         case CallK: {
-          Scope curScope = findScope(t->attr.name);
-          BucketList symbol = findSymbolinCheck(curScope, t->attr.name);
+          BucketList symbol = t->symbol; // resolved by buildSymtab
           if (symbol == NULL) {
-            fprintf(listing, "Error: Function \"%s\" is not defined at line %d\n", t->attr.name, t->lineno);
+            diagReport(FunctionNotDefined, t->lineno, t->attr.name);
           } else {
             if (symbol->kind != Function) {
-              fprintf(listing, "Error: \"%s\" is not a function, but called as one at line %d\n", t->attr.name, t->lineno);
+              diagReport(NotFunction, t->lineno, t->attr.name);
+            } else if (symbol->paramCount >= 0) { // match the signature
+              TreeNode * arg = t->child[0];
+              int n = 0;
+              while (arg != NULL && n < symbol->paramCount &&
+                     arg->type == (ExpType) symbol->paramTypes[n]) {
+                arg = arg->sibling;
+                n++;
+              }
+              if (arg != NULL || n != symbol->paramCount)
+                diagReport(InvalidCall, t->lineno, t->attr.name);
             }
           }
           break;
@@ -286,13 +721,13 @@ static void checkNode(TreeNode * t)
         case IfK:
         case WhileK:
           if (t->child[0]->type != Integer) { 
-            fprintf(listing, "Error: invalid condition at line %d\n", t->child[0]->lineno);
+            diagReport(InvalidCondition, t->child[0]->lineno, NULL);
           }
           break;
         
         case ReturnK:
           if (t->child[0] != NULL && t->child[0]->type != Integer) {
-            fprintf(listing, "Error: Invalid return at line %d\n", t->lineno);
+            diagReport(InvalidReturn, t->lineno, NULL);
           }
           break;
         case CompK:
@@ -306,30 +741,266 @@ static void checkNode(TreeNode * t)
   }
 }
 
+static void checkBody(AnalyzeJob * job)
+{ beginJob(job);
+  traverseNode(job->decl,nullProc,checkNode);
+  endJob(job);
+}
+
 /* Procedure typeCheck performs type checking 
  * by a postorder syntax tree traversal
  */
 void typeCheck(TreeNode * syntaxTree)
-{ traverse(syntaxTree,nullProc,checkNode);
+{ int i;
+  if (AnalyzeThreads <= 1)
+    traverse(syntaxTree,nullProc,checkNode);
+  else
+  { makeJobs(syntaxTree);
+    for (i = 0; i < jobCount; i++) jobs[i].parallel = TRUE;
+    runJobs(checkBody);
+    for (i = 0; i < jobCount; i++) emitJob(&jobs[i]);
+    freeJobs();
+  }
+  diagFlush(listing);
 }
 
+static FuncRecord * recordSlot(char * name)
+{ unsigned h = 0;
+  FuncRecord * slot;
+  char * p;
+  for (p = name; *p; p++) h = (h << 4) + (unsigned char) *p;
+  slot = &records[h % RECORD_SIZE];
+  while (*slot != NULL && strcmp((*slot)->name, name) != 0)
+    slot = &(*slot)->next;
+  return slot;
+}
 
-void addBuiltinFunc(Scope globalScope){
-  BucketList input = st_insert(globalScope, Function, Integer, "input", 0, globalScope->curloc++);
-  BucketList output = st_insert(globalScope, Function, Void, "output", 0, globalScope->curloc++);
-  st_insert(globalScope, Variable, Integer, "value", 0,0);
-}
-
-void printRedefinedError(BucketList symbol){
-  fprintf(listing, "Error: Symbol \"%s\" is redefined at line (already defined at line ", symbol->name);
-  // Program to sequentially print all the line numbers
-  LineList line = symbol->lines; 
-  while (line != NULL) {
-      fprintf(listing, "%d", line->lineno);
-      if (line->next != NULL) {
-          fprintf(listing, ", "); 
+/* Function recordValid tells whether the analysis kept
+ * in rec still holds for the definition of job
+ */
+static int recordValid(FuncRecord rec, AnalyzeJob * job)
+{ int i;
+  if (rec->hash != job->hash) return FALSE;
+  for (i = 0; i < rec->refCount; i++)
+  { BucketList symbol = rec->refs[i].symbol;
+    if (symbol->stamp != round || symbol->declOrder >= job->visible)
+      return FALSE; // declaration changed, removed or moved
+  }
+  for (i = 0; i < rec->missingCount; i++)
+  { BucketList symbol = findSymbolinCheck(globalScope, rec->missing[i]);
+    if (symbol != NULL && symbol->declOrder < job->visible)
+      return FALSE; // a missing name is now declared
+  }
+  return TRUE;
+}
+
+/* Procedure shiftTree adds delta to the line numbers
+ * of the syntax tree t, siblings included
+ */
+static void shiftTree(TreeNode * t, int delta)
+{ int i;
+  for (; t != NULL; t = t->sibling)
+  { t->lineno += delta;
+    for (i = 0; i < MAXCHILDREN; i++) shiftTree(t->child[i], delta);
+  }
+}
+
+static void shiftDiags(DiagList * list, int delta)
+{ int i;
+  for (i = 0; i < list->count; i++) list->recs[i].lineno += delta;
+}
+
+/* Procedure shiftRecord moves the line numbers kept in
+ * rec by delta lines, for a definition that moved in
+ * the source without changing. It only renumbers: the
+ * cost is that of reading the results, not of making
+ * them again
+ */
+static void shiftRecord(FuncRecord rec, int delta)
+{ BucketList l;
+  LineList line;
+  int i, j;
+  for (i = 0; i < rec->scopeCount; i++)
+    for (j = 0; j < SIZE; j++)
+      for (l = rec->scopes[i]->symbolTable[j]; l != NULL; l = l->next)
+        for (line = l->lines; line != NULL; line = line->next)
+          line->lineno += delta;
+  for (i = 0; i < rec->refCount; i++) rec->refs[i].lineno += delta;
+  shiftDiags(&rec->buildDiags, delta);
+  shiftDiags(&rec->checkDiags, delta);
+  for (i = 0; i < MAXCHILDREN; i++) shiftTree(rec->decl->child[i], delta);
+}
+
+/* Procedure saveRecord moves the results of the function
+ * analysed by job (and check, its type checking) into
+ * the record of the function
+ */
+static void saveRecord(AnalyzeJob * job, AnalyzeJob * check)
+{ FuncRecord * slot = recordSlot(job->decl->attr.name);
+  FuncRecord rec = *slot;
+  if (rec == NULL)
+  { rec = (FuncRecord) calloc(1, sizeof(struct FuncRecordRec));
+    rec->name = job->decl->attr.name;
+    *slot = rec;
+  }
+  else
+  { free(rec->scopes); free(rec->refs); free(rec->missing);
+    diagFree(&rec->buildDiags); diagFree(&rec->checkDiags);
+  }
+  rec->name = job->decl->attr.name;
+  rec->hash = job->hash;
+  rec->decl = job->decl;
+  rec->scopes = job->scopes; rec->scopeCount = job->scopeCount;
+  rec->refs = job->refs; rec->refCount = job->refCount;
+  rec->missing = job->missing; rec->missingCount = job->missingCount;
+  rec->buildDiags = job->diags;
+  rec->checkDiags = check->diags;
+  rec->round = round;
+  job->scopes = NULL; job->refs = NULL; job->missing = NULL;
+  memset(&job->diags, 0, sizeof(DiagList));
+  memset(&check->diags, 0, sizeof(DiagList));
+}
+
+/* Procedure dropStaleRecords forgets the functions that
+ * were not part of the latest round
+ */
+static void dropStaleRecords(void)
+{ int i;
+  for (i = 0; i < RECORD_SIZE; i++)
+  { FuncRecord * slot = &records[i];
+    while (*slot != NULL)
+    { FuncRecord rec = *slot;
+      if (rec->round == round) { slot = &rec->next; continue; }
+      *slot = rec->next;
+      free(rec->scopes); free(rec->refs); free(rec->missing);
+      diagFree(&rec->buildDiags); diagFree(&rec->checkDiags);
+      free(rec);
+    }
+  }
+}
+
+/* Procedure reanalyze performs buildSymtab and typeCheck
+ * on a new version of the program, analysing again
+ * only the function definitions that changed or that
+ * depend on changed global declarations
+ */
+void reanalyze(TreeNode * syntaxTree)
+{ AnalyzeJob * built, * checks;
+  int i, c;
+  round++;
+  if (globalScope == NULL) globalScope = createScope("Global");
+  fillPool(globalScope);
+  resetScopeList();
+  pushScopeToStack(globalScope);
+  addBuiltinFunc(globalScope);
+  makeJobs(syntaxTree);
+  for (i = 0; i < jobCount; i++)
+  { TreeNode * t = jobs[i].decl;
+    beginJob(&jobs[i]);
+    if (t->nodekind == DeclK && t->kind.decl == FunK &&
+        checkScope(t->attr.name) == NULL)
+    { FuncRecord rec = *recordSlot(t->attr.name);
+      declareSymbol(t, Function);
+      jobs[i].visible = globalScope->symbolCount;
+      jobs[i].hash = hashTree(t, FALSE, t->lineno, 2166136261u);
+      jobs[i].parallel = TRUE;
+      if (rec != NULL && rec->round != round && recordValid(rec, &jobs[i]))
+      { jobs[i].record = rec;
+        jobs[i].parallel = FALSE;
+        rec->round = round;
+        if (t->lineno != rec->decl->lineno)
+          shiftRecord(rec, t->lineno - rec->decl->lineno);
       }
-      line = line->next; 
+    }
+    else traverseNode(t,insertNode,exitScope);
+    endJob(&jobs[i]);
+  }
+  runJobs(analyzeBody);
+  for (i = 0; i < jobCount; i++)
+  { FuncRecord rec = jobs[i].record;
+    if (rec != NULL)
+    { appendScopeList(rec->scopes, rec->scopeCount);
+      for (c = 0; c < rec->refCount; c++)
+        insertLineno(rec->refs[c].symbol, rec->refs[c].lineno);
+      diagAppend(&rec->buildDiags);
+    }
+    else
+    { appendScopeList(jobs[i].scopes, jobs[i].scopeCount);
+      emitJob(&jobs[i]);
+    }
+  }
+  popScopeInStack();
+  free(reusePool);
+  reusePool = NULL;
+  diagFlush(listing);
+  if (TraceAnalyze && round > 1)
+  { fprintf(listing,"\nFunctions analysed again:");
+    for (i = 0; i < jobCount; i++)
+      if (jobs[i].parallel) fprintf(listing," %s",jobs[i].decl->attr.name);
+    fprintf(listing,"\n");
+  }
+  if (TraceAnalyze)
+  { fprintf(listing,"\nSymbol table:\n\n");
+    printSymTab(listing);
+  }
+
+  built = jobs;
+  checks = (AnalyzeJob *) calloc(jobCount > 0 ? jobCount : 1, sizeof(AnalyzeJob));
+  for (i = 0; i < jobCount; i++)
+  { checks[i].decl = built[i].decl;
+    checks[i].parallel = (built[i].record == NULL);
+  }
+  jobs = checks;
+  runJobs(checkBody);
+  jobs = built;
+  for (i = 0; i < jobCount; i++)
+  { FuncRecord rec = built[i].record;
+    if (rec != NULL)
+    { TreeNode * t = built[i].decl;
+      diagAppend(&rec->checkDiags);
+      for (c = 0; c < MAXCHILDREN; c++)
+        t->child[c] = rec->decl->child[c]; // keep the analysed subtree
+      rec->decl = t;
+    }
+    else
+    { emitJob(&checks[i]);
+      if (built[i].parallel) saveRecord(&built[i], &checks[i]);
+    }
+    diagFree(&checks[i].diags);
+    free(checks[i].scopes);
+  }
+  diagFlush(listing);
+  free(checks);
+  freeJobs();
+  dropStaleRecords();
+}
+
+
+void addBuiltinFunc(Scope globalScope){
+  BucketList input = enterGlobal(Function, Integer, "input", 0, globalScope->curloc++, 0);
+  BucketList output = enterGlobal(Function, Void, "output", 0, globalScope->curloc++, 0);
+  enterGlobal(Variable, Integer, "value", 0, 0, 0);
+  if (input->paramCount < 0) {
+    input->paramCount = 0;
+    input->paramTypes = NULL;
   }
-  fprintf(listing, ")\n");
-}
\ No newline at end of file
+  if (output->paramCount < 0) {
+    output->paramCount = 1;
+    output->paramTypes = (unsigned char *) malloc(1);
+    output->paramTypes[0] = Integer;
+  }
+}
+
+/* Procedure reportRedefined records the redefinition
+ * of symbol at lineno
+ */
+static void reportRedefined(BucketList symbol, int lineno){
+  AnalyzeJob * job = curJob;
+  int i = diagRedefined(symbol, lineno);
+  if (i >= 0 && job != NULL && symbol->nestedLevel == 0) { // count lines at the merge
+    job->redefs = (Redefinition *) realloc(job->redefs, (job->redefCount+1) * sizeof(Redefinition));
+    job->redefs[job->redefCount].diag = i;
+    job->redefs[job->redefCount].refCount = job->refCount;
+    job->redefCount++;
+  }
+}
@@ -18,4 +18,15 @@ void buildSymtab(TreeNode *);
  */
 void typeCheck(TreeNode *);
 
+/* Procedure reanalyze performs buildSymtab and
+ * typeCheck on an edited version of the program last
+ * given to reanalyze. Function definitions are analysed
+ * again only if their text changed or a global symbol
+ * they depend on was declared differently; the others
+ * keep their scopes and diagnostics, and their analysed
+ * subtrees are moved into the new syntax tree (so the
+ * previous tree must not have been freed)
+ */
+void reanalyze(TreeNode *);
+
 #endif
@@ -0,0 +1,88 @@
+/****************************************************/
+/* File: bitset.c                                   */
+/* Dense bit sets for the dataflow analyses         */
+/* of the C-Minus compiler                          */
+/****************************************************/
+
+#include "globals.h"
+#include "bitset.h"
+
+#define WORD_BITS ((int) (8 * sizeof(unsigned long)))
+
+Bitset bsNew(int size)
+{ Bitset s = (Bitset) malloc(sizeof(*s));
+  s->size = size;
+  s->words = (size + WORD_BITS - 1) / WORD_BITS;
+  s->bits = (unsigned long *) calloc(s->words > 0 ? s->words : 1,
+                                     sizeof(unsigned long));
+  return s;
+}
+
+void bsFree(Bitset s)
+{ if (s == NULL) return;
+  free(s->bits);
+  free(s);
+}
+
+void bsAdd(Bitset s, int i)
+{ s->bits[i / WORD_BITS] |= 1UL << (i % WORD_BITS); }
+
+void bsRemove(Bitset s, int i)
+{ s->bits[i / WORD_BITS] &= ~(1UL << (i % WORD_BITS)); }
+
+int bsHas(Bitset s, int i)
+{ return (s->bits[i / WORD_BITS] >> (i % WORD_BITS)) & 1; }
+
+void bsCopy(Bitset d, Bitset s)
+{ memcpy(d->bits,s->bits,s->words * sizeof(unsigned long)); }
+
+int bsUnion(Bitset d, Bitset s)
+{ unsigned long changed = 0, w;
+  int i;
+  for (i = 0; i < d->words; i++)
+  { w = d->bits[i] | s->bits[i];
+    changed |= w ^ d->bits[i];
+    d->bits[i] = w;
+  }
+  return changed != 0;
+}
+
+int bsTransfer(Bitset d, Bitset use, Bitset s, Bitset kill)
+{ unsigned long changed = 0, w;
+  int i;
+  for (i = 0; i < d->words; i++)
+  { w = use->bits[i] | (s->bits[i] & ~kill->bits[i]);
+    changed |= w ^ d->bits[i];
+    d->bits[i] = w;
+  }
+  return changed != 0;
+}
+
+int bsNext(Bitset s, int i)
+{ int k;
+  unsigned long w;
+  if (i < 0) i = 0;
+  if (i >= s->size) return -1;
+  k = i / WORD_BITS;
+  w = s->bits[k] >> (i % WORD_BITS);
+  if (w == 0)
+  { k++;
+    while (k < s->words && s->bits[k] == 0) k++;
+    if (k == s->words) return -1;
+    i = k * WORD_BITS;
+    w = s->bits[k];
+  }
+  while ((w & 1) == 0)
+  { w >>= 1;
+    i++;
+  }
+  return i;
+}
+
+int bsCount(Bitset s)
+{ int i, n = 0;
+  unsigned long w;
+  for (i = 0; i < s->words; i++)
+    for (w = s->bits[i]; w != 0; w &= w - 1) n++;
+  return n;
+}
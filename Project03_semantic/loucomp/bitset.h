@@ -0,0 +1,51 @@
+/****************************************************/
+/* File: bitset.h                                   */
+/* Dense bit sets for the dataflow analyses         */
+/* of the C-Minus compiler                          */
+/****************************************************/
+
+#ifndef _BITSET_H_
+#define _BITSET_H_
+
+/* a set of the integers 0..size-1, stored as words
+ * of bits; the operations work a word at a time
+ */
+typedef struct
+   { int size;
+     int words;
+     unsigned long * bits;
+   } * Bitset;
+
+/* Function bsNew returns an empty set for 0..size-1 */
+Bitset bsNew(int size);
+
+/* Procedure bsFree releases set s */
+void bsFree(Bitset s);
+
+void bsAdd(Bitset s, int i);
+void bsRemove(Bitset s, int i);
+int bsHas(Bitset s, int i);
+
+/* Procedure bsCopy sets d to s (same size) */
+void bsCopy(Bitset d, Bitset s);
+
+/* Function bsUnion adds s to d and returns TRUE if
+ * d changed
+ */
+int bsUnion(Bitset d, Bitset s);
+
+/* Function bsTransfer sets d to use | (s & ~kill),
+ * the dataflow equation of a block, and returns TRUE
+ * if d changed
+ */
+int bsTransfer(Bitset d, Bitset use, Bitset s, Bitset kill);
+
+/* Function bsNext returns the smallest member of s
+ * that is >= i, or -1 if there is none
+ */
+int bsNext(Bitset s, int i);
+
+/* Function bsCount returns the number of members */
+int bsCount(Bitset s);
+
+#endif
@@ -0,0 +1,326 @@
+/****************************************************/
+/* File: cfg.c                                      */
+/* Control-flow graph, dominators and liveness      */
+/* for the IR of the C-Minus compiler               */
+/****************************************************/
+
+#include "globals.h"
+#include "symtab.h"
+#include "cfg.h"
+
+/* Function cfgBuild returns the graph of function f */
+Cfg * cfgBuild(IrFunction * f)
+{ Cfg * g = (Cfg *) calloc(1, sizeof(Cfg));
+  int b, i, s[2], ns, * fill;
+  g->fn = f;
+  g->n = f->blockCount;
+  g->succ = (int **) malloc((g->n + 1) * sizeof(int *));
+  g->succCount = (int *) calloc(g->n + 1, sizeof(int));
+  g->pred = (int **) malloc((g->n + 1) * sizeof(int *));
+  g->predCount = (int *) calloc(g->n + 1, sizeof(int));
+  fill = (int *) calloc(g->n + 1, sizeof(int));
+  for (b = 0; b < g->n; b++)
+  { ns = irSuccessors(&f->blocks[b],s);
+    g->succ[b] = (int *) malloc((ns > 0 ? ns : 1) * sizeof(int));
+    for (i = 0; i < ns; i++)
+    { /* both arms of a branch may go to the same block */
+      if (i > 0 && s[i] == s[0]) continue;
+      g->succ[b][g->succCount[b]++] = s[i];
+      g->predCount[s[i]]++;
+    }
+  }
+  for (b = 0; b < g->n; b++)
+    g->pred[b] = (int *) malloc((g->predCount[b] > 0 ? g->predCount[b] : 1)
+                                * sizeof(int));
+  for (b = 0; b < g->n; b++)
+    for (i = 0; i < g->succCount[b]; i++)
+    { ns = g->succ[b][i];
+      g->pred[ns][fill[ns]++] = b;
+    }
+  free(fill);
+  return g;
+}
+
+/* the state of the Lengauer-Tarjan algorithm; the
+ * arrays are indexed by block, semi[] holds the
+ * DFS number of the semidominator
+ */
+static int * semi, * vertex, * parent, * ancestor, * label;
+
+/* Procedure compress does the path compression of
+ * eval, without recursion: the path to the root of
+ * the forest is collected first
+ */
+static void compress(int v, int * path)
+{ int n = 0, x, a;
+  for (x = v; ancestor[ancestor[x]] >= 0; x = ancestor[x]) path[n++] = x;
+  while (n > 0)
+  { x = path[--n];
+    a = ancestor[x];
+    if (semi[label[a]] < semi[label[x]]) label[x] = label[a];
+    ancestor[x] = ancestor[a];
+  }
+}
+
+/* Function eval returns the vertex of least
+ * semidominator on the forest path to v
+ */
+static int eval(int v, int * path)
+{ if (ancestor[v] < 0) return v;
+  compress(v,path);
+  return label[v];
+}
+
+/* Procedure cfgDominators computes the dominator
+ * tree with the Lengauer-Tarjan algorithm
+ */
+void cfgDominators(Cfg * g)
+{ int n = g->n, count = 0, sp, b, i, w, v, u, p;
+  int * stack, * next, * bucket, * bucketNext, * path;
+  int * child, * sibling;
+  if (n == 0) return;
+  semi = (int *) malloc(n * sizeof(int));
+  vertex = (int *) malloc(n * sizeof(int));
+  parent = (int *) malloc(n * sizeof(int));
+  ancestor = (int *) malloc(n * sizeof(int));
+  label = (int *) malloc(n * sizeof(int));
+  stack = (int *) malloc(n * sizeof(int));
+  next = (int *) calloc(n, sizeof(int));
+  bucket = (int *) malloc(n * sizeof(int));
+  bucketNext = (int *) malloc(n * sizeof(int));
+  path = (int *) malloc(n * sizeof(int));
+  free(g->idom);
+  g->idom = (int *) malloc(n * sizeof(int));
+  for (b = 0; b < n; b++)
+  { semi[b] = -1;
+    parent[b] = ancestor[b] = bucket[b] = g->idom[b] = -1;
+    label[b] = b;
+  }
+  /* depth-first numbering from the entry */
+  sp = 0;
+  stack[sp++] = 0;
+  semi[0] = count;
+  vertex[count++] = 0;
+  while (sp > 0)
+  { b = stack[sp-1];
+    if (next[b] < g->succCount[b])
+    { w = g->succ[b][next[b]++];
+      if (semi[w] < 0)
+      { semi[w] = count;
+        vertex[count++] = w;
+        parent[w] = b;
+        stack[sp++] = w;
+      }
+    }
+    else sp--;
+  }
+  for (i = count - 1; i > 0; i--)
+  { w = vertex[i];
+    p = parent[w];
+    for (b = 0; b < g->predCount[w]; b++)
+    { v = g->pred[w][b];
+      if (semi[v] < 0) continue; /* unreachable */
+      u = eval(v,path);
+      if (semi[u] < semi[w]) semi[w] = semi[u];
+    }
+    bucketNext[w] = bucket[vertex[semi[w]]];
+    bucket[vertex[semi[w]]] = w;
+    ancestor[w] = p;
+    for (v = bucket[p]; v >= 0; v = bucketNext[v])
+    { u = eval(v,path);
+      g->idom[v] = semi[u] < semi[v] ? u : p;
+    }
+    bucket[p] = -1;
+  }
+  for (i = 1; i < count; i++)
+  { w = vertex[i];
+    if (g->idom[w] != vertex[semi[w]]) g->idom[w] = g->idom[g->idom[w]];
+  }
+  /* number the dominator tree for cfgDominates */
+  child = bucket;
+  sibling = bucketNext;
+  for (b = 0; b < n; b++) child[b] = -1;
+  for (i = count - 1; i > 0; i--)
+  { w = vertex[i];
+    sibling[w] = child[g->idom[w]];
+    child[g->idom[w]] = w;
+  }
+  free(g->pre);
+  free(g->post);
+  g->pre = (int *) malloc(n * sizeof(int));
+  g->post = (int *) malloc(n * sizeof(int));
+  for (b = 0; b < n; b++) g->pre[b] = g->post[b] = -1;
+  sp = 0;
+  count = 0;
+  stack[sp++] = 0;
+  g->pre[0] = count++;
+  next[0] = child[0];
+  while (sp > 0)
+  { b = stack[sp-1];
+    w = next[b];
+    if (w >= 0)
+    { next[b] = sibling[w];
+      g->pre[w] = count++;
+      next[w] = child[w];
+      stack[sp++] = w;
+    }
+    else
+    { g->post[b] = count++;
+      sp--;
+    }
+  }
+  free(semi); free(vertex); free(parent); free(ancestor); free(label);
+  free(stack); free(next); free(bucket); free(bucketNext); free(path);
+}
+
+/* Function cfgDominates returns TRUE if block a
+ * dominates block b
+ */
+int cfgDominates(Cfg * g, int a, int b)
+{ if (g->pre[a] < 0 || g->pre[b] < 0) return FALSE;
+  return g->pre[a] <= g->pre[b] && g->post[b] <= g->post[a];
+}
+
+/* Function tracked returns TRUE for the variables
+ * whose liveness is computed
+ */
+static int tracked(IrInstr * in)
+{ return (in->op == IrGetVar || in->op == IrSetVar) &&
+         in->sym->nestedLevel > 0;
+}
+
+static int comparePtr(const void * a, const void * b)
+{ BucketList x = *(BucketList *) a, y = *(BucketList *) b;
+  return x < y ? -1 : x > y;
+}
+
+/* Function cfgVarIndex returns the number of
+ * variable s in the liveness sets, -1 if s is not
+ * tracked
+ */
+int cfgVarIndex(Cfg * g, BucketList s)
+{ BucketList * p;
+  if (g->vars == 0) return -1;
+  p = (BucketList *) bsearch(&s,g->var,g->vars,sizeof(BucketList),comparePtr);
+  return p == NULL ? -1 : p - g->var;
+}
+
+/* Procedure cfgLiveness computes the variables live
+ * at the start and end of each block
+ */
+void cfgLiveness(Cfg * g)
+{ IrFunction * f = g->fn;
+  IrInstr * in;
+  int b, j, i, v, n = 0, sp = 0, * stack;
+  char * queued;
+  /* the variables, sorted without duplicates */
+  for (b = 0; b < g->n; b++)
+    for (j = 0; j < f->blocks[b].count; j++)
+      if (tracked(&f->blocks[b].code[j])) n++;
+  g->var = (BucketList *) malloc((n > 0 ? n : 1) * sizeof(BucketList));
+  n = 0;
+  for (b = 0; b < g->n; b++)
+    for (j = 0; j < f->blocks[b].count; j++)
+      if (tracked(&f->blocks[b].code[j])) g->var[n++] = f->blocks[b].code[j].sym;
+  qsort(g->var,n,sizeof(BucketList),comparePtr);
+  g->vars = 0;
+  for (i = 0; i < n; i++)
+    if (g->vars == 0 || g->var[g->vars-1] != g->var[i])
+      g->var[g->vars++] = g->var[i];
+  g->use = (Bitset *) malloc((g->n + 1) * sizeof(Bitset));
+  g->def = (Bitset *) malloc((g->n + 1) * sizeof(Bitset));
+  g->liveIn = (Bitset *) malloc((g->n + 1) * sizeof(Bitset));
+  g->liveOut = (Bitset *) malloc((g->n + 1) * sizeof(Bitset));
+  for (b = 0; b < g->n; b++)
+  { g->use[b] = bsNew(g->vars);
+    g->def[b] = bsNew(g->vars);
+    g->liveIn[b] = bsNew(g->vars);
+    g->liveOut[b] = bsNew(g->vars);
+    for (j = 0; j < f->blocks[b].count; j++)
+    { in = &f->blocks[b].code[j];
+      if (!tracked(in)) continue;
+      v = cfgVarIndex(g,in->sym);
+      if (in->op == IrGetVar)
+      { if (!bsHas(g->def[b],v)) bsAdd(g->use[b],v);
+      }
+      else bsAdd(g->def[b],v);
+    }
+  }
+  /* the blocks are in reverse postorder, so the last
+   * block is taken first from the stack of work
+   */
+  stack = (int *) malloc((g->n + 1) * sizeof(int));
+  queued = (char *) malloc(g->n + 1);
+  for (b = 0; b < g->n; b++)
+  { stack[sp++] = b;
+    queued[b] = TRUE;
+  }
+  while (sp > 0)
+  { b = stack[--sp];
+    queued[b] = FALSE;
+    for (i = 0; i < g->succCount[b]; i++)
+      bsUnion(g->liveOut[b],g->liveIn[g->succ[b][i]]);
+    if (bsTransfer(g->liveIn[b],g->use[b],g->liveOut[b],g->def[b]))
+      for (i = 0; i < g->predCount[b]; i++)
+      { v = g->pred[b][i];
+        if (!queued[v])
+        { queued[v] = TRUE;
+          stack[sp++] = v;
+        }
+      }
+  }
+  free(stack);
+  free(queued);
+}
+
+/* Procedure printSet prints the variables of set s */
+static void printSet(FILE * f, Cfg * g, Bitset s)
+{ int i, first = TRUE;
+  fprintf(f,"{");
+  for (i = bsNext(s,0); i >= 0; i = bsNext(s,i+1))
+  { fprintf(f,first ? "%s" : " %s",g->var[i]->name);
+    first = FALSE;
+  }
+  fprintf(f,"}");
+}
+
+/* Procedure cfgPrint prints the edges, dominators
+ * and liveness of each block to file f
+ */
+void cfgPrint(FILE * f, Cfg * g)
+{ int b, i;
+  fprintf(f,"\nflow graph of %s:\n",g->fn->sym->name);
+  for (b = 0; b < g->n; b++)
+  { fprintf(f,"B%d: succ",b);
+    for (i = 0; i < g->succCount[b]; i++) fprintf(f," B%d",g->succ[b][i]);
+    if (g->idom != NULL && g->idom[b] >= 0) fprintf(f,", idom B%d",g->idom[b]);
+    if (g->liveIn != NULL)
+    { fprintf(f,", live in ");
+      printSet(f,g,g->liveIn[b]);
+      fprintf(f,", out ");
+      printSet(f,g,g->liveOut[b]);
+    }
+    fprintf(f,"\n");
+  }
+}
+
+/* Procedure cfgFree releases graph g */
+void cfgFree(Cfg * g)
+{ int b;
+  for (b = 0; b < g->n; b++)
+  { free(g->succ[b]);
+    free(g->pred[b]);
+    if (g->liveIn != NULL)
+    { bsFree(g->use[b]);
+      bsFree(g->def[b]);
+      bsFree(g->liveIn[b]);
+      bsFree(g->liveOut[b]);
+    }
+  }
+  free(g->succ); free(g->succCount);
+  free(g->pred); free(g->predCount);
+  free(g->idom); free(g->pre); free(g->post);
+  free(g->var);
+  free(g->use); free(g->def); free(g->liveIn); free(g->liveOut);
+  free(g);
+}
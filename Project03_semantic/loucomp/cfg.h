@@ -0,0 +1,68 @@
+/****************************************************/
+/* File: cfg.h                                      */
+/* Control-flow graph, dominators and liveness      */
+/* for the IR of the C-Minus compiler               */
+/****************************************************/
+
+#ifndef _CFG_H_
+#define _CFG_H_
+
+#include "ir.h"
+#include "bitset.h"
+
+/* The control-flow graph of an IR function. The
+ * nodes are its blocks (a function body of if,
+ * while, return and compound statements becomes
+ * blocks ending in branches, jumps and returns), and
+ * block 0 is the entry
+ */
+typedef struct
+   { IrFunction * fn;
+     int n; /* number of blocks */
+     int ** succ, * succCount;
+     int ** pred, * predCount;
+     /* dominators (cfgDominators) */
+     int * idom; /* immediate dominator, -1: entry or unreachable */
+     int * pre, * post; /* dominator tree numbering */
+     /* liveness of the local scalar variables (cfgLiveness) */
+     int vars; /* number of variables tracked */
+     BucketList * var; /* the variables, sorted by address */
+     Bitset * use, * def; /* upward exposed uses and definitions */
+     Bitset * liveIn, * liveOut;
+   } Cfg;
+
+/* Function cfgBuild returns the graph of function f */
+Cfg * cfgBuild(IrFunction * f);
+
+/* Procedure cfgDominators computes the dominator
+ * tree with the Lengauer-Tarjan algorithm
+ */
+void cfgDominators(Cfg * g);
+
+/* Function cfgDominates returns TRUE if block a
+ * dominates block b (after cfgDominators)
+ */
+int cfgDominates(Cfg * g, int a, int b);
+
+/* Procedure cfgLiveness computes the variables live
+ * at the start and end of each block. The variables
+ * are the scalar parameters and locals, the ones
+ * accessed with GetVar and SetVar
+ */
+void cfgLiveness(Cfg * g);
+
+/* Function cfgVarIndex returns the number of
+ * variable s in the liveness sets, -1 if s is not
+ * tracked
+ */
+int cfgVarIndex(Cfg * g, BucketList s);
+
+/* Procedure cfgPrint prints the edges, dominators
+ * and liveness of each block to file f
+ */
+void cfgPrint(FILE * f, Cfg * g);
+
+/* Procedure cfgFree releases graph g */
+void cfgFree(Cfg * g);
+
+#endif
@@ -1,7 +1,7 @@
 /****************************************************/
 /* File: cgen.c                                     */
 /* The code generator implementation                */
-/* for the TINY compiler                            */
+/* for the C-MINUS compiler                         */
 /* (generates code for the TM machine)              */
 /* Compiler Construction: Principles and Practice   */
 /* Kenneth C. Louden                                */
@@ -11,147 +11,361 @@
 #include "symtab.h"
 #include "code.h"
 #include "cgen.h"
+#include "peephole.h"
 
-/* tmpOffset is the memory offset for temps
-   It is decremented each time a temp is
-   stored, and incremeted when loaded again
+/* The activation record of a function is addressed
+ * from fp and grows toward lower addresses:
+ *    0(fp)         control link (fp of the caller)
+ *   -1(fp)         return address
+ *   -2-s(fp)       location s of the function scopes
+ *                  (parameters first, then locals)
+ *   -2-F-t(fp)     temp t, where F = frameSize
+ * A call builds the record of the callee right below
+ * the temps in use, so only the control link has to
+ * be saved. Globals are addressed from gp (= 0)
+ */
+#define FRAME_HEADER 2
+
+/* frameSize is the number of locations used by the
+   scopes of the function being generated
+*/
+static int frameSize = 0;
+
+/* tmpOffset is the number of temps in use.
+   It is incremented each time a temp is
+   stored, and decremented when loaded again
 */
 static int tmpOffset = 0;
 
+/* Expressions are evaluated in the registers of
+   regs[] (mp is free, as temps are fp-relative).
+   Code for an expression evaluated into regs[i]
+   may use regs[i] and the registers after it;
+   temps are used only when a tree needs more
+   registers than are left, and to keep the
+   registers in use across a call
+*/
+#define NREGS 5
+static int regs[NREGS] = { ac, ac1, 2, 3, mp };
+#define REG(i) (regs[i])
+
 /* prototype for internal recursive code generator */
 static void cGen (TreeNode * tree);
+static void gen( TreeNode * tree, int i);
 
-/* Procedure genStmt generates code at a statement node */
-static void genStmt( TreeNode * tree)
-{ TreeNode * p1, * p2, * p3;
-  int savedLoc1,savedLoc2,currentLoc;
-  int loc;
-  switch (tree->kind.stmt) {
+/* Function tmpLoc returns the fp offset of temp t */
+static int tmpLoc( int t)
+{ return -(FRAME_HEADER + frameSize + t); }
 
-      case IfK :
-         if (TraceCode) emitComment("-> if") ;
-         p1 = tree->child[0] ;
-         p2 = tree->child[1] ;
-         p3 = tree->child[2] ;
-         /* generate code for test expression */
-         cGen(p1);
-         savedLoc1 = emitSkip(1) ;
-         emitComment("if: jump to else belongs here");
-         /* recurse on then part */
-         cGen(p2);
-         savedLoc2 = emitSkip(1) ;
-         emitComment("if: jump to end belongs here");
-         currentLoc = emitSkip(0) ;
-         emitBackup(savedLoc1) ;
-         emitRM_Abs("JEQ",ac,currentLoc,"if: jmp to else");
-         emitRestore() ;
-         /* recurse on else part */
-         cGen(p3);
-         currentLoc = emitSkip(0) ;
-         emitBackup(savedLoc2) ;
-         emitRM_Abs("LDA",pc,currentLoc,"jmp to end") ;
-         emitRestore() ;
-         if (TraceCode)  emitComment("<- if") ;
-         break; /* if_k */
+/* Procedure pushTemp stores register r in a new temp */
+static void pushTemp( int r, char * c)
+{ emitRM("ST",r,tmpLoc(tmpOffset++),fp,c);
+  emitInstruction(emitSize()-1)->temp = TRUE;
+}
 
-      case RepeatK:
-         if (TraceCode) emitComment("-> repeat") ;
-         p1 = tree->child[0] ;
-         p2 = tree->child[1] ;
-         savedLoc1 = emitSkip(0);
-         emitComment("repeat: jump after body comes back here");
-         /* generate code for body */
-         cGen(p1);
-         /* generate code for test */
-         cGen(p2);
-         emitRM_Abs("JEQ",ac,savedLoc1,"repeat: jmp back to body");
-         if (TraceCode)  emitComment("<- repeat") ;
-         break; /* repeat */
-
-      case AssignK:
-         if (TraceCode) emitComment("-> assign") ;
-         /* generate code for rhs */
-         cGen(tree->child[0]);
-         /* now store value */
-         loc = st_lookup(tree->attr.name);
-         emitRM("ST",ac,loc,gp,"assign: store value");
-         if (TraceCode)  emitComment("<- assign") ;
-         break; /* assign_k */
-
-      case ReadK:
-         emitRO("IN",ac,0,0,"read integer value");
-         loc = st_lookup(tree->attr.name);
-         emitRM("ST",ac,loc,gp,"read: store value");
-         break;
-      case WriteK:
-         /* generate code for expression to write */
-         cGen(tree->child[0]);
-         /* now output it */
-         emitRO("OUT",ac,0,0,"write ac");
-         break;
-      default:
-         break;
+/* Procedure popTemp loads the last temp into r */
+static void popTemp( int r, char * c)
+{ emitRM("LD",r,tmpLoc(--tmpOffset),fp,c);
+  emitInstruction(emitSize()-1)->temp = TRUE;
+}
+
+/* Function varLoc returns the offset of the first
+ * cell of variable s from its base register, which
+ * is stored in *reg (gp for globals, fp otherwise)
+ */
+static int varLoc( BucketList s, int * reg)
+{ if (s->nestedLevel == 0)
+  { *reg = gp;
+    return s->memloc;
+  }
+  *reg = fp;
+  return -(FRAME_HEADER + s->memloc + s->size - 1);
+}
+
+/* Function isConst returns TRUE if t is a constant */
+static int isConst( TreeNode * t)
+{ return t->nodekind == ExpK && t->kind.exp == ConstK; }
+
+/* Function needBoth returns the number of registers
+ * needed for two operands needing a and b registers
+ */
+static int needBoth( int a, int b)
+{ int n = a == b ? a + 1 : (a > b ? a : b);
+  return n > NREGS + 1 ? NREGS + 1 : n;
+}
+
+/* Function needElement returns the number of
+ * registers needed to address array element var
+ */
+static int need( TreeNode * t);
+static int needElement( TreeNode * var)
+{ int n;
+  if (isConst(var->child[0])) return var->symbol->isParam ? 1 : 0;
+  n = need(var->child[0]);
+  if (var->symbol->isParam && n < 2) n = 2;
+  return n;
+}
+
+/* Function need returns the Sethi-Ullman number of
+ * expression t: the registers needed to evaluate it
+ * without temps. A call needs more than there are,
+ * so that it is evaluated first
+ */
+static int need( TreeNode * t)
+{ int n;
+  switch (t->kind.exp) {
+    case IdK :
+      if (t->child[0] == NULL) return 1;
+      n = needElement(t);
+      return n < 1 ? 1 : n;
+    case AssignK :
+      n = need(t->child[1]);
+      if (t->child[0]->child[0] == NULL) return n;
+      return needBoth(n,needElement(t->child[0]));
+    case OpK :
+      return needBoth(need(t->child[0]),need(t->child[1]));
+    case CallK :
+      return NREGS + 1;
+    default :
+      return 1;
+  }
+}
+
+/* Function genElement generates code that makes the
+ * element var[index] addressable as off(reg); the
+ * offset is returned. The code uses regs[i] and up
+ * (two registers for an array parameter) and none
+ * for a constant index into an array that is not a
+ * parameter
+ */
+static int genElement( TreeNode * var, int i, int * reg)
+{ BucketList s = var->symbol;
+  TreeNode * index = var->child[0];
+  int loc = varLoc(s,reg);
+  if (s->isParam && isConst(index))
+  { emitRM("LD",REG(i),loc,fp,"load array address");
+    *reg = REG(i);
+    return index->attr.val;
+  }
+  if (s->isParam)
+  { /* the parameter holds the address of the array */
+    gen(index,i);
+    emitRM("LD",REG(i+1),loc,fp,"load array address");
+    emitRO("ADD",REG(i),REG(i),REG(i+1),"compute element address");
+    *reg = REG(i);
+    return 0;
+  }
+  if (isConst(index)) return loc + index->attr.val;
+  gen(index,i);
+  emitRO("ADD",REG(i),REG(i),*reg,"compute element address");
+  *reg = REG(i);
+  return loc;
+}
+
+/* Function sideEffects returns TRUE if evaluating
+ * expression t may call a function or assign
+ */
+static int sideEffects( TreeNode * t)
+{ int i;
+  if (t == NULL) return FALSE;
+  if (t->kind.exp == CallK || t->kind.exp == AssignK) return TRUE;
+  for (i = 0; i < MAXCHILDREN; i++)
+    if (sideEffects(t->child[i])) return TRUE;
+  return FALSE;
+}
+
+/* Procedure genTwo evaluates the operands a and b
+ * into two of the registers regs[i], regs[i+1]; the
+ * registers are returned in *ra and *rb. The operand
+ * needing more registers is evaluated first unless
+ * that would change the order of side effects, and
+ * the first value is kept in a temp if the second
+ * one needs all the registers
+ */
+static void genTwo( TreeNode * a, TreeNode * b, int i, int * ra, int * rb)
+{ int na = need(a), nb = need(b);
+  int swap = nb > na && !sideEffects(a) && !sideEffects(b);
+  TreeNode * first = swap ? b : a;
+  TreeNode * second = swap ? a : b;
+  int r1, r2;
+  gen(first,i);
+  if (need(second) <= NREGS - (i+1))
+  { gen(second,i+1);
+    r1 = REG(i);
+    r2 = REG(i+1);
+  }
+  else
+  { pushTemp(REG(i),"op: push operand");
+    gen(second,i);
+    popTemp(REG(i+1),"op: load operand");
+    r1 = REG(i+1);
+    r2 = REG(i);
+  }
+  *ra = first == a ? r1 : r2;
+  *rb = first == a ? r2 : r1;
+}
+
+/* Procedure genCall generates code at a call node;
+ * the value is left in regs[i]
+ */
+static void genCall( TreeNode * tree, int i)
+{ TreeNode * arg;
+  int base, n, k;
+  int savedOffset;
+  if (strcmp(tree->attr.name,"input") == 0)
+  { emitRO("IN",REG(i),0,0,"read integer value");
+    return;
+  }
+  if (strcmp(tree->attr.name,"output") == 0)
+  { gen(tree->child[0],i);
+    emitRO("OUT",REG(i),0,0,"write value");
+    return;
+  }
+  if (TraceCode) emitComment("-> call") ;
+  /* the callee may change every register */
+  for (k = 0; k < i; k++) pushTemp(REG(k),"call: save register");
+  savedOffset = tmpOffset;
+  /* the callee's activation record starts below the temps */
+  base = FRAME_HEADER + frameSize + tmpOffset;
+  for (arg = tree->child[0], n = 0; arg != NULL; arg = arg->sibling, n++)
+  { /* arguments already stored are temps of this frame */
+    tmpOffset = savedOffset + FRAME_HEADER + n;
+    gen(arg,0);
+    emitRM("ST",REG(0),-(base+FRAME_HEADER+n),fp,"store argument");
+  }
+  tmpOffset = savedOffset;
+  emitRM("ST",fp,-base,fp,"store control link");
+  emitRM("LDA",fp,-base,fp,"push activation record");
+  emitRM("LDA",ac,1,pc,"save return address");
+  emitRM_Abs("LDA",pc,tree->symbol->memloc,"jump to function");
+  if (i > 0)
+  { emitRM("LDA",REG(i),0,ac,"move function value");
+    for (k = i-1; k >= 0; k--) popTemp(REG(k),"call: restore register");
+  }
+  if (TraceCode) emitComment("<- call") ;
+}
+
+/* Procedure genAssign generates code at an
+ * assignment node; the value is left in regs[i].
+ * The index is evaluated before the right side,
+ * unless neither has side effects
+ */
+static void genAssign( TreeNode * tree, int i)
+{ TreeNode * var = tree->child[0];
+  TreeNode * rhs = tree->child[1];
+  int loc, reg, r = REG(i);
+  if (var->child[0] == NULL ||
+      (isConst(var->child[0]) && !var->symbol->isParam))
+  { gen(rhs,i);
+    if (var->child[0] == NULL) loc = varLoc(var->symbol,&reg);
+    else loc = varLoc(var->symbol,&reg) + var->child[0]->attr.val;
+    emitRM("ST",r,loc,reg,"assign: store value");
+  }
+  else if (need(rhs) >= needElement(var) &&
+           !sideEffects(rhs) && !sideEffects(var->child[0]))
+  { gen(rhs,i);
+    if (needElement(var) <= NREGS - (i+1))
+    { loc = genElement(var,i+1,&reg);
+      emitRM("ST",r,loc,reg,"assign: store value");
     }
-} /* genStmt */
+    else
+    { pushTemp(r,"assign: push value");
+      loc = genElement(var,i,&reg);
+      popTemp(REG(i+1),"assign: load value");
+      emitRM("ST",REG(i+1),loc,reg,"assign: store value");
+      emitRM("LDA",r,0,REG(i+1),"assign: value");
+    }
+  }
+  else
+  { /* the element address ends up in r */
+    loc = genElement(var,i,&reg);
+    if (need(rhs) <= NREGS - (i+1))
+    { gen(rhs,i+1);
+      emitRM("ST",REG(i+1),loc,reg,"assign: store value");
+      emitRM("LDA",r,0,REG(i+1),"assign: value");
+    }
+    else
+    { if (loc != 0) emitRM("LDA",r,loc,reg,"assign: element address");
+      pushTemp(r,"assign: push address");
+      gen(rhs,i);
+      popTemp(REG(i+1),"assign: load address");
+      emitRM("ST",r,0,REG(i+1),"assign: store value");
+    }
+  }
+}
 
-/* Procedure genExp generates code at an expression node */
-static void genExp( TreeNode * tree)
-{ int loc;
-  TreeNode * p1, * p2;
+/* Procedure gen generates code for expression tree,
+ * leaving its value in regs[i]
+ */
+static void gen( TreeNode * tree, int i)
+{ int loc, reg, ra, rb, r = REG(i);
   switch (tree->kind.exp) {
 
     case ConstK :
       if (TraceCode) emitComment("-> Const") ;
       /* gen code to load integer constant using LDC */
-      emitRM("LDC",ac,tree->attr.val,0,"load const");
+      emitRM("LDC",r,tree->attr.val,0,"load const");
       if (TraceCode)  emitComment("<- Const") ;
       break; /* ConstK */
-    
+
     case IdK :
       if (TraceCode) emitComment("-> Id") ;
-      loc = st_lookup(tree->attr.name);
-      emitRM("LD",ac,loc,gp,"load id value");
+      if (tree->child[0] != NULL)
+      { loc = genElement(tree,i,&reg);
+        emitRM("LD",r,loc,reg,"load array element");
+      }
+      else
+      { loc = varLoc(tree->symbol,&reg);
+        if (tree->symbol->type == IntegerArray && !tree->symbol->isParam)
+          emitRM("LDA",r,loc,reg,"load array address");
+        else
+          emitRM("LD",r,loc,reg,"load id value");
+      }
       if (TraceCode)  emitComment("<- Id") ;
       break; /* IdK */
 
+    case AssignK:
+      if (TraceCode) emitComment("-> assign") ;
+      genAssign(tree,i);
+      if (TraceCode)  emitComment("<- assign") ;
+      break; /* AssignK */
+
+    case CallK:
+      genCall(tree,i);
+      break; /* CallK */
+
     case OpK :
          if (TraceCode) emitComment("-> Op") ;
-         p1 = tree->child[0];
-         p2 = tree->child[1];
-         /* gen code for ac = left arg */
-         cGen(p1);
-         /* gen code to push left operand */
-         emitRM("ST",ac,tmpOffset--,mp,"op: push left");
-         /* gen code for ac = right operand */
-         cGen(p2);
-         /* now load left operand */
-         emitRM("LD",ac1,++tmpOffset,mp,"op: load left");
+         genTwo(tree->child[0],tree->child[1],i,&ra,&rb);
          switch (tree->attr.op) {
             case PLUS :
-               emitRO("ADD",ac,ac1,ac,"op +");
+               emitRO("ADD",r,ra,rb,"op +");
                break;
             case MINUS :
-               emitRO("SUB",ac,ac1,ac,"op -");
+               emitRO("SUB",r,ra,rb,"op -");
                break;
             case TIMES :
-               emitRO("MUL",ac,ac1,ac,"op *");
+               emitRO("MUL",r,ra,rb,"op *");
                break;
             case OVER :
-               emitRO("DIV",ac,ac1,ac,"op /");
+               emitRO("DIV",r,ra,rb,"op /");
                break;
             case LT :
-               emitRO("SUB",ac,ac1,ac,"op <") ;
-               emitRM("JLT",ac,2,pc,"br if true") ;
-               emitRM("LDC",ac,0,ac,"false case") ;
-               emitRM("LDA",pc,1,pc,"unconditional jmp") ;
-               emitRM("LDC",ac,1,ac,"true case") ;
-               break;
+            case LE :
+            case GT :
+            case GE :
             case EQ :
-               emitRO("SUB",ac,ac1,ac,"op ==") ;
-               emitRM("JEQ",ac,2,pc,"br if true");
-               emitRM("LDC",ac,0,ac,"false case") ;
+            case NE :
+               emitRO("SUB",r,ra,rb,"op relop") ;
+               emitRM(tree->attr.op == LT ? "JLT" :
+                      tree->attr.op == LE ? "JLE" :
+                      tree->attr.op == GT ? "JGT" :
+                      tree->attr.op == GE ? "JGE" :
+                      tree->attr.op == EQ ? "JEQ" : "JNE",
+                      r,2,pc,"br if true") ;
+               emitRM("LDC",r,0,0,"false case") ;
                emitRM("LDA",pc,1,pc,"unconditional jmp") ;
-               emitRM("LDC",ac,1,ac,"true case") ;
+               emitRM("LDC",r,1,0,"true case") ;
                break;
             default:
                emitComment("BUG: Unknown operator");
@@ -163,7 +377,163 @@ static void genExp( TreeNode * tree)
     default:
       break;
   }
-} /* genExp */
+} /* gen */
+
+/* Procedure genExp generates code at an expression
+ * node, leaving the value in ac
+ */
+static void genExp( TreeNode * tree)
+{ gen(tree,0); }
+
+/* Function genCond generates code for the test of
+ * an if or while and returns the opcode of the jump
+ * that leaves ac's test when the test is false. A
+ * relational test jumps on the SUB of its operands
+ * instead of on the 0/1 value of the comparison
+ */
+static char * genCond( TreeNode * tree)
+{ int ra, rb;
+  if (tree->nodekind != ExpK || tree->kind.exp != OpK)
+  { genExp(tree);
+    return "JEQ";
+  }
+  switch (tree->attr.op) {
+    case LT : case LE : case GT : case GE : case EQ : case NE :
+      if (TraceCode) emitComment("-> test") ;
+      genTwo(tree->child[0],tree->child[1],0,&ra,&rb);
+      emitRO("SUB",ac,ra,rb,"op relop") ;
+      if (TraceCode) emitComment("<- test") ;
+      switch (tree->attr.op) {
+        case LT : return "JGE";
+        case LE : return "JGT";
+        case GT : return "JLE";
+        case GE : return "JLT";
+        case EQ : return "JNE";
+        default : return "JEQ";
+      }
+    default :
+      genExp(tree);
+      return "JEQ";
+  }
+}
+
+/* Procedure genReturn generates the return sequence
+ * of a function; the return value is left in ac
+ */
+static void genReturn(void)
+{ emitRM("LD",ac1,-1,fp,"load return address");
+  emitRM("LD",fp,0,fp,"pop activation record");
+  emitRM("LDA",pc,0,ac1,"return to caller");
+}
+
+/* Procedure genStmt generates code at a statement node */
+static void genStmt( TreeNode * tree)
+{ TreeNode * p1, * p2, * p3;
+  int savedLoc1,savedLoc2,currentLoc;
+  char * jump;
+  emitLine(tree->lineno);
+  switch (tree->kind.stmt) {
+
+      case CompK :
+         if (TraceCode) emitComment("-> compound") ;
+         /* declarations need no code */
+         cGen(tree->child[1]);
+         if (TraceCode) emitComment("<- compound") ;
+         break; /* comp_k */
+
+      case IfK :
+         if (TraceCode) emitComment("-> if") ;
+         p1 = tree->child[0] ;
+         p2 = tree->child[1] ;
+         p3 = tree->child[2] ;
+         /* generate code for test expression */
+         jump = genCond(p1);
+         savedLoc1 = emitSkip(1) ;
+         emitComment("if: jump to else belongs here");
+         /* recurse on then part */
+         cGen(p2);
+         savedLoc2 = p3 != NULL ? emitSkip(1) : 0;
+         if (p3 != NULL) emitComment("if: jump to end belongs here");
+         currentLoc = emitSkip(0) ;
+         emitBackpatch(savedLoc1,jump,ac,currentLoc,"if: jmp to else");
+         if (p3 != NULL)
+         { /* recurse on else part */
+           cGen(p3);
+           currentLoc = emitSkip(0) ;
+           emitBackpatch(savedLoc2,"LDA",pc,currentLoc,"jmp to end");
+         }
+         if (TraceCode)  emitComment("<- if") ;
+         break; /* if_k */
+
+      case WhileK:
+         if (TraceCode) emitComment("-> while") ;
+         p1 = tree->child[0] ;
+         p2 = tree->child[1] ;
+         savedLoc1 = emitSkip(0);
+         emitComment("while: jump after body comes back here");
+         /* generate code for test */
+         jump = genCond(p1);
+         savedLoc2 = emitSkip(1);
+         emitComment("while: jump to end belongs here");
+         /* generate code for body */
+         cGen(p2);
+         emitLine(tree->lineno);
+         emitRM_Abs("LDA",pc,savedLoc1,"while: jmp back to test");
+         currentLoc = emitSkip(0) ;
+         emitBackpatch(savedLoc2,jump,ac,currentLoc,"while: jmp to end");
+         if (TraceCode)  emitComment("<- while") ;
+         break; /* while_k */
+
+      case ReturnK:
+         if (TraceCode) emitComment("-> return") ;
+         if (tree->child[0] != NULL) genExp(tree->child[0]);
+         genReturn();
+         if (TraceCode)  emitComment("<- return") ;
+         break; /* return_k */
+
+      default:
+         break;
+    }
+} /* genStmt */
+
+/* Function scopeSize returns the number of locations
+ * used by the declarations in tree (siblings included)
+ */
+static int scopeSize( TreeNode * tree)
+{ int size = 0, n, i;
+  for (; tree != NULL; tree = tree->sibling)
+  { if (tree->nodekind == DeclK && tree->symbol != NULL)
+    { n = tree->symbol->memloc + tree->symbol->size;
+      if (n > size) size = n;
+    }
+    for (i = 0; i < MAXCHILDREN; i++)
+    { n = scopeSize(tree->child[i]);
+      if (n > size) size = n;
+    }
+  }
+  return size;
+}
+
+/* Procedure genFunc generates code for a function
+ * declaration. The caller has stored the return
+ * address in ac; the memloc of the function symbol
+ * is set to the entry address
+ */
+static void genFunc( TreeNode * tree)
+{ if (TraceCode) emitComment("-> function") ;
+  emitLine(tree->lineno);
+  emitFunction(tree->attr.name);
+  tree->symbol->memloc = emitSkip(0);
+  frameSize = scopeSize(tree->child[0]);
+  if (scopeSize(tree->child[1]) > frameSize)
+    frameSize = scopeSize(tree->child[1]);
+  tmpOffset = 0;
+  emitRM("ST",ac,-1,fp,"store return address");
+  cGen(tree->child[1]);
+  emitLine(tree->lineno);
+  genReturn();
+  if (TraceCode) emitComment("<- function") ;
+}
 
 /* Procedure cGen recursively generates code by
  * tree traversal
@@ -175,6 +545,7 @@ static void cGen( TreeNode * tree)
         genStmt(tree);
         break;
       case ExpK:
+        emitLine(tree->lineno);
         genExp(tree);
         break;
       default:
@@ -195,18 +566,31 @@ static void cGen( TreeNode * tree)
  */
 void codeGen(TreeNode * syntaxTree, char * codefile)
 {  char * s = malloc(strlen(codefile)+7);
+   TreeNode * t, * mainFunc = NULL;
+   int mainLoc;
    strcpy(s,"File: ");
    strcat(s,codefile);
-   emitComment("TINY Compilation to TM Code");
+   emitComment("C-MINUS Compilation to TM Code");
    emitComment(s);
    /* generate standard prelude */
    emitComment("Standard prelude:");
-   emitRM("LD",mp,0,ac,"load maxaddress from location 0");
+   emitRM("LD",fp,0,ac,"load maxaddress from location 0");
    emitRM("ST",ac,0,ac,"clear location 0");
-   emitComment("End of standard prelude.");
-   /* generate code for TINY program */
-   cGen(syntaxTree);
-   /* finish */
+   emitRM("LDA",ac,1,pc,"save return address");
+   mainLoc = emitSkip(1);
    emitComment("End of execution.");
    emitRO("HALT",0,0,0,"");
+   emitComment("End of standard prelude.");
+   /* generate code for C-MINUS functions */
+   for (t = syntaxTree; t != NULL; t = t->sibling)
+     if (t->nodekind == DeclK && t->kind.decl == FunK)
+     { genFunc(t);
+       if (strcmp(t->attr.name,"main") == 0) mainFunc = t;
+     }
+   /* call main from the prelude */
+   emitBackpatch(mainLoc,"LDA",pc,
+                 mainFunc != NULL ? mainFunc->symbol->memloc : mainLoc+1,
+                 "jump to main");
+   peephole();
+   emitFlush(NULL);
 }
@@ -152,7 +152,7 @@ param : type_specifier identifier
         | type_specifier identifier LBRACE RBRACE
         {
           $$ = newDeclNode(ParamK);
-          $$->type = $1->type;
+          $$->type = $1->type == Integer ? IntegerArray : VoidArray;
           $$->attr.name = $2->attr.name;
           $$->lineno = lineno;
         } 
@@ -0,0 +1,42 @@
+/****************************************************/
+/* File: cmrt.c                                     */
+/* Runtime of C-Minus programs compiled to x86-64   */
+/* assembly (-S): build with gcc prog.s cmrt.c      */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+void cm_main(void);
+
+/* Function cm_input reads an integer from the
+ * standard input; the program stops at the end of
+ * the input or on bad input
+ */
+int cm_input(void)
+{ int n;
+  if (scanf("%d",&n) != 1)
+  { fprintf(stderr,"Illegal value\n");
+    exit(1);
+  }
+  return n;
+}
+
+/* Procedure cm_output writes an integer on a line */
+void cm_output(int n)
+{ printf("%d\n",n);
+}
+
+/* Procedure cm_divzero stops the program at a
+ * division by 0, as the TM does
+ */
+void cm_divzero(void)
+{ fflush(stdout);
+  fprintf(stderr,"Division by 0\n");
+  exit(1);
+}
+
+int main(void)
+{ cm_main();
+  return 0;
+}
@@ -6,22 +6,107 @@
 /* Kenneth C. Louden                                */
 /****************************************************/
 
+#include <stdarg.h>
 #include "globals.h"
 #include "code.h"
+#include "tmobj.h"
+
+/* the code buffer, indexed by TM location */
+static Instruction * codeBuf = NULL;
+static int codeSize = 0;
+
+/* comment lines, in order of emission */
+typedef struct
+   { int loc; /* location of the instruction that follows */
+     char * text;
+   } Comment;
+
+static Comment * comments = NULL;
+static int commentCount = 0;
+static int commentSize = 0;
+
+/* the functions, in order of entry location */
+typedef struct
+   { int loc;
+     char * name;
+   } FuncEntry;
+
+static FuncEntry * functions = NULL;
+static int functionCount = 0;
+static int functionSize = 0;
 
 /* TM location number for current instruction emission */
 static int emitLoc = 0 ;
 
-/* Highest TM location emitted so far
-   For use in conjunction with emitSkip,
-   emitBackup, and emitRestore */
+/* Highest TM location emitted so far */
 static int highEmitLoc = 0;
 
-/* Procedure emitComment prints a comment line 
- * with comment c in the code file
+/* source line of the instructions emitted next */
+static int emitLineno = 0;
+
+/* Function slot returns the buffer entry for
+ * location loc, growing the buffer as needed
+ */
+static Instruction * slot( int loc)
+{ if (loc >= codeSize)
+  { int n = codeSize ? codeSize : 256;
+    while (n <= loc) n *= 2;
+    codeBuf = (Instruction *) realloc(codeBuf, n * sizeof(Instruction));
+    memset(codeBuf + codeSize, 0, (n - codeSize) * sizeof(Instruction));
+    codeSize = n;
+  }
+  return &codeBuf[loc];
+}
+
+/* Procedure store enters an instruction at
+ * location loc of the buffer
+ */
+static void store( int loc, char * op, int r, int s, int t, int rm, char * c)
+{ Instruction * in = slot(loc);
+  in->op = op;
+  in->r = r;
+  in->s = s;
+  in->t = t;
+  in->rm = rm;
+  in->temp = FALSE;
+  in->lineno = emitLineno;
+  in->comment = c;
+  if (highEmitLoc < loc + 1) highEmitLoc = loc + 1;
+}
+
+/* Procedure emitComment records a comment line
+ * for the code file
  */
 void emitComment( char * c )
-{ if (TraceCode) fprintf(code,"* %s\n",c);}
+{ if (! TraceCode) return;
+  if (commentCount == commentSize)
+  { commentSize = commentSize ? commentSize * 2 : 64;
+    comments = (Comment *) realloc(comments, commentSize * sizeof(Comment));
+  }
+  comments[commentCount].loc = emitLoc;
+  comments[commentCount].text = c;
+  commentCount++;
+}
+
+/* Procedure emitLine sets the source line of the
+ * instructions emitted next
+ */
+void emitLine( int lineno)
+{ emitLineno = lineno;
+}
+
+/* Procedure emitFunction records that function
+ * name starts at the current location
+ */
+void emitFunction( char * name)
+{ if (functionCount == functionSize)
+  { functionSize = functionSize ? functionSize * 2 : 16;
+    functions = (FuncEntry *) realloc(functions, functionSize * sizeof(FuncEntry));
+  }
+  functions[functionCount].loc = emitLoc;
+  functions[functionCount].name = name;
+  functionCount++;
+}
 
 /* Procedure emitRO emits a register-only
  * TM instruction
@@ -32,10 +117,7 @@ void emitComment( char * c )
  * c = a comment to be printed if TraceCode is TRUE
  */
 void emitRO( char *op, int r, int s, int t, char *c)
-{ fprintf(code,"%3d:  %5s  %d,%d,%d ",emitLoc++,op,r,s,t);
-  if (TraceCode) fprintf(code,"\t%s",c) ;
-  fprintf(code,"\n") ;
-  if (highEmitLoc < emitLoc) highEmitLoc = emitLoc ;
+{ store(emitLoc++,op,r,s,t,FALSE,c);
 } /* emitRO */
 
 /* Procedure emitRM emits a register-to-memory
@@ -47,10 +129,7 @@ void emitRO( char *op, int r, int s, int t, char *c)
  * c = a comment to be printed if TraceCode is TRUE
  */
 void emitRM( char * op, int r, int d, int s, char *c)
-{ fprintf(code,"%3d:  %5s  %d,%d(%d) ",emitLoc++,op,r,d,s);
-  if (TraceCode) fprintf(code,"\t%s",c) ;
-  fprintf(code,"\n") ;
-  if (highEmitLoc < emitLoc)  highEmitLoc = emitLoc ;
+{ store(emitLoc++,op,r,s,d,TRUE,c);
 } /* emitRM */
 
 /* Function emitSkip skips "howMany" code
@@ -59,27 +138,12 @@ void emitRM( char * op, int r, int d, int s, char *c)
  */
 int emitSkip( int howMany)
 {  int i = emitLoc;
-   emitLoc += howMany ;
+   for (; howMany > 0; howMany--) slot(emitLoc++)->lineno = emitLineno;
    if (highEmitLoc < emitLoc)  highEmitLoc = emitLoc ;
    return i;
 } /* emitSkip */
 
-/* Procedure emitBackup backs up to 
- * loc = a previously skipped location
- */
-void emitBackup( int loc)
-{ if (loc > highEmitLoc) emitComment("BUG in emitBackup");
-  emitLoc = loc ;
-} /* emitBackup */
-
-/* Procedure emitRestore restores the current 
- * code position to the highest previously
- * unemitted position
- */
-void emitRestore(void)
-{ emitLoc = highEmitLoc;}
-
-/* Procedure emitRM_Abs converts an absolute reference 
+/* Procedure emitRM_Abs converts an absolute reference
  * to a pc-relative reference when emitting a
  * register-to-memory TM instruction
  * op = the opcode
@@ -88,10 +152,177 @@ void emitRestore(void)
  * c = a comment to be printed if TraceCode is TRUE
  */
 void emitRM_Abs( char *op, int r, int a, char * c)
-{ fprintf(code,"%3d:  %5s  %d,%d(%d) ",
-               emitLoc,op,r,a-(emitLoc+1),pc);
+{ store(emitLoc,op,r,pc,a-(emitLoc+1),TRUE,c);
   ++emitLoc ;
-  if (TraceCode) fprintf(code,"\t%s",c) ;
-  fprintf(code,"\n") ;
-  if (highEmitLoc < emitLoc) highEmitLoc = emitLoc ;
 } /* emitRM_Abs */
+
+/* Procedure emitBackpatch stores at the skipped
+ * location loc the instruction emitRM_Abs would
+ * emit there
+ */
+void emitBackpatch( int loc, char *op, int r, int a, char * c)
+{ int lineno;
+  if (loc >= highEmitLoc) emitComment("BUG in emitBackpatch");
+  /* the jump keeps the line of the skip */
+  lineno = slot(loc)->lineno;
+  store(loc,op,r,pc,a-(loc+1),TRUE,c);
+  slot(loc)->lineno = lineno;
+} /* emitBackpatch */
+
+/* Function emitInstruction returns the buffered
+ * instruction at location loc
+ */
+Instruction * emitInstruction( int loc)
+{ return slot(loc); }
+
+/* Function emitSize returns the number of code
+ * locations emitted so far
+ */
+int emitSize(void)
+{ return highEmitLoc; }
+
+/* Procedure emitCompact removes the deleted
+ * locations and adjusts pc-relative references
+ */
+void emitCompact(void)
+{ int * newLoc = (int *) malloc((highEmitLoc + 1) * sizeof(int));
+  int loc, n = 0, target, i;
+  for (loc = 0; loc < highEmitLoc; loc++)
+  { newLoc[loc] = n;
+    if (slot(loc)->op != NULL) n++;
+  }
+  newLoc[highEmitLoc] = n;
+  for (loc = 0; loc < highEmitLoc; loc++)
+  { Instruction * in = &codeBuf[loc];
+    if (in->op == NULL) continue;
+    if (in->rm && in->s == pc && strcmp(in->op,"LDC") != 0)
+    { target = loc + 1 + in->t;
+      if (target < 0) target = 0;
+      if (target > highEmitLoc) target = highEmitLoc;
+      in->t = newLoc[target] - (newLoc[loc] + 1);
+    }
+    codeBuf[newLoc[loc]] = *in;
+  }
+  for (loc = n; loc < highEmitLoc; loc++)
+    memset(&codeBuf[loc],0,sizeof(Instruction));
+  for (i = 0; i < commentCount; i++)
+    comments[i].loc = newLoc[comments[i].loc > highEmitLoc ?
+                             highEmitLoc : comments[i].loc];
+  for (i = 0; i < functionCount; i++)
+    functions[i].loc = newLoc[functions[i].loc > highEmitLoc ?
+                               highEmitLoc : functions[i].loc];
+  emitLoc = highEmitLoc = n;
+  free(newLoc);
+} /* emitCompact */
+
+/* the text of the code file under construction */
+static char * text = NULL;
+static size_t textLen = 0;
+static size_t textSize = 0;
+
+static void put(const char * fmt, ...)
+{ va_list ap;
+  int n;
+  for (;;)
+  { va_start(ap, fmt);
+    n = vsnprintf(text + textLen, textSize - textLen, fmt, ap);
+    va_end(ap);
+    if (n >= 0 && textLen + n < textSize) break;
+    textSize = textSize ? textSize * 2 : 65536;
+    if (n >= 0 && textSize < textLen + n + 1) textSize = textLen + n + 1;
+    text = (char *) realloc(text, textSize);
+  }
+  textLen += n;
+}
+
+/* the opcodes of the TM, at their number in a
+ * TM object file
+ */
+static char * opNames[] =
+   { "HALT", "IN", "OUT", "ADD", "SUB", "MUL", "DIV", "",
+     "LD", "ST", "",
+     "LDA", "LDC", "JLT", "JLE", "JGT", "JGE", "JEQ", "JNE", NULL };
+
+/* Procedure putBinary serialises the code buffer
+ * as a TM object file
+ */
+static void putBinary(void)
+{ TmoHeader h;
+  TmoInstr * code;
+  TmoFunc * func;
+  int * lines;
+  int loc, op, i;
+  size_t size = sizeof(TmoHeader) +
+                highEmitLoc * (sizeof(TmoInstr) + sizeof(int)) +
+                sizeof(int) + functionCount * sizeof(TmoFunc);
+  if (textSize < size)
+  { textSize = size;
+    text = (char *) realloc(text, textSize);
+  }
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, TMO_MAGIC, 4);
+  h.version = TMO_VERSION;
+  h.count = highEmitLoc;
+  h.flags = TMO_LINES | TMO_FUNCS;
+  memcpy(text, &h, sizeof(h));
+  code = (TmoInstr *) (text + sizeof(h));
+  lines = (int *) (code + highEmitLoc);
+  for (loc = 0; loc < highEmitLoc; loc++)
+  { Instruction * in = slot(loc);
+    code[loc].op = TMO_HALT;
+    code[loc].r = code[loc].a = code[loc].b = 0;
+    lines[loc] = in->lineno;
+    if (in->op == NULL) continue;
+    for (op = 0; opNames[op] != NULL && strcmp(opNames[op],in->op) != 0; op++)
+      ;
+    code[loc].op = op;
+    code[loc].r = in->r;
+    code[loc].a = in->rm ? in->t : in->s;
+    code[loc].b = in->rm ? in->s : in->t;
+  }
+  memcpy(lines + highEmitLoc, &functionCount, sizeof(int));
+  func = (TmoFunc *) (lines + highEmitLoc + 1);
+  memset(func, 0, functionCount * sizeof(TmoFunc));
+  for (i = 0; i < functionCount; i++)
+  { func[i].loc = functions[i].loc;
+    strncpy(func[i].name, functions[i].name, TMO_NAMESIZE - 1);
+  }
+  textLen = size;
+}
+
+/* Procedure emitFlush serialises the code buffer
+ * and passes the text to writer in one call
+ */
+void emitFlush( CodeWriter writer)
+{ Instruction * in;
+  int loc, i = 0;
+  textLen = 0;
+  if (BinaryCode)
+  { putBinary();
+    i = commentCount;
+    loc = highEmitLoc + 1;
+  }
+  else loc = 0;
+  for (; loc <= highEmitLoc; loc++)
+  { for (; i < commentCount && comments[i].loc <= loc; i++)
+      put("* %s\n",comments[i].text);
+    if (loc == highEmitLoc) break;
+    in = slot(loc);
+    if (in->op == NULL) continue;
+    if (in->rm)
+      put("%3d:  %5s  %d,%d(%d) ",loc,in->op,in->r,in->t,in->s);
+    else
+      put("%3d:  %5s  %d,%d,%d ",loc,in->op,in->r,in->s,in->t);
+    if (TraceCode) put("\t%s",in->comment) ;
+    put("\n");
+  }
+  for (; i < commentCount; i++)
+    put("* %s\n",comments[i].text);
+  emitLineno = 0;
+  functionCount = 0;
+  if (writer != NULL) writer(text,textLen);
+  else fwrite(text,1,textLen,code);
+  if (codeBuf != NULL) memset(codeBuf,0,codeSize * sizeof(Instruction));
+  commentCount = 0;
+  emitLoc = highEmitLoc = 0;
+} /* emitFlush */
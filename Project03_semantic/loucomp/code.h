@@ -17,6 +17,12 @@
  */
 #define  mp 6
 
+/* fp = "frame pointer" points to the
+ * activation record of the running
+ * function (stack grows downward)
+ */
+#define fp 4
+
 /* gp = "global pointer" points
  * to bottom of memory for (global)
  * variable storage
@@ -29,13 +35,40 @@
 /* 2nd accumulator */
 #define  ac1 1
 
+/* TM instruction kept in the code buffer */
+typedef struct
+   { char * op; /* opcode, NULL for a location not yet emitted */
+     int r, s, t; /* RO: r,s,t  RM: r,d(s) with d stored in t */
+     int rm; /* TRUE for a register-to-memory instruction */
+     int temp; /* TRUE for the spill or reload of an expression temp */
+     int lineno; /* source line of the instruction, 0 if none */
+     char * comment;
+   } Instruction;
+
+/* CodeWriter receives the code file text, len bytes */
+typedef void (* CodeWriter)(const char * text, size_t len);
+
 /* code emitting utilities */
 
-/* Procedure emitComment prints a comment line 
- * with comment c in the code file
+/* Procedure emitComment records a comment line 
+ * for the code file, placed before the instruction
+ * at the current code position. The string must
+ * stay valid until emitFlush
  */
 void emitComment( char * c );
 
+/* Procedure emitLine sets the source line of
+ * the instructions emitted next (0: none); a
+ * skipped location keeps the line at the skip
+ */
+void emitLine( int lineno);
+
+/* Procedure emitFunction records that function
+ * name starts at the current location, for the
+ * function table of an object file
+ */
+void emitFunction( char * name);
+
 /* Procedure emitRO emits a register-only
  * TM instruction
  * op = the opcode
@@ -62,17 +95,6 @@ void emitRM( char * op, int r, int d, int s, char *c);
  */
 int emitSkip( int howMany);
 
-/* Procedure emitBackup backs up to 
- * loc = a previously skipped location
- */
-void emitBackup( int loc);
-
-/* Procedure emitRestore restores the current 
- * code position to the highest previously
- * unemitted position
- */
-void emitRestore(void);
-
 /* Procedure emitRM_Abs converts an absolute reference 
  * to a pc-relative reference when emitting a
  * register-to-memory TM instruction
@@ -83,4 +105,35 @@ void emitRestore(void);
  */
 void emitRM_Abs( char *op, int r, int a, char * c);
 
+/* Procedure emitBackpatch stores at the skipped
+ * location loc the instruction emitRM_Abs would
+ * emit there
+ */
+void emitBackpatch( int loc, char *op, int r, int a, char * c);
+
+/* Function emitInstruction returns the buffered
+ * instruction at location loc, for changes in place
+ */
+Instruction * emitInstruction( int loc);
+
+/* Function emitSize returns the number of code
+ * locations emitted so far
+ */
+int emitSize(void);
+
+/* Procedure emitCompact removes the locations whose
+ * op was set to NULL, moving the code up and adjusting
+ * pc-relative references. A reference to a removed
+ * location is moved to the next remaining one
+ */
+void emitCompact(void);
+
+/* Procedure emitFlush serialises the code buffer as
+ * TM text code, or as a TM object file (tmobj.h)
+ * with BinaryCode, and passes it to writer in one
+ * call (NULL: one write to the code file), then
+ * empties the buffer
+ */
+void emitFlush( CodeWriter writer);
+
 #endif
@@ -0,0 +1,383 @@
+/****************************************************/
+/* File: ctrans.c                                   */
+/* Translation of C-Minus programs to C             */
+/****************************************************/
+
+#include <stdarg.h>
+#include "globals.h"
+#include "symtab.h"
+#include "ctrans.h"
+
+/* The C keeps the meaning the TM gives the program:
+ *   integers wrap around (the helpers compute in
+ *   unsigned arithmetic)
+ *   a comparison tests the wrapped difference of its
+ *   operands, as the TM code does with SUB and a
+ *   conditional jump
+ *   a division by 0 stops the program
+ *   operands, indices and arguments are evaluated
+ *   from left to right: where a later one has side
+ *   effects, the earlier ones are kept in temporaries
+ * Names cannot clash: a variable x declared at
+ * nesting level n is x_n, a function f is f_f, and
+ * C-Minus identifiers hold no underscore
+ */
+static const char * prelude[] =
+{ "#include <stdio.h>",
+  "#include <stdlib.h>",
+  "",
+  "static inline int cm_input(void)",
+  "{ int n;",
+  "  if (scanf(\"%d\",&n) != 1)",
+  "  { fprintf(stderr,\"Illegal value\\n\");",
+  "    exit(1);",
+  "  }",
+  "  return n;",
+  "}",
+  "",
+  "static inline void cm_output(int n)",
+  "{ printf(\"%d\\n\",n);",
+  "}",
+  "",
+  "static inline int cm_add(int a, int b) { return (int) ((unsigned) a + (unsigned) b); }",
+  "static inline int cm_sub(int a, int b) { return (int) ((unsigned) a - (unsigned) b); }",
+  "static inline int cm_mul(int a, int b) { return (int) ((unsigned) a * (unsigned) b); }",
+  "",
+  "static inline int cm_div(int a, int b)",
+  "{ if (b == 0)",
+  "  { fflush(stdout);",
+  "    fprintf(stderr,\"Division by 0\\n\");",
+  "    exit(1);",
+  "  }",
+  "  return a / b;",
+  "}",
+  "",
+  "static inline int cm_lt(int a, int b) { return cm_sub(a,b) < 0; }",
+  "static inline int cm_le(int a, int b) { return cm_sub(a,b) <= 0; }",
+  "static inline int cm_gt(int a, int b) { return cm_sub(a,b) > 0; }",
+  "static inline int cm_ge(int a, int b) { return cm_sub(a,b) >= 0; }",
+  "static inline int cm_eq(int a, int b) { return cm_sub(a,b) == 0; }",
+  "static inline int cm_ne(int a, int b) { return cm_sub(a,b) != 0; }",
+  NULL
+};
+
+/* indentation of the current line, number of the
+ * last temporary of the function
+ */
+static int indent;
+static int temps;
+
+/* Function format returns a new string formatted
+ * like printf
+ */
+static char * format(const char * fmt, ...)
+{ va_list ap;
+  char * s;
+  int n;
+  va_start(ap, fmt);
+  n = vsnprintf(NULL, 0, fmt, ap);
+  va_end(ap);
+  s = (char *) malloc(n + 1);
+  va_start(ap, fmt);
+  vsnprintf(s, n + 1, fmt, ap);
+  va_end(ap);
+  return s;
+}
+
+/* Procedure line writes an indented line of C */
+static void line(const char * fmt, ...)
+{ va_list ap;
+  fprintf(code,"%*s",2 * indent,"");
+  va_start(ap, fmt);
+  vfprintf(code, fmt, ap);
+  va_end(ap);
+  fputc('\n', code);
+}
+
+/* Function varName returns the C name of variable s */
+static char * varName(BucketList s)
+{ return format("%s_%d",s->name,s->nestedLevel);
+}
+
+/* Function pure returns TRUE if expression t has no
+ * side effects (no call and no assignment)
+ */
+static int pure(TreeNode * t)
+{ int i;
+  if (t == NULL) return TRUE;
+  if (t->nodekind == ExpK &&
+      (t->kind.exp == CallK || t->kind.exp == AssignK)) return FALSE;
+  for (i = 0; i < MAXCHILDREN; i++)
+    if (!pure(t->child[i])) return FALSE;
+  return TRUE;
+}
+
+/* Function stable returns TRUE for an operand no
+ * side effect can change: a constant or an array
+ */
+static int stable(TreeNode * t)
+{ if (t->nodekind != ExpK) return FALSE;
+  if (t->kind.exp == ConstK) return TRUE;
+  return t->kind.exp == IdK && t->child[0] == NULL &&
+         t->symbol->type == IntegerArray;
+}
+
+/* Function ordered returns TRUE if operand a,
+ * evaluated before b, must be kept in a temporary
+ * to stay ahead of b
+ */
+static int ordered(TreeNode * a, TreeNode * b)
+{ return !stable(a) && !stable(b) && (!pure(a) || !pure(b));
+}
+
+/* Function hoist evaluates expression e into a new
+ * temporary and returns its name
+ */
+static char * hoist(char * e)
+{ char * t = format("t%d",++temps);
+  line("int %s = %s;",t,e);
+  free(e);
+  return t;
+}
+
+static char * genExp(TreeNode * t);
+
+/* Function genCall returns the C of call t */
+static char * genCall(TreeNode * t)
+{ TreeNode * arg;
+  char * s, * a, * r;
+  if (strcmp(t->attr.name,"input") == 0) return format("cm_input()");
+  s = format("");
+  for (arg = t->child[0]; arg != NULL; arg = arg->sibling)
+  { TreeNode * later;
+    a = genExp(arg);
+    for (later = arg->sibling; later != NULL; later = later->sibling)
+      if (ordered(arg,later)) break;
+    if (later != NULL) a = hoist(a);
+    r = format("%s%s%s",s,arg == t->child[0] ? "" : ", ",a);
+    free(s);
+    free(a);
+    s = r;
+  }
+  if (strcmp(t->attr.name,"output") == 0) r = format("cm_output(%s)",s);
+  else r = format("f_%s(%s)",t->attr.name,s);
+  free(s);
+  return r;
+}
+
+/* Function genExp returns the C of expression t;
+ * the side effects that must come first are
+ * written out as temporaries
+ */
+static char * genExp(TreeNode * t)
+{ char * a, * b, * n, * r;
+  const char * op;
+  switch (t->kind.exp)
+  { case ConstK :
+      if (t->attr.val == -2147483647 - 1) return format("(-2147483647 - 1)");
+      return format(t->attr.val < 0 ? "(%d)" : "%d",t->attr.val);
+    case IdK :
+      n = varName(t->symbol);
+      if (t->child[0] == NULL) return n;
+      a = genExp(t->child[0]);
+      r = format("%s[%s]",n,a);
+      free(n);
+      free(a);
+      return r;
+    case AssignK :
+      n = varName(t->child[0]->symbol);
+      if (t->child[0]->child[0] == NULL)
+      { b = genExp(t->child[1]);
+        r = format("(%s = %s)",n,b);
+      }
+      else
+      { /* the index is evaluated before the right side */
+        a = genExp(t->child[0]->child[0]);
+        if (ordered(t->child[0]->child[0],t->child[1])) a = hoist(a);
+        b = genExp(t->child[1]);
+        r = format("(%s[%s] = %s)",n,a,b);
+        free(a);
+      }
+      free(n);
+      free(b);
+      return r;
+    case OpK :
+      a = genExp(t->child[0]);
+      if (ordered(t->child[0],t->child[1])) a = hoist(a);
+      b = genExp(t->child[1]);
+      switch (t->attr.op)
+      { case PLUS : op = "add"; break;
+        case MINUS : op = "sub"; break;
+        case TIMES : op = "mul"; break;
+        case OVER : op = "div"; break;
+        case LT : op = "lt"; break;
+        case LE : op = "le"; break;
+        case GT : op = "gt"; break;
+        case GE : op = "ge"; break;
+        case EQ : op = "eq"; break;
+        default : op = "ne"; break;
+      }
+      r = format("cm_%s(%s, %s)",op,a,b);
+      free(a);
+      free(b);
+      return r;
+    case CallK :
+      return genCall(t);
+    default :
+      return format("0");
+  }
+}
+
+static void genStmt(TreeNode * t);
+
+/* Procedure genDecls declares the variables of
+ * declaration list t; local scalars start at 0
+ */
+static void genDecls(TreeNode * t, int local)
+{ char * n;
+  for (; t != NULL; t = t->sibling)
+  { if (t->nodekind != DeclK || t->kind.decl != VarK || t->symbol == NULL)
+      continue;
+    n = varName(t->symbol);
+    if (t->symbol->type == IntegerArray)
+      line("%sint %s[%d];",local ? "" : "static ",n,t->symbol->size);
+    else line(local ? "int %s = 0;" : "static int %s;",n);
+    free(n);
+  }
+}
+
+/* Procedure genBody generates statement t as a
+ * block
+ */
+static void genBody(TreeNode * t)
+{ if (t != NULL && t->nodekind == StmtK && t->kind.stmt == CompK)
+  { genStmt(t);
+    return;
+  }
+  line("{");
+  indent++;
+  genStmt(t);
+  indent--;
+  line("}");
+}
+
+/* Procedure genStmt generates statement t */
+static void genStmt(TreeNode * t)
+{ char * c;
+  if (t == NULL) return;
+  if (t->nodekind == ExpK)
+  { c = genExp(t);
+    line("%s;",c);
+    free(c);
+    return;
+  }
+  if (t->nodekind != StmtK) return;
+  switch (t->kind.stmt)
+  { case CompK :
+      line("{");
+      indent++;
+      genDecls(t->child[0],TRUE);
+      for (t = t->child[1]; t != NULL; t = t->sibling) genStmt(t);
+      indent--;
+      line("}");
+      break;
+    case IfK :
+      c = genExp(t->child[0]);
+      line("if (%s)",c);
+      free(c);
+      genBody(t->child[1]);
+      if (t->child[2] != NULL)
+      { line("else");
+        genBody(t->child[2]);
+      }
+      break;
+    case WhileK :
+      if (pure(t->child[0]))
+      { c = genExp(t->child[0]);
+        line("while (%s)",c);
+        free(c);
+        genBody(t->child[1]);
+        break;
+      }
+      /* the temporaries of the test are made anew
+       * in each iteration
+       */
+      line("for (;;)");
+      line("{");
+      indent++;
+      c = genExp(t->child[0]);
+      line("if (!%s) break;",c);
+      free(c);
+      genBody(t->child[1]);
+      indent--;
+      line("}");
+      break;
+    case ReturnK :
+      if (t->child[0] == NULL) line("return;");
+      else
+      { c = genExp(t->child[0]);
+        line("return %s;",c);
+        free(c);
+      }
+      break;
+    default :
+      break;
+  }
+}
+
+/* Procedure genHeader writes the head of function t */
+static void genHeader(TreeNode * t, const char * end)
+{ TreeNode * p;
+  char * s = format(""), * n, * r;
+  for (p = t->child[0]; p != NULL; p = p->sibling)
+  { if (p->symbol == NULL) continue;
+    n = varName(p->symbol);
+    r = format("%s%sint %s%s",s,*s ? ", " : "",
+               p->symbol->type == IntegerArray ? "* " : "",n);
+    free(s);
+    free(n);
+    s = r;
+  }
+  line("static %s f_%s(%s)%s",t->symbol->type == Void ? "void" : "int",
+       t->attr.name,*s ? s : "void",end);
+  free(s);
+}
+
+/* Procedure genFunc generates function t */
+static void genFunc(TreeNode * t)
+{ TreeNode * body = t->child[1];
+  temps = 0;
+  line("");
+  genHeader(t,"");
+  line("{");
+  indent++;
+  genDecls(body->child[0],TRUE);
+  for (body = body->child[1]; body != NULL; body = body->sibling) genStmt(body);
+  /* falling off the end returns an unknown value */
+  if (t->symbol->type != Void) line("return 0;");
+  indent--;
+  line("}");
+}
+
+/* Procedure cCodeGen writes the syntax tree as a C
+ * program to the code file
+ */
+void cCodeGen(TreeNode * syntaxTree, char * codefile)
+{ TreeNode * t;
+  int i;
+  indent = 0;
+  line("/* C-MINUS Compilation to C */");
+  line("/* File: %s */",codefile);
+  for (i = 0; prelude[i] != NULL; i++) line("%s",prelude[i]);
+  line("");
+  for (t = syntaxTree; t != NULL; t = t->sibling)
+    if (t->nodekind == DeclK && t->kind.decl == FunK) genHeader(t,";");
+  genDecls(syntaxTree,FALSE);
+  for (t = syntaxTree; t != NULL; t = t->sibling)
+    if (t->nodekind == DeclK && t->kind.decl == FunK) genFunc(t);
+  line("");
+  line("int main(void)");
+  line("{ f_main();");
+  line("  return 0;");
+  line("}");
+}
@@ -0,0 +1,16 @@
+/****************************************************/
+/* File: ctrans.h                                   */
+/* Translation of C-Minus programs to C             */
+/****************************************************/
+
+#ifndef _CTRANS_H_
+#define _CTRANS_H_
+
+/* Procedure cCodeGen writes the analysed syntax
+ * tree to the code file as a self-contained C
+ * program (gcc -O2 prog.c) whose results match
+ * the TM code of the program
+ */
+void cCodeGen(TreeNode * syntaxTree, char * codefile);
+
+#endif
@@ -0,0 +1,205 @@
+/****************************************************/
+/* File: diag.c                                     */
+/* Diagnostics buffer for the C-Minus compiler      */
+/****************************************************/
+
+#include <stdarg.h>
+#include "globals.h"
+#include "symtab.h"
+#include "diag.h"
+
+/* the shared list, flushed after each phase */
+static DiagList shared;
+
+/* errors of the shared list already flushed, for the cap */
+static int flushed = 0;
+
+/* list of the calling thread, NULL for the shared list */
+static _Thread_local DiagList * current = NULL;
+
+/* number of line numbers in the line list of symbol */
+static int lineCount(BucketList symbol)
+{ LineList line;
+  int n = 0;
+  for (line = symbol->lines; line != NULL; line = line->next) n++;
+  return n;
+}
+
+void diagUseList(DiagList * list)
+{ current = list;
+}
+
+static int listLimit(DiagList * list)
+{ if (MaxErrors <= 0) return -1;
+  return list == &shared ? MaxErrors - flushed : MaxErrors;
+}
+
+static DiagRec * addRec(DiagList * list)
+{ if (list->count == list->size)
+  { list->size = list->size ? list->size * 2 : 64;
+    list->recs = (DiagRec *) realloc(list->recs, list->size * sizeof(DiagRec));
+  }
+  return &list->recs[list->count++];
+}
+
+int diagReport(DiagKind kind, int lineno, char * name)
+{ DiagList * list = current != NULL ? current : &shared;
+  int limit = listLimit(list);
+  DiagRec * rec;
+  if (limit >= 0 && list->count >= limit) return -1;
+  rec = addRec(list);
+  rec->kind = kind;
+  rec->lineno = lineno;
+  rec->name = name;
+  rec->symbol = NULL;
+  rec->extra = 0;
+  rec->seq = list->count - 1;
+  return list->count - 1;
+}
+
+int diagRedefined(BucketList symbol, int lineno)
+{ DiagList * list = current != NULL ? current : &shared;
+  int i = diagReport(Redefined, lineno, symbol->name);
+  if (i >= 0)
+  { list->recs[i].symbol = symbol;
+    list->recs[i].extra = lineCount(symbol);
+  }
+  return i;
+}
+
+int diagFull(void)
+{ DiagList * list = current != NULL ? current : &shared;
+  int limit = listLimit(list);
+  return limit >= 0 && list->count >= limit;
+}
+
+void diagAppend(DiagList * list)
+{ int limit = listLimit(&shared);
+  int i;
+  for (i = 0; i < list->count; i++)
+  { DiagRec * rec;
+    if (limit >= 0 && shared.count >= limit) break;
+    rec = addRec(&shared);
+    *rec = list->recs[i];
+    rec->seq = shared.count - 1;
+  }
+}
+
+void diagFree(DiagList * list)
+{ free(list->recs);
+  list->recs = NULL;
+  list->count = list->size = 0;
+}
+
+/* the rendered text of a flush */
+static char * text = NULL;
+static size_t textLen = 0;
+static size_t textSize = 0;
+
+static void put(const char * fmt, ...)
+{ va_list ap;
+  int n;
+  for (;;)
+  { va_start(ap, fmt);
+    n = vsnprintf(text + textLen, textSize - textLen, fmt, ap);
+    va_end(ap);
+    if (n >= 0 && textLen + n < textSize) break;
+    textSize = textSize ? textSize * 2 : 4096;
+    if (n >= 0 && textSize < textLen + n + 1) textSize = textLen + n + 1;
+    text = (char *) realloc(text, textSize);
+  }
+  textLen += n;
+}
+
+static void render(DiagRec * rec)
+{ LineList line;
+  int i;
+  switch (rec->kind)
+  { case UndeclaredFunction:
+      put("Error: undeclared function \"%s\" is called at line %d\n", rec->name, rec->lineno);
+      break;
+    case UndeclaredVariable:
+      put("Error: undeclared variable \"%s\" is used at line %d\n", rec->name, rec->lineno);
+      break;
+    case VoidVariable:
+      put("Error: The void-type variable is declared at line %d (name : \"%s\")\n", rec->lineno, rec->name);
+      break;
+    case IndexNotInteger:
+      put("Error: Invalid array indexing at line %d (name : \"%s\"). indicies should be integer\n", rec->lineno, rec->name);
+      break;
+    case IndexNotArray:
+      put("Error: Invalid array indexing at line %d (name : \"%s\"). indexing can only allowed for int[] variables\n", rec->lineno, rec->name);
+      break;
+    case InvalidCall:
+      put("Error: Invalid function call at line %d (name : \"%s\")\n", rec->lineno, rec->name);
+      break;
+    case InvalidReturn:
+      put("Error: Invalid return at line %d\n", rec->lineno);
+      break;
+    case InvalidAssignment:
+      put("Error: invalid assignment at line %d\n", rec->lineno);
+      break;
+    case InvalidOperation:
+      put("Error: invalid operation at line %d\n", rec->lineno);
+      break;
+    case InvalidCondition:
+      put("Error: invalid condition at line %d\n", rec->lineno);
+      break;
+    case Redefined:
+      put("Error: Symbol \"%s\" is redefined at line %d (already defined at line ", rec->name, rec->lineno);
+      // Program to sequentially print all the line numbers
+      for (line = rec->symbol->lines, i = 0; line != NULL && i < rec->extra; line = line->next, i++)
+        put(i == 0 ? "%d" : ", %d", line->lineno);
+      put(")\n");
+      break;
+    case NotFunction:
+      put("Error: \"%s\" is not a function, but called as one at line %d\n", rec->name, rec->lineno);
+      break;
+    case FunctionNotDefined:
+      put("Error: Function \"%s\" is not defined at line %d\n", rec->name, rec->lineno);
+      break;
+  }
+}
+
+/* Function compareNames orders the names of two
+ * records, NULL (no name) first
+ */
+static int compareNames(const char * x, const char * y)
+{ if (x == y) return 0;
+  if (x == NULL) return -1;
+  if (y == NULL) return 1;
+  return strcmp(x, y);
+}
+
+/* records are sorted by line, kind and name, so that
+ * duplicates are adjacent; then in recording order
+ */
+static int compareRecs(const void * a, const void * b)
+{ const DiagRec * x = (const DiagRec *) a;
+  const DiagRec * y = (const DiagRec *) b;
+  int c;
+  if (x->lineno != y->lineno) return x->lineno < y->lineno ? -1 : 1;
+  if (x->kind != y->kind) return x->kind < y->kind ? -1 : 1;
+  if ((c = compareNames(x->name, y->name)) != 0) return c;
+  return x->seq - y->seq;
+}
+
+void diagFlush(FILE * out)
+{ DiagRec * kept = NULL;
+  int i;
+  if (shared.count == 0) return;
+  qsort(shared.recs, shared.count, sizeof(DiagRec), compareRecs);
+  textLen = 0;
+  for (i = 0; i < shared.count; i++)
+    /* a duplicate follows the record it repeats */
+    if (kept == NULL || kept->lineno != shared.recs[i].lineno ||
+        kept->kind != shared.recs[i].kind ||
+        compareNames(kept->name, shared.recs[i].name) != 0)
+    { kept = &shared.recs[i];
+      render(kept);
+    }
+  fwrite(text, 1, textLen, out);
+  flushed += shared.count;
+  shared.count = 0;
+  Error = TRUE;
+}
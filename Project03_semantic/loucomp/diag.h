@@ -0,0 +1,78 @@
+/****************************************************/
+/* File: diag.h                                     */
+/* Diagnostics buffer for the C-Minus compiler      */
+/* Errors are recorded as compact records and       */
+/* rendered to text only when they are flushed      */
+/****************************************************/
+
+#ifndef _DIAG_H_
+#define _DIAG_H_
+
+#include "globals.h"
+#include "symtab.h"
+
+/* DiagKind is the kind of a recorded error; the
+ * message of each kind is in diag.c
+ */
+typedef enum
+   { UndeclaredFunction, UndeclaredVariable, VoidVariable,
+     IndexNotInteger, IndexNotArray, InvalidCall, InvalidReturn,
+     InvalidAssignment, InvalidOperation, InvalidCondition,
+     Redefined, NotFunction, FunctionNotDefined
+   } DiagKind;
+
+/* a recorded error */
+typedef struct
+   { DiagKind kind;
+     int lineno;
+     char * name; /* symbol name, NULL if none */
+     BucketList symbol; /* Redefined: the earlier definition */
+     int extra; /* Redefined: line numbers of symbol to print */
+     int seq; /* order of recording, for stable sorting */
+   } DiagRec;
+
+/* a list of recorded errors */
+typedef struct
+   { DiagRec * recs;
+     int count;
+     int size;
+   } DiagList;
+
+/* Procedure diagUseList makes the calling thread record
+ * its errors in list (NULL: the shared list)
+ */
+void diagUseList(DiagList * list);
+
+/* Function diagReport records an error of the given
+ * kind in the current list and returns its index there,
+ * or -1 if the list has reached MaxErrors
+ */
+int diagReport(DiagKind kind, int lineno, char * name);
+
+/* Function diagRedefined records the redefinition at
+ * lineno of symbol; the line numbers of symbol known at
+ * this point are printed with it
+ */
+int diagRedefined(BucketList symbol, int lineno);
+
+/* Function diagFull returns TRUE once the current list
+ * holds MaxErrors errors, so that analysis can stop
+ */
+int diagFull(void);
+
+/* Procedure diagAppend appends the errors of list to the
+ * shared list (up to MaxErrors in total)
+ */
+void diagAppend(DiagList * list);
+
+/* Procedure diagFlush renders the errors of the shared
+ * list to out, sorted by line number (then kind and
+ * name) and without duplicates, in a single write, and
+ * empties the list
+ */
+void diagFlush(FILE * out);
+
+/* Procedure diagFree releases the errors of list */
+void diagFree(DiagList * list);
+
+#endif
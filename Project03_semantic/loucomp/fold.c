@@ -0,0 +1,135 @@
+/****************************************************/
+/* File: fold.c                                     */
+/* Constant folding for the C-Minus compiler        */
+/****************************************************/
+
+#include <limits.h>
+#include "globals.h"
+#include "fold.h"
+
+/* Function sideEffects returns TRUE if evaluating
+ * expression t (not its siblings) may call a function,
+ * assign a variable or stop the program: a division
+ * by a divisor that is not a constant other than 0
+ * and -1, or an array element out of range
+ */
+static int sideEffects(TreeNode * t)
+{ int i;
+  if (t == NULL) return FALSE;
+  if (t->nodekind == ExpK &&
+      (t->kind.exp == CallK || t->kind.exp == AssignK))
+    return TRUE;
+  if (t->nodekind == ExpK && t->kind.exp == IdK && t->child[0] != NULL)
+    return TRUE;
+  if (t->nodekind == ExpK && t->kind.exp == OpK && t->attr.op == OVER &&
+      !(t->child[1]->nodekind == ExpK && t->child[1]->kind.exp == ConstK &&
+        t->child[1]->attr.val != 0 && t->child[1]->attr.val != -1))
+    return TRUE;
+  for (i = 0; i < MAXCHILDREN; i++)
+    if (sideEffects(t->child[i])) return TRUE;
+  return FALSE;
+}
+
+/* Function isConst returns TRUE if t is the
+ * constant value v
+ */
+static int isConst(TreeNode * t, int v)
+{ return t->nodekind == ExpK && t->kind.exp == ConstK && t->attr.val == v;
+}
+
+/* Function evalOp computes a op b into *result with
+ * the wrap-around of the target machine; a comparison
+ * tests the wrapped difference a - b, as the code of
+ * every target does. It returns FALSE if the operation
+ * is left for run time (division by zero or overflow)
+ */
+static int evalOp(TokenType op, int a, int b, int * result)
+{ int d;
+  switch (op)
+  { case PLUS: *result = (int) ((unsigned) a + (unsigned) b); break;
+    case MINUS: *result = (int) ((unsigned) a - (unsigned) b); break;
+    case TIMES: *result = (int) ((unsigned) a * (unsigned) b); break;
+    case OVER:
+      if (b == 0 || (a == INT_MIN && b == -1)) return FALSE;
+      *result = a / b;
+      break;
+    case LT: case LE: case GT: case GE: case EQ: case NE:
+      d = (int) ((unsigned) a - (unsigned) b);
+      switch (op)
+      { case LT: *result = d < 0; break;
+        case LE: *result = d <= 0; break;
+        case GT: *result = d > 0; break;
+        case GE: *result = d >= 0; break;
+        case EQ: *result = d == 0; break;
+        default: *result = d != 0; break;
+      }
+      break;
+    default: return FALSE;
+  }
+  return TRUE;
+}
+
+/* Procedure makeConst turns OpK node t into the
+ * constant v
+ */
+static void makeConst(TreeNode * t, int v)
+{ int i;
+  for (i = 0; i < MAXCHILDREN; i++) t->child[i] = NULL;
+  t->kind.exp = ConstK;
+  t->attr.val = v;
+  t->type = Integer;
+}
+
+/* Function foldExp folds the children of t and then
+ * t itself; it returns the node that takes the place
+ * of t in the tree (t or one of its operands)
+ */
+static TreeNode * foldExp(TreeNode * t)
+{ TreeNode * l, * r;
+  int i, v;
+  for (i = 0; i < MAXCHILDREN; i++)
+  { TreeNode ** p = &t->child[i];
+    while (*p != NULL)
+    { TreeNode * next = (*p)->sibling;
+      *p = foldExp(*p);
+      (*p)->sibling = next;
+      p = &(*p)->sibling;
+    }
+  }
+  if (t->nodekind != ExpK || t->kind.exp != OpK) return t;
+  l = t->child[0];
+  r = t->child[1];
+  if (l->kind.exp == ConstK && r->kind.exp == ConstK)
+  { if (evalOp(t->attr.op, l->attr.val, r->attr.val, &v))
+      makeConst(t, v);
+    return t;
+  }
+  switch (t->attr.op)
+  { case PLUS:
+      if (isConst(r, 0)) return l;
+      if (isConst(l, 0)) return r;
+      break;
+    case MINUS:
+      if (isConst(r, 0)) return l;
+      break;
+    case TIMES:
+      if (isConst(r, 1)) return l;
+      if (isConst(l, 1)) return r;
+      if ((isConst(r, 0) && !sideEffects(l)) ||
+          (isConst(l, 0) && !sideEffects(r)))
+        makeConst(t, 0);
+      break;
+    case OVER:
+      if (isConst(r, 1)) return l;
+      break;
+    default:
+      break;
+  }
+  return t;
+}
+
+void foldConstants(TreeNode * syntaxTree)
+{ TreeNode * t;
+  for (t = syntaxTree; t != NULL; t = t->sibling)
+    foldExp(t);
+}
@@ -0,0 +1,17 @@
+/****************************************************/
+/* File: fold.h                                     */
+/* Constant folding for the C-Minus compiler        */
+/****************************************************/
+
+#ifndef _FOLD_H_
+#define _FOLD_H_
+
+/* Procedure foldConstants rewrites the type checked
+ * syntax tree in place: operations on constants are
+ * replaced by their value, and the identities x+0,
+ * x-0, x*1, x/1 and x*0 (when x has no side effects)
+ * are simplified
+ */
+void foldConstants(TreeNode *);
+
+#endif
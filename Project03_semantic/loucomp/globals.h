@@ -89,6 +89,7 @@ typedef struct treeNode {
     char * name; //identifier name
     } attr;
   ExpType type; /* for type checking of exps */
+  struct BucketListRec * symbol; /* symbol declared or resolved by the node */
 }TreeNode;
 
 /**************************************************/
@@ -118,11 +119,61 @@ extern int TraceParse;
  */
 extern int TraceAnalyze;
 
+/* AnalyzeThreads > 1 makes the semantic analyzer
+ * check function bodies on that many worker threads
+ * after the global declarations have been entered
+ */
+extern int AnalyzeThreads;
+
+/* MaxErrors > 0 stops the semantic analyzer after
+ * that many errors have been reported
+ */
+extern int MaxErrors;
+
 /* TraceCode = TRUE causes comments to be written
  * to the TM code file as code is generated
  */
 extern int TraceCode;
 
+/* PeepholeWindow is the number of instructions the
+ * peephole optimizer looks at (< 2: no optimization)
+ */
+extern int PeepholeWindow;
+
+/* PeepholeStats = TRUE causes the peephole optimizer
+ * to report how often each rule applied
+ */
+extern int PeepholeStats;
+
+/* UseIR = TRUE makes the code generator translate
+ * the syntax tree to the three-address IR and lower
+ * that to TM code
+ */
+extern int UseIR;
+
+/* TraceIR = TRUE causes the IR to be printed to the
+ * listing file
+ */
+extern int TraceIR;
+
+/* VarRegisters is the number of registers (0 to 3)
+ * the IR code generator may keep scalar variables in
+ */
+extern int VarRegisters;
+
+/* BinaryCode = TRUE makes the TM code generators
+ * write a TM object file (.tmo, -b) in place of
+ * TM text code
+ */
+extern int BinaryCode;
+
+/* Target selects the code the compiler generates:
+ * TM code (.tm), x86-64 assembly (.s, -S) to be
+ * linked with the runtime cmrt.c, or C (.c, -C)
+ */
+typedef enum {TmTarget, X86Target, CTarget} TargetKind;
+extern TargetKind Target;
+
 /* Error = TRUE prevents further passes if an error occurs */
 extern int Error; 
 #endif
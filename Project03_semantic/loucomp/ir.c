@@ -0,0 +1,609 @@
+/****************************************************/
+/* File: ir.c                                       */
+/* Three-address intermediate representation        */
+/* for the C-Minus compiler                         */
+/****************************************************/
+
+#include "globals.h"
+#include "symtab.h"
+#include "ir.h"
+
+/* the function under construction */
+static IrFunction * fn;
+
+/* the block receiving new instructions */
+static int cur;
+
+/* number of while loops around the current statement */
+static int loopDepth;
+
+/* source line of the current statement */
+static int curLine;
+
+/* Function irIsTerminator returns TRUE for the
+ * operations that end a block
+ */
+int irIsTerminator(IrOp op)
+{ return op == IrJump || op == IrBranch || op == IrReturn; }
+
+/* Function irSuccessors stores the successors of
+ * block b in succ (the fall-through preference last)
+ * and returns their number
+ */
+int irSuccessors(IrBlock * b, int succ[2])
+{ IrInstr * in;
+  if (b->count == 0) return 0;
+  in = &b->code[b->count-1];
+  switch (in->op)
+  { case IrJump :
+      succ[0] = in->target;
+      return 1;
+    case IrBranch :
+      succ[0] = in->other;
+      succ[1] = in->target;
+      return 2;
+    default :
+      return 0;
+  }
+}
+
+/* Function newBlock adds an empty block to the
+ * current function and returns its number
+ */
+static int newBlock(void)
+{ IrBlock * b;
+  if (fn->blockCount == fn->blockSize)
+  { fn->blockSize = fn->blockSize ? fn->blockSize * 2 : 16;
+    fn->blocks = (IrBlock *) realloc(fn->blocks, fn->blockSize * sizeof(IrBlock));
+  }
+  b = &fn->blocks[fn->blockCount];
+  b->code = NULL;
+  b->count = b->size = 0;
+  b->loopDepth = loopDepth;
+  return fn->blockCount++;
+}
+
+/* Function terminated returns TRUE if the current
+ * block already ends with a jump or return
+ */
+static int terminated(void)
+{ IrBlock * b = &fn->blocks[cur];
+  return b->count > 0 && irIsTerminator(b->code[b->count-1].op);
+}
+
+/* Function emit appends an instruction to the
+ * current block and returns it for the remaining
+ * fields. Code after a return goes to a new block
+ * that is dropped later
+ */
+static IrInstr * emit(IrOp op, int dst, int a, int b)
+{ IrBlock * bl;
+  IrInstr * in;
+  if (terminated()) cur = newBlock();
+  bl = &fn->blocks[cur];
+  if (bl->count == bl->size)
+  { bl->size = bl->size ? bl->size * 2 : 8;
+    bl->code = (IrInstr *) realloc(bl->code, bl->size * sizeof(IrInstr));
+  }
+  in = &bl->code[bl->count++];
+  in->op = op;
+  in->dst = dst;
+  in->a = a;
+  in->b = b;
+  in->k = 0;
+  in->sym = NULL;
+  in->target = in->other = -1;
+  in->lineno = curLine;
+  return in;
+}
+
+static int newVreg(void)
+{ return fn->vregs++; }
+
+/* Procedure jump ends the current block with a jump
+ * to block b, unless it is already terminated
+ */
+static void jump(int b)
+{ if (!terminated()) emit(IrJump,-1,-1,-1)->target = b; }
+
+/* Function relOp returns the IR operation of a
+ * relational operator token, -1 for other tokens
+ */
+static int relOp(TokenType op)
+{ switch (op)
+  { case LT : return IrLt;
+    case LE : return IrLe;
+    case GT : return IrGt;
+    case GE : return IrGe;
+    case EQ : return IrEq;
+    case NE : return IrNe;
+    default : return -1;
+  }
+}
+
+static int genExp(TreeNode * t);
+
+/* Function genElement generates the address of the
+ * element var[index] as a vreg plus the offset *k
+ */
+static int genElement(TreeNode * var, int * k)
+{ BucketList s = var->symbol;
+  TreeNode * index = var->child[0];
+  int base = newVreg(), i, p;
+  emit(s->isParam ? IrGetVar : IrAddr,base,-1,-1)->sym = s;
+  if (index->nodekind == ExpK && index->kind.exp == ConstK)
+  { *k = index->attr.val;
+    return base;
+  }
+  i = genExp(index);
+  p = newVreg();
+  emit(IrAdd,p,base,i);
+  *k = 0;
+  return p;
+}
+
+/* Function genCall generates a call and returns
+ * the vreg of its value (-1 for a void function)
+ */
+static int genCall(TreeNode * t)
+{ TreeNode * arg;
+  IrInstr * in;
+  int args[256], * v = args, n, i, dst;
+  if (strcmp(t->attr.name,"input") == 0)
+  { dst = newVreg();
+    emit(IrInput,dst,-1,-1);
+    return dst;
+  }
+  if (strcmp(t->attr.name,"output") == 0)
+  { emit(IrOutput,-1,genExp(t->child[0]),-1);
+    return -1;
+  }
+  for (n = 0, arg = t->child[0]; arg != NULL; arg = arg->sibling) n++;
+  if (n > 256) v = (int *) malloc(n * sizeof(int));
+  /* all arguments are evaluated before the first is passed */
+  for (i = 0, arg = t->child[0]; arg != NULL; arg = arg->sibling, i++)
+    v[i] = genExp(arg);
+  for (i = 0; i < n; i++) emit(IrArg,-1,v[i],-1)->k = i;
+  if (v != args) free(v);
+  dst = t->symbol->type == Void ? -1 : newVreg();
+  in = emit(IrCall,dst,-1,-1);
+  in->k = n;
+  in->sym = t->symbol;
+  return dst;
+}
+
+/* Function genExp generates code for expression t
+ * and returns the vreg holding its value
+ */
+static int genExp(TreeNode * t)
+{ BucketList s = t->symbol;
+  int a, b, k, v;
+  switch (t->kind.exp)
+  { case ConstK :
+      v = newVreg();
+      emit(IrConst,v,-1,-1)->k = t->attr.val;
+      return v;
+    case IdK :
+      v = newVreg();
+      if (t->child[0] != NULL)
+      { a = genElement(t,&k);
+        emit(IrLoad,v,a,-1)->k = k;
+      }
+      else if (s->type == IntegerArray && !s->isParam)
+        emit(IrAddr,v,-1,-1)->sym = s;
+      else
+        emit(IrGetVar,v,-1,-1)->sym = s;
+      return v;
+    case AssignK :
+      if (t->child[0]->child[0] == NULL)
+      { v = genExp(t->child[1]);
+        emit(IrSetVar,-1,v,-1)->sym = t->child[0]->symbol;
+      }
+      else
+      { /* the index is evaluated before the right side */
+        a = genElement(t->child[0],&k);
+        v = genExp(t->child[1]);
+        emit(IrStore,-1,a,v)->k = k;
+      }
+      return v;
+    case OpK :
+      a = genExp(t->child[0]);
+      b = genExp(t->child[1]);
+      v = newVreg();
+      switch (t->attr.op)
+      { case PLUS : emit(IrAdd,v,a,b); break;
+        case MINUS : emit(IrSub,v,a,b); break;
+        case TIMES : emit(IrMul,v,a,b); break;
+        case OVER : emit(IrDiv,v,a,b); break;
+        default : emit((IrOp) relOp(t->attr.op),v,a,b); break;
+      }
+      return v;
+    case CallK :
+      return genCall(t);
+    default :
+      return -1;
+  }
+}
+
+/* Procedure genCond ends the current block with a
+ * branch to block yes if test t holds, else to no
+ */
+static void genCond(TreeNode * t, int yes, int no)
+{ IrInstr * in;
+  int a, b, rel = -1;
+  if (t->nodekind == ExpK && t->kind.exp == OpK) rel = relOp(t->attr.op);
+  if (rel >= 0)
+  { a = genExp(t->child[0]);
+    b = genExp(t->child[1]);
+    in = emit(IrBranch,-1,a,b);
+    in->k = rel;
+  }
+  else
+  { in = emit(IrBranch,-1,genExp(t),-1);
+    in->k = IrNe;
+  }
+  in->target = yes;
+  in->other = no;
+}
+
+/* Procedure genStmt generates code for statement
+ * list t (siblings included)
+ */
+static void genStmt(TreeNode * t)
+{ int thenB, elseB, test, body, join;
+  for (; t != NULL; t = t->sibling)
+  { curLine = t->lineno;
+    if (t->nodekind == ExpK)
+    { genExp(t);
+      continue;
+    }
+    if (t->nodekind != StmtK) continue;
+    switch (t->kind.stmt)
+    { case CompK :
+        genStmt(t->child[1]);
+        break;
+      case IfK :
+        thenB = newBlock();
+        elseB = t->child[2] != NULL ? newBlock() : -1;
+        join = newBlock();
+        genCond(t->child[0],thenB,elseB >= 0 ? elseB : join);
+        cur = thenB;
+        genStmt(t->child[1]);
+        jump(join);
+        if (elseB >= 0)
+        { cur = elseB;
+          genStmt(t->child[2]);
+          jump(join);
+        }
+        cur = join;
+        break;
+      case WhileK :
+        loopDepth++;
+        test = newBlock();
+        body = newBlock();
+        loopDepth--;
+        join = newBlock();
+        jump(test);
+        cur = test;
+        genCond(t->child[0],body,join);
+        loopDepth++;
+        cur = body;
+        genStmt(t->child[1]);
+        curLine = t->lineno;
+        jump(test);
+        loopDepth--;
+        cur = join;
+        break;
+      case ReturnK :
+        emit(IrReturn,-1,t->child[0] != NULL ? genExp(t->child[0]) : -1,-1);
+        break;
+      default :
+        break;
+    }
+  }
+}
+
+/* Function scopeSize returns the number of locations
+ * used by the declarations in tree (siblings included)
+ */
+static int scopeSize(TreeNode * tree)
+{ int size = 0, n, i;
+  for (; tree != NULL; tree = tree->sibling)
+  { if (tree->nodekind == DeclK && tree->symbol != NULL)
+    { n = tree->symbol->memloc + tree->symbol->size;
+      if (n > size) size = n;
+    }
+    for (i = 0; i < MAXCHILDREN; i++)
+    { n = scopeSize(tree->child[i]);
+      if (n > size) size = n;
+    }
+  }
+  return size;
+}
+
+/* Procedure orderBlocks renumbers the blocks of the
+ * current function in reverse postorder, so that a
+ * then part follows its test and a loop body its
+ * header, and drops the unreachable blocks
+ */
+static void orderBlocks(void)
+{ int n = fn->blockCount, * num, * stack, * next, sp = 0, count = 0;
+  int succ[2], ns, b, i, j;
+  IrBlock * blocks;
+  num = (int *) malloc(n * sizeof(int));
+  stack = (int *) malloc(n * sizeof(int));
+  next = (int *) calloc(n, sizeof(int));
+  for (b = 0; b < n; b++) num[b] = -1;
+  /* num[] first holds the postorder number */
+  num[0] = -2;
+  stack[sp++] = 0;
+  while (sp > 0)
+  { b = stack[sp-1];
+    ns = irSuccessors(&fn->blocks[b],succ);
+    if (next[b] < ns)
+    { i = succ[next[b]++];
+      if (num[i] == -1)
+      { num[i] = -2;
+        stack[sp++] = i;
+      }
+    }
+    else
+    { num[b] = count++;
+      sp--;
+    }
+  }
+  blocks = (IrBlock *) malloc((count > 0 ? count : 1) * sizeof(IrBlock));
+  for (b = 0; b < n; b++)
+  { if (num[b] < 0) { free(fn->blocks[b].code); continue; }
+    num[b] = count - 1 - num[b];
+    blocks[num[b]] = fn->blocks[b];
+  }
+  for (b = 0; b < count; b++)
+    for (j = 0; j < blocks[b].count; j++)
+    { IrInstr * in = &blocks[b].code[j];
+      if (in->target >= 0) in->target = num[in->target];
+      if (in->other >= 0) in->other = num[in->other];
+    }
+  free(fn->blocks);
+  fn->blocks = blocks;
+  fn->blockCount = fn->blockSize = count;
+  free(num);
+  free(stack);
+  free(next);
+}
+
+/* Procedure genFunc builds the IR of function t */
+static void genFunc(TreeNode * t)
+{ int n;
+  fn->tree = t;
+  fn->sym = t->symbol;
+  fn->frameSize = scopeSize(t->child[0]);
+  n = scopeSize(t->child[1]);
+  if (n > fn->frameSize) fn->frameSize = n;
+  fn->vregs = 0;
+  fn->blocks = NULL;
+  fn->blockCount = fn->blockSize = 0;
+  loopDepth = 0;
+  curLine = t->lineno;
+  cur = newBlock();
+  genStmt(t->child[1]);
+  curLine = t->lineno;
+  if (!terminated()) emit(IrReturn,-1,-1,-1);
+  orderBlocks();
+}
+
+/* Function irBuild translates the analysed syntax
+ * tree into IR
+ */
+IrProgram * irBuild(TreeNode * syntaxTree)
+{ IrProgram * p = (IrProgram *) malloc(sizeof(IrProgram));
+  TreeNode * t;
+  int n = 0;
+  for (t = syntaxTree; t != NULL; t = t->sibling)
+    if (t->nodekind == DeclK && t->kind.decl == FunK) n++;
+  p->funcs = (IrFunction *) calloc(n > 0 ? n : 1, sizeof(IrFunction));
+  p->count = 0;
+  for (t = syntaxTree; t != NULL; t = t->sibling)
+    if (t->nodekind == DeclK && t->kind.decl == FunK)
+    { fn = &p->funcs[p->count++];
+      genFunc(t);
+    }
+  return p;
+}
+
+/* Procedure irFree releases program p */
+void irFree(IrProgram * p)
+{ int i, b;
+  for (i = 0; i < p->count; i++)
+  { for (b = 0; b < p->funcs[i].blockCount; b++)
+      free(p->funcs[i].blocks[b].code);
+    free(p->funcs[i].blocks);
+  }
+  free(p->funcs);
+  free(p);
+}
+
+/* printable names of the operations */
+static char * opName[] =
+   { "const", "copy", "+", "-", "*", "/",
+     "<", "<=", ">", ">=", "==", "!=",
+     "get", "set", "addr", "load", "store", "input", "output",
+     "arg", "call", "goto", "if", "return" };
+
+/* Procedure printInstr prints instruction in to f */
+static void printInstr(FILE * f, IrInstr * in)
+{ fprintf(f,"  ");
+  switch (in->op)
+  { case IrConst : fprintf(f,"v%d = %d",in->dst,in->k); break;
+    case IrCopy : fprintf(f,"v%d = v%d",in->dst,in->a); break;
+    case IrAdd : case IrSub : case IrMul : case IrDiv :
+    case IrLt : case IrLe : case IrGt : case IrGe : case IrEq : case IrNe :
+      fprintf(f,"v%d = v%d %s v%d",in->dst,in->a,opName[in->op],in->b);
+      break;
+    case IrGetVar : fprintf(f,"v%d = %s",in->dst,in->sym->name); break;
+    case IrSetVar : fprintf(f,"%s = v%d",in->sym->name,in->a); break;
+    case IrAddr : fprintf(f,"v%d = &%s",in->dst,in->sym->name); break;
+    case IrLoad : fprintf(f,"v%d = [v%d%+d]",in->dst,in->a,in->k); break;
+    case IrStore : fprintf(f,"[v%d%+d] = v%d",in->a,in->k,in->b); break;
+    case IrInput : fprintf(f,"v%d = input",in->dst); break;
+    case IrOutput : fprintf(f,"output v%d",in->a); break;
+    case IrArg : fprintf(f,"arg %d = v%d",in->k,in->a); break;
+    case IrCall :
+      if (in->dst >= 0) fprintf(f,"v%d = ",in->dst);
+      fprintf(f,"call %s/%d",in->sym->name,in->k);
+      break;
+    case IrJump : fprintf(f,"goto B%d",in->target); break;
+    case IrBranch :
+      if (in->b >= 0)
+        fprintf(f,"if v%d %s v%d",in->a,opName[in->k],in->b);
+      else
+        fprintf(f,"if v%d %s 0",in->a,opName[in->k]);
+      fprintf(f," goto B%d else B%d",in->target,in->other);
+      break;
+    case IrReturn :
+      if (in->a >= 0) fprintf(f,"return v%d",in->a);
+      else fprintf(f,"return");
+      break;
+  }
+  fprintf(f,"\n");
+}
+
+/* Procedure irPrint prints program p to file f */
+void irPrint(FILE * f, IrProgram * p)
+{ int i, b, j;
+  for (i = 0; i < p->count; i++)
+  { IrFunction * fn = &p->funcs[i];
+    fprintf(f,"\nfunction %s: frame %d, %d vregs\n",
+            fn->sym->name,fn->frameSize,fn->vregs);
+    for (b = 0; b < fn->blockCount; b++)
+    { if (fn->blocks[b].loopDepth > 0)
+        fprintf(f,"B%d: (loop depth %d)\n",b,fn->blocks[b].loopDepth);
+      else
+        fprintf(f,"B%d:\n",b);
+      for (j = 0; j < fn->blocks[b].count; j++)
+        printInstr(f,&fn->blocks[b].code[j]);
+    }
+  }
+}
+
+/* state of the verifier */
+static int violations;
+static IrFunction * vfn;
+static int vblock;
+
+static void violation(char * message, int n)
+{ fprintf(listing,"IR error in %s, block B%d: ",vfn->sym->name,vblock);
+  fprintf(listing,message,n);
+  fprintf(listing,"\n");
+  violations++;
+}
+
+/* Procedure checkUse checks vreg operand v, which is
+ * required if needed is TRUE; defined[] holds the
+ * block (+1) in which each vreg was defined so far
+ */
+static void checkUse(int v, int needed, int * defined)
+{ if (v < 0)
+  { if (needed) violation("missing operand",0);
+  }
+  else if (!needed) violation("unexpected operand v%d",v);
+  else if (v >= vfn->vregs) violation("vreg v%d out of range",v);
+  else if (defined[v] != vblock + 1) violation("v%d used before its definition",v);
+}
+
+/* Function irVerify checks the structural rules of
+ * the IR and returns the number of violations
+ */
+int irVerify(IrProgram * p)
+{ int i, j, * defined, args;
+  IrInstr * in;
+  violations = 0;
+  for (i = 0; i < p->count; i++)
+  { vfn = &p->funcs[i];
+    vblock = 0;
+    if (vfn->blockCount == 0) violation("function has no blocks",0);
+    defined = (int *) calloc(vfn->vregs + 1, sizeof(int));
+    for (vblock = 0; vblock < vfn->blockCount; vblock++)
+    { IrBlock * b = &vfn->blocks[vblock];
+      args = 0;
+      if (b->count == 0) violation("empty block",0);
+      for (j = 0; j < b->count; j++)
+      { in = &b->code[j];
+        if (in->op < IrConst || in->op > IrReturn)
+        { violation("bad operation %d",in->op);
+          continue;
+        }
+        if (irIsTerminator(in->op) != (j == b->count - 1))
+          violation(j == b->count - 1 ? "block does not end with a jump or return"
+                                      : "jump or return in the middle of the block",0);
+        switch (in->op)
+        { case IrCopy : case IrSetVar : case IrLoad : case IrOutput :
+          case IrArg :
+            checkUse(in->a,TRUE,defined);
+            checkUse(in->b,FALSE,defined);
+            break;
+          case IrAdd : case IrSub : case IrMul : case IrDiv :
+          case IrLt : case IrLe : case IrGt : case IrGe : case IrEq : case IrNe :
+          case IrStore :
+            checkUse(in->a,TRUE,defined);
+            checkUse(in->b,TRUE,defined);
+            break;
+          case IrBranch :
+            checkUse(in->a,TRUE,defined);
+            if (in->b >= 0) checkUse(in->b,TRUE,defined);
+            if (in->k < IrLt || in->k > IrNe) violation("bad relation %d",in->k);
+            break;
+          case IrReturn :
+            if (in->a >= 0) checkUse(in->a,TRUE,defined);
+            checkUse(in->b,FALSE,defined);
+            break;
+          default :
+            checkUse(in->a,FALSE,defined);
+            checkUse(in->b,FALSE,defined);
+            break;
+        }
+        if ((in->op == IrGetVar || in->op == IrSetVar || in->op == IrAddr ||
+             in->op == IrCall) && in->sym == NULL)
+          violation("missing variable",0);
+        if (in->op == IrJump || in->op == IrBranch)
+        { if (in->target < 0 || in->target >= vfn->blockCount)
+            violation("jump to missing block B%d",in->target);
+          if (in->op == IrBranch &&
+              (in->other < 0 || in->other >= vfn->blockCount))
+            violation("jump to missing block B%d",in->other);
+        }
+        /* the Args of a call are numbered from 0 and end at the Call */
+        if (in->op == IrArg)
+        { if (in->k != args) violation("argument %d out of order",in->k);
+          args++;
+        }
+        else if (in->op == IrCall)
+        { if (in->k != args) violation("call passes %d arguments",args);
+          args = 0;
+        }
+        else if (args > 0)
+        { violation("arguments not followed by a call",0);
+          args = 0;
+        }
+        if (in->op == IrConst || in->op == IrCopy || in->op == IrGetVar ||
+            in->op == IrAddr || in->op == IrLoad || in->op == IrInput ||
+            (in->op >= IrAdd && in->op <= IrNe))
+        { if (in->dst < 0 || in->dst >= vfn->vregs)
+            violation("bad destination v%d",in->dst);
+          else if (defined[in->dst]) violation("v%d defined twice",in->dst);
+          else defined[in->dst] = vblock + 1;
+        }
+        else if (in->op == IrCall)
+        { if (in->dst >= vfn->vregs) violation("bad destination v%d",in->dst);
+          else if (in->dst >= 0)
+          { if (defined[in->dst]) violation("v%d defined twice",in->dst);
+            else defined[in->dst] = vblock + 1;
+          }
+        }
+        else if (in->dst >= 0) violation("unexpected destination v%d",in->dst);
+      }
+    }
+    free(defined);
+  }
+  return violations;
+}
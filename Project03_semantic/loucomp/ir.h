@@ -0,0 +1,106 @@
+/****************************************************/
+/* File: ir.h                                       */
+/* Three-address intermediate representation        */
+/* for the C-Minus compiler                         */
+/****************************************************/
+
+#ifndef _IR_H_
+#define _IR_H_
+
+#include "symtab.h"
+
+/* IR operations. Operands are virtual registers
+ * (vregs); variables are only accessed by GetVar,
+ * SetVar and Addr and through addresses
+ */
+typedef enum
+   { IrConst,   /* dst = k                               */
+     IrCopy,    /* dst = a                               */
+     IrAdd, IrSub, IrMul, IrDiv,  /* dst = a op b       */
+     IrLt, IrLe, IrGt, IrGe, IrEq, IrNe, /* dst = a rel b (0/1) */
+     IrGetVar,  /* dst = scalar variable sym             */
+     IrSetVar,  /* sym = a                               */
+     IrAddr,    /* dst = address of array sym            */
+     IrLoad,    /* dst = memory[a + k]                   */
+     IrStore,   /* memory[a + k] = b                     */
+     IrInput,   /* dst = input()                         */
+     IrOutput,  /* output(a)                             */
+     IrArg,     /* argument k of the next call is a      */
+     IrCall,    /* dst = sym(k arguments), dst -1: void  */
+     IrJump,    /* goto block target                     */
+     IrBranch,  /* if a rel b goto target else other;
+                   rel = k (IrLt..IrNe), b -1: compare
+                   with 0                                */
+     IrReturn   /* return a (-1: no value)               */
+   } IrOp;
+
+/* an IR instruction; unused vreg operands are -1 */
+typedef struct
+   { IrOp op;
+     int dst, a, b;
+     int k;
+     BucketList sym;
+     int target, other; /* block numbers */
+     int lineno; /* source line, 0 if none */
+   } IrInstr;
+
+/* A basic block: straight-line code ended by a
+ * Jump, Branch or Return
+ */
+typedef struct
+   { IrInstr * code;
+     int count, size;
+     int loopDepth; /* number of while loops around it */
+   } IrBlock;
+
+/* A function: block 0 is the entry. Every vreg is
+ * defined once and used only after its definition
+ * in the same block; values live across blocks are
+ * kept in variables. The Args of a call come right
+ * before the Call
+ */
+typedef struct
+   { TreeNode * tree; /* the FunK declaration */
+     BucketList sym;
+     int frameSize; /* locations of parameters and locals */
+     int vregs; /* number of vregs */
+     IrBlock * blocks;
+     int blockCount, blockSize;
+   } IrFunction;
+
+typedef struct
+   { IrFunction * funcs;
+     int count;
+   } IrProgram;
+
+/* Function irBuild translates the analysed syntax
+ * tree into IR, one IrFunction per function in
+ * source order. Blocks not reachable from the entry
+ * are dropped
+ */
+IrProgram * irBuild(TreeNode * syntaxTree);
+
+/* Procedure irPrint prints program p to file f */
+void irPrint(FILE * f, IrProgram * p);
+
+/* Function irVerify checks the structural rules of
+ * the IR, reporting each violation to the listing.
+ * It returns the number of violations
+ */
+int irVerify(IrProgram * p);
+
+/* Procedure irFree releases program p */
+void irFree(IrProgram * p);
+
+/* Function irIsTerminator returns TRUE for the
+ * operations that end a block
+ */
+int irIsTerminator(IrOp op);
+
+/* Function irSuccessors stores the successors of
+ * block b in succ and returns their number (0 to 2).
+ * For a branch the target is stored last
+ */
+int irSuccessors(IrBlock * b, int succ[2]);
+
+#endif
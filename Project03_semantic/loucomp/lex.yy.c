@@ -0,0 +1,45 @@
+/* test-only stand-in for flex output of cminus.l */
+#include "globals.h"
+#include "util.h"
+#include "scan.h"
+char tokenString[MAXTOKENLEN+1];
+static int rd(void){ return fgetc(source); }
+static int peekc(void){ int c=fgetc(source); if(c!=EOF) ungetc(c,source); return c; }
+static TokenType lex(void){
+  int c;
+  for(;;){
+    c=rd(); tokenString[0]=0;
+    if(c==EOF) return ENDFILE;
+    if(c=='\n'){lineno++;continue;}
+    if(c==' '||c=='\t'||c=='\r') continue;
+    if(c=='/'&&peekc()=='*'){ rd(); for(;;){ c=rd(); if(c==EOF) return ENDFILE; if(c=='\n')lineno++; if(c=='*'){ while((c=peekc())=='*') rd(); if(c=='/'){rd();break;} } } continue; }
+    break;
+  }
+  int n=0; tokenString[n++]=c;
+  if(isdigit(c)){ while(isdigit(peekc())) { c=rd(); if(n<MAXTOKENLEN) tokenString[n++]=c;} tokenString[n]=0; return NUM; }
+  if(isalpha(c)){ while(isalnum(peekc())) { c=rd(); if(n<MAXTOKENLEN) tokenString[n++]=c;} tokenString[n]=0;
+    if(!strcmp(tokenString,"if"))return IF; if(!strcmp(tokenString,"else"))return ELSE;
+    if(!strcmp(tokenString,"int"))return INT; if(!strcmp(tokenString,"void"))return VOID;
+    if(!strcmp(tokenString,"while"))return WHILE; if(!strcmp(tokenString,"return"))return RETURN;
+    return ID; }
+  tokenString[1]=0;
+  switch(c){
+    case '=': if(peekc()=='='){rd();strcpy(tokenString,"==");return EQ;} return ASSIGN;
+    case '<': if(peekc()=='='){rd();strcpy(tokenString,"<=");return LE;} return LT;
+    case '>': if(peekc()=='='){rd();strcpy(tokenString,">=");return GE;} return GT;
+    case '!': if(peekc()=='='){rd();strcpy(tokenString,"!=");return NE;} return ERROR;
+    case '+': return PLUS; case '-': return MINUS; case '*': return TIMES; case '/': return OVER;
+    case '(': return LPAREN; case ')': return RPAREN; case ';': return SEMI; case ',': return COMMA;
+    case '{': return LCURLY; case '}': return RCURLY; case '[': return LBRACE; case ']': return RBRACE;
+  }
+  return ERROR;
+}
+static int firstTime = TRUE;
+void restartScanner(void){ firstTime = TRUE; lineno = 0; }
+TokenType getToken(void)
+{ TokenType t;
+  if (firstTime) { firstTime = FALSE; lineno++; }
+  t = lex();
+  if (TraceScan) { fprintf(listing,"\t%d: ",lineno); printToken(t,tokenString); }
+  return t;
+}
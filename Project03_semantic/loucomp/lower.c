@@ -0,0 +1,582 @@
+/****************************************************/
+/* File: lower.c                                    */
+/* Lowering of the IR to TM code                    */
+/* for the C-Minus compiler                         */
+/****************************************************/
+
+#include "globals.h"
+#include "symtab.h"
+#include "code.h"
+#include "ir.h"
+#include "cfg.h"
+#include "regalloc.h"
+#include "lower.h"
+#include "peephole.h"
+
+/* The activation record is the one of cgen.c:
+ *    0(fp)         control link (fp of the caller)
+ *   -1(fp)         return address
+ *   -2-s(fp)       location s of the function scopes
+ *   -2-F-t(fp)     spill slot t, where F = frameSize
+ * The record of a callee starts below the spill
+ * slots, whose number is known when the function is
+ * done; the offsets that depend on it are patched then
+ */
+#define FRAME_HEADER 2
+
+/* vregs are kept in the registers of regs[] that
+ * do not hold a variable; the first VarRegisters
+ * registers of varRegs[] may hold variables
+ * (allocateVars). A register holding a variable is
+ * saved to the variable around the calls within its
+ * live interval and loaded again after them
+ */
+#define NREGS 5
+static int regs[NREGS] = { ac, ac1, 2, 3, mp };
+static int varRegs[] = { 2, 3, mp };
+
+/* the registers of regs[] free for vregs */
+static int pool[NREGS];
+static int npool;
+
+/* the registers of the variables of the function */
+static Cfg * graph;
+static Allocation * alloc;
+static int isVarReg[8];
+
+/* number of the first instruction of the block */
+static int firstPos;
+
+/* vregs that share the register of a variable they
+ * were read from, by register; the list may hold
+ * vregs that no longer do
+ */
+static int * alias[8];
+static int aliasCount[8], aliasSize[8];
+
+/* the function being lowered */
+static IrFunction * fn;
+
+/* where the value of each vreg is: the value is
+ * reg[v] + off[v] (reg[v] -1: not in a register),
+ * or base[v] + off[v] for an array address not yet
+ * computed (base[v] is fp or gp, otherwise -1).
+ * slot[v] >= 0 is the spill slot holding reg[v]
+ */
+static int * reg, * off, * base, * slot;
+
+/* last use of each vreg (index in its block) */
+static int * lastUse;
+
+/* vreg held by each TM register, -1 if none */
+static int owner[8];
+
+/* spill slots in use and the most used at once */
+static char * slotUsed;
+static int slotCount, maxSlots;
+
+/* locations whose offset is relative to the first
+ * cell below the spill slots
+ */
+static int * frameFix;
+static int frameFixCount, frameFixSize;
+
+/* jumps to blocks, patched when the function is done */
+typedef struct
+   { int loc;
+     char * op;
+     int r;
+     int block;
+   } Fixup;
+
+static Fixup * fixups;
+static int fixupCount, fixupSize;
+
+/* location of the first instruction of each block */
+static int * blockLoc;
+
+/* Function slotLoc returns the fp offset of slot s */
+static int slotLoc( int s)
+{ return -(FRAME_HEADER + fn->frameSize + s); }
+
+/* Function varLoc returns the offset of the first
+ * cell of variable s from its base register, which
+ * is stored in *reg (gp for globals, fp otherwise)
+ */
+static int varLoc( BucketList s, int * r)
+{ if (s->nestedLevel == 0)
+  { *r = gp;
+    return s->memloc;
+  }
+  *r = fp;
+  return -(FRAME_HEADER + s->memloc + s->size - 1);
+}
+
+/* Procedure spill stores vreg v in a spill slot,
+ * unless it is there already, and frees its register
+ */
+static void spill( int v)
+{ int s;
+  if (slot[v] < 0)
+  { s = 0;
+    while (s < slotCount && slotUsed[s]) s++;
+    if (s == slotCount)
+    { slotUsed = (char *) realloc(slotUsed, ++slotCount);
+      if (slotCount > maxSlots) maxSlots = slotCount;
+    }
+    slotUsed[s] = TRUE;
+    slot[v] = s;
+    emitRM("ST",reg[v],slotLoc(s),fp,"spill vreg");
+  }
+  owner[reg[v]] = -1;
+  reg[v] = -1;
+}
+
+/* Procedure release forgets vreg v after its last use */
+static void release( int v)
+{ if (v < 0) return;
+  if (reg[v] >= 0) owner[reg[v]] = -1;
+  if (slot[v] >= 0) slotUsed[slot[v]] = FALSE;
+  reg[v] = slot[v] = -1;
+}
+
+/* Procedure done releases vreg v if instruction j
+ * is its last use
+ */
+static void done( int v, int j)
+{ if (v >= 0 && lastUse[v] == j) release(v); }
+
+/* Function allocReg returns a free register of the
+ * pool, spilling the vreg used last if there is
+ * none. Registers in mask pinned are not spilled
+ */
+static int allocReg( int pinned)
+{ int i, r, victim = -1;
+  for (i = 0; i < npool; i++)
+    if (owner[pool[i]] < 0) return pool[i];
+  for (i = 0; i < npool; i++)
+  { r = pool[i];
+    if (pinned & (1 << r)) continue;
+    if (victim < 0 || lastUse[owner[r]] > lastUse[owner[victim]]) victim = r;
+  }
+  spill(owner[victim]);
+  return victim;
+}
+
+/* Function src returns a register holding vreg v
+ * without its offset off[v]
+ */
+static int src( int v, int pinned)
+{ int r;
+  if (base[v] >= 0) return base[v];
+  if (reg[v] >= 0) return reg[v];
+  r = allocReg(pinned);
+  emitRM("LD",r,slotLoc(slot[v]),fp,"reload vreg");
+  reg[v] = r;
+  owner[r] = v;
+  return r;
+}
+
+/* Function value returns a register holding the
+ * value of vreg v
+ */
+static int value( int v, int pinned)
+{ int r = src(v,pinned);
+  if (base[v] >= 0)
+  { r = allocReg(pinned);
+    emitRM("LDA",r,off[v],base[v],"array address");
+    base[v] = -1;
+    reg[v] = r;
+    owner[r] = v;
+    off[v] = 0;
+  }
+  else if (off[v] != 0)
+  { emitRM("LDA",r,off[v],r,"add offset");
+    off[v] = 0;
+    if (slot[v] >= 0) slotUsed[slot[v]] = FALSE;
+    slot[v] = -1;
+  }
+  return r;
+}
+
+/* Function def assigns a register to vreg v */
+static int def( int v, int pinned)
+{ int r = allocReg(pinned);
+  reg[v] = r;
+  owner[r] = v;
+  off[v] = 0;
+  base[v] = -1;
+  slot[v] = -1;
+  return r;
+}
+
+/* Function varReg returns the register holding
+ * variable s, -1 if it is kept in memory
+ */
+static int varReg( BucketList s)
+{ int v = s->nestedLevel > 0 ? cfgVarIndex(graph,s) : -1;
+  return v >= 0 ? alloc->reg[v] : -1;
+}
+
+/* Procedure addAlias makes vreg v share the register
+ * r of a variable
+ */
+static void addAlias( int r, int v)
+{ if (aliasCount[r] == aliasSize[r])
+  { aliasSize[r] = aliasSize[r] ? aliasSize[r] * 2 : 16;
+    alias[r] = (int *) realloc(alias[r], aliasSize[r] * sizeof(int));
+  }
+  alias[r][aliasCount[r]++] = v;
+  reg[v] = r;
+  off[v] = 0;
+  base[v] = slot[v] = -1;
+}
+
+/* Procedure breakAliases gives the vregs sharing
+ * the register r of a variable registers of their
+ * own, before r is set
+ */
+static void breakAliases( int r, int pinned)
+{ int i, v, nr;
+  for (i = 0; i < aliasCount[r]; i++)
+  { v = alias[r][i];
+    if (reg[v] != r) continue;
+    nr = allocReg(pinned | (1 << r));
+    emitRM("LDA",nr,0,r,"copy variable");
+    reg[v] = nr;
+    owner[nr] = v;
+  }
+  aliasCount[r] = 0;
+}
+
+/* Procedure saveVars stores (load FALSE) or loads
+ * again the registers of the variables that are live
+ * across the call at instruction pos
+ */
+static void saveVars( int pos, int load)
+{ int v, loc, br;
+  for (v = 0; v < alloc->vars; v++)
+    if (alloc->reg[v] >= 0 && alloc->start[v] <= pos && pos < alloc->end[v])
+    { loc = varLoc(graph->var[v],&br);
+      emitRM(load ? "LD" : "ST",alloc->reg[v],loc,br,
+             load ? "call: restore variable" : "call: save variable");
+    }
+}
+
+/* Procedure emitFrame emits an instruction whose
+ * offset d is relative to the end of the spill slots
+ */
+static void emitFrame( char * op, int r, int d, char * c)
+{ if (frameFixCount == frameFixSize)
+  { frameFixSize = frameFixSize ? frameFixSize * 2 : 64;
+    frameFix = (int *) realloc(frameFix, frameFixSize * sizeof(int));
+  }
+  frameFix[frameFixCount++] = emitSkip(0);
+  emitRM(op,r,d,fp,c);
+}
+
+/* Procedure emitJump emits a jump to block b */
+static void emitJump( char * op, int r, int b)
+{ if (fixupCount == fixupSize)
+  { fixupSize = fixupSize ? fixupSize * 2 : 64;
+    fixups = (Fixup *) realloc(fixups, fixupSize * sizeof(Fixup));
+  }
+  fixups[fixupCount].loc = emitSkip(1);
+  fixups[fixupCount].op = op;
+  fixups[fixupCount].r = r;
+  fixups[fixupCount].block = b;
+  fixupCount++;
+}
+
+/* jump opcodes of the relations IrLt..IrNe and of
+ * their negations
+ */
+static char * jumpOp[] = { "JLT", "JLE", "JGT", "JGE", "JEQ", "JNE" };
+static char * notJumpOp[] = { "JGE", "JGT", "JLE", "JLT", "JNE", "JEQ" };
+
+/* Procedure genReturn generates the return sequence
+ * of a function; the return value is left in ac
+ */
+static void genReturn(void)
+{ emitRM("LD",ac1,-1,fp,"load return address");
+  emitRM("LD",fp,0,fp,"pop activation record");
+  emitRM("LDA",pc,0,ac1,"return to caller");
+}
+
+/* Procedure lowerInstr lowers instruction j of
+ * block b
+ */
+static void lowerInstr( int b, int j)
+{ IrInstr * in = &fn->blocks[b].code[j];
+  int ra, rb, r, v, loc, br;
+  switch (in->op)
+  { case IrConst :
+      emitRM("LDC",def(in->dst,0),in->k,0,"load const");
+      break;
+    case IrCopy :
+      ra = value(in->a,0);
+      done(in->a,j);
+      emitRM("LDA",def(in->dst,1 << ra),0,ra,"copy");
+      break;
+    case IrAdd :
+    case IrSub :
+      ra = src(in->a,0);
+      rb = src(in->b,1 << ra);
+      v = in->op == IrAdd ? off[in->a] + off[in->b] : off[in->a] - off[in->b];
+      done(in->a,j);
+      done(in->b,j);
+      r = def(in->dst,(1 << ra) | (1 << rb));
+      emitRO(in->op == IrAdd ? "ADD" : "SUB",r,ra,rb,"op");
+      off[in->dst] = v;
+      break;
+    case IrMul :
+    case IrDiv :
+    case IrLt : case IrLe : case IrGt : case IrGe : case IrEq : case IrNe :
+      ra = value(in->a,0);
+      rb = value(in->b,1 << ra);
+      done(in->a,j);
+      done(in->b,j);
+      r = def(in->dst,(1 << ra) | (1 << rb));
+      if (in->op == IrMul) emitRO("MUL",r,ra,rb,"op *");
+      else if (in->op == IrDiv) emitRO("DIV",r,ra,rb,"op /");
+      else
+      { emitRO("SUB",r,ra,rb,"op relop");
+        emitRM(jumpOp[in->op - IrLt],r,2,pc,"br if true");
+        emitRM("LDC",r,0,0,"false case");
+        emitRM("LDA",pc,1,pc,"unconditional jmp");
+        emitRM("LDC",r,1,0,"true case");
+      }
+      break;
+    case IrGetVar :
+      if ((r = varReg(in->sym)) >= 0)
+      { addAlias(r,in->dst);
+        break;
+      }
+      loc = varLoc(in->sym,&br);
+      emitRM("LD",def(in->dst,0),loc,br,"load id value");
+      break;
+    case IrSetVar :
+      ra = value(in->a,0);
+      if ((r = varReg(in->sym)) >= 0)
+      { breakAliases(r,1 << ra);
+        if (r != ra) emitRM("LDA",r,0,ra,"assign: set variable");
+        break;
+      }
+      loc = varLoc(in->sym,&br);
+      emitRM("ST",ra,loc,br,"assign: store value");
+      break;
+    case IrAddr :
+      v = in->dst;
+      reg[v] = slot[v] = -1;
+      off[v] = varLoc(in->sym,&base[v]);
+      break;
+    case IrLoad :
+      ra = src(in->a,0);
+      loc = off[in->a] + in->k;
+      done(in->a,j);
+      emitRM("LD",def(in->dst,1 << ra),loc,ra,"load array element");
+      break;
+    case IrStore :
+      ra = src(in->a,0);
+      rb = value(in->b,1 << ra);
+      emitRM("ST",rb,off[in->a] + in->k,ra,"assign: store element");
+      break;
+    case IrInput :
+      emitRO("IN",def(in->dst,0),0,0,"read integer value");
+      break;
+    case IrOutput :
+      emitRO("OUT",value(in->a,0),0,0,"write value");
+      break;
+    case IrArg :
+      ra = value(in->a,0);
+      emitFrame("ST",ra,-(FRAME_HEADER + in->k),"store argument");
+      break;
+    case IrCall :
+      /* the callee may change every register */
+      for (r = 0; r < 8; r++)
+        if (owner[r] >= 0)
+        { if (lastUse[owner[r]] > j) spill(owner[r]);
+          else release(owner[r]);
+        }
+      for (r = 0; r < 8; r++)
+      { for (v = 0; v < aliasCount[r]; v++)
+          if (reg[alias[r][v]] == r && lastUse[alias[r][v]] > j)
+            spill(alias[r][v]);
+        aliasCount[r] = 0;
+      }
+      saveVars(firstPos + j,FALSE);
+      emitFrame("ST",fp,0,"store control link");
+      emitFrame("LDA",fp,0,"push activation record");
+      emitRM("LDA",ac,1,pc,"save return address");
+      emitRM_Abs("LDA",pc,in->sym->memloc,"jump to function");
+      saveVars(firstPos + j,TRUE);
+      if (in->dst >= 0)
+      { v = in->dst;
+        reg[v] = ac;
+        owner[ac] = v;
+        off[v] = 0;
+        base[v] = slot[v] = -1;
+      }
+      break;
+    case IrJump :
+      if (in->target != b + 1) emitJump("LDA",pc,in->target);
+      break;
+    case IrBranch :
+      ra = value(in->a,0);
+      if (in->b >= 0)
+      { rb = value(in->b,1 << ra);
+        r = isVarReg[ra] ? allocReg((1 << ra) | (1 << rb)) : ra;
+        emitRO("SUB",r,ra,rb,"op relop");
+      }
+      else r = ra;
+      if (in->target == b + 1)
+        emitJump(notJumpOp[in->k - IrLt],r,in->other);
+      else
+      { emitJump(jumpOp[in->k - IrLt],r,in->target);
+        if (in->other != b + 1) emitJump("LDA",pc,in->other);
+      }
+      break;
+    case IrReturn :
+      if (in->a >= 0)
+      { ra = value(in->a,0);
+        if (ra != ac) emitRM("LDA",ac,0,ra,"move return value");
+      }
+      genReturn();
+      break;
+  }
+}
+
+/* Procedure lowerBlock lowers block b */
+static void lowerBlock( int b)
+{ IrBlock * bl = &fn->blocks[b];
+  IrInstr * in;
+  int j, r;
+  for (j = 0; j < bl->count; j++)
+  { in = &bl->code[j];
+    if (in->a >= 0) lastUse[in->a] = j;
+    if (in->b >= 0) lastUse[in->b] = j;
+    if (in->dst >= 0) lastUse[in->dst] = j;
+  }
+  for (r = 0; r < 8; r++)
+  { owner[r] = -1;
+    aliasCount[r] = 0;
+  }
+  for (j = 0; j < bl->count; j++)
+  { in = &bl->code[j];
+    emitLine(in->lineno);
+    lowerInstr(b,j);
+    /* operands used for the last time are dropped */
+    done(in->a,j);
+    done(in->b,j);
+    done(in->dst,j);
+  }
+}
+
+/* Procedure lowerFunc lowers function f */
+static void lowerFunc( IrFunction * f)
+{ int n = f->vregs + 1, i, b, r, v, loc, br;
+  char * c;
+  fn = f;
+  graph = cfgBuild(f);
+  cfgLiveness(graph);
+  alloc = allocateVars(graph,varRegs,VarRegisters < 0 ? 0 :
+                       VarRegisters > 3 ? 3 : VarRegisters, TRUE);
+  if (TraceIR)
+  { cfgDominators(graph);
+    cfgPrint(listing,graph);
+    printAllocation(listing,graph,alloc);
+  }
+  for (r = 0; r < 8; r++) isVarReg[r] = FALSE;
+  for (v = 0; v < alloc->vars; v++)
+    if (alloc->reg[v] >= 0) isVarReg[alloc->reg[v]] = TRUE;
+  npool = 0;
+  for (i = 0; i < NREGS; i++)
+    if (!isVarReg[regs[i]]) pool[npool++] = regs[i];
+  reg = (int *) malloc(n * sizeof(int));
+  off = (int *) calloc(n, sizeof(int));
+  base = (int *) malloc(n * sizeof(int));
+  slot = (int *) malloc(n * sizeof(int));
+  lastUse = (int *) calloc(n, sizeof(int));
+  for (i = 0; i < n; i++) reg[i] = base[i] = slot[i] = -1;
+  blockLoc = (int *) malloc((f->blockCount + 1) * sizeof(int));
+  slotCount = maxSlots = 0;
+  frameFixCount = fixupCount = 0;
+  if (TraceCode) emitComment("-> function") ;
+  emitLine(f->tree->lineno);
+  emitFunction(f->sym->name);
+  f->sym->memloc = emitSkip(0);
+  emitRM("ST",ac,-1,fp,"store return address");
+  /* variables live at the entry (the parameters) */
+  for (v = 0; v < alloc->vars; v++)
+    if (alloc->reg[v] >= 0 && bsHas(graph->liveIn[0],v))
+    { loc = varLoc(graph->var[v],&br);
+      emitRM("LD",alloc->reg[v],loc,br,"load variable");
+    }
+  firstPos = 0;
+  for (b = 0; b < f->blockCount; b++)
+  { blockLoc[b] = emitSkip(0);
+    if (TraceCode)
+    { c = (char *) malloc(16);
+      sprintf(c,"B%d:",b);
+      emitComment(c);
+    }
+    lowerBlock(b);
+    firstPos += f->blocks[b].count;
+  }
+  for (i = 0; i < fixupCount; i++)
+    emitBackpatch(fixups[i].loc,fixups[i].op,fixups[i].r,
+                  blockLoc[fixups[i].block],"jump to block");
+  for (i = 0; i < frameFixCount; i++)
+    emitInstruction(frameFix[i])->t -= FRAME_HEADER + f->frameSize + maxSlots;
+  if (TraceCode) emitComment("<- function") ;
+  free(reg);
+  free(off);
+  free(base);
+  free(slot);
+  free(lastUse);
+  free(blockLoc);
+  freeAllocation(alloc);
+  cfgFree(graph);
+}
+
+/* Procedure irCodeGen generates code to a code
+ * file through the IR
+ */
+void irCodeGen(TreeNode * syntaxTree, char * codefile)
+{  char * s = malloc(strlen(codefile)+7);
+   IrProgram * p = irBuild(syntaxTree);
+   int mainLoc, i, mainEntry = -1;
+   if (TraceIR)
+   { fprintf(listing,"\nIntermediate code:\n");
+     irPrint(listing,p);
+   }
+   if (irVerify(p) > 0)
+   { Error = TRUE;
+     irFree(p);
+     return;
+   }
+   strcpy(s,"File: ");
+   strcat(s,codefile);
+   emitComment("C-MINUS Compilation to TM Code");
+   emitComment(s);
+   /* generate standard prelude */
+   emitComment("Standard prelude:");
+   emitRM("LD",fp,0,ac,"load maxaddress from location 0");
+   emitRM("ST",ac,0,ac,"clear location 0");
+   emitRM("LDA",ac,1,pc,"save return address");
+   mainLoc = emitSkip(1);
+   emitComment("End of execution.");
+   emitRO("HALT",0,0,0,"");
+   emitComment("End of standard prelude.");
+   for (i = 0; i < p->count; i++)
+   { lowerFunc(&p->funcs[i]);
+     if (strcmp(p->funcs[i].sym->name,"main") == 0)
+       mainEntry = p->funcs[i].sym->memloc;
+   }
+   /* call main from the prelude */
+   emitBackpatch(mainLoc,"LDA",pc,mainEntry >= 0 ? mainEntry : mainLoc+1,
+                 "jump to main");
+   peephole();
+   emitFlush(NULL);
+   irFree(p);
+}
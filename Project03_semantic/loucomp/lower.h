@@ -0,0 +1,18 @@
+/****************************************************/
+/* File: lower.h                                    */
+/* Lowering of the IR to TM code                    */
+/* for the C-Minus compiler                         */
+/****************************************************/
+
+#ifndef _LOWER_H_
+#define _LOWER_H_
+
+/* Procedure irCodeGen generates code to a code
+ * file like codeGen, but by translating the syntax
+ * tree to IR, which is verified and then lowered
+ * to TM code. With TraceIR the IR is printed to
+ * the listing file
+ */
+void irCodeGen(TreeNode * syntaxTree, char * codefile);
+
+#endif
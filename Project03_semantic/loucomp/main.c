@@ -15,17 +15,20 @@
 /* set NO_CODE to TRUE to get a compiler that does not
  * generate code
  */
-#define NO_CODE TRUE
+#define NO_CODE FALSE
 
 #include "util.h"
-#if NO_PARSE
 #include "scan.h"
-#else
+#if !NO_PARSE
 #include "parse.h"
 #if !NO_ANALYZE
 #include "analyze.h"
+#include "fold.h"
 #if !NO_CODE
 #include "cgen.h"
+#include "lower.h"
+#include "x86.h"
+#include "ctrans.h"
 #endif
 #endif
 #endif
@@ -43,16 +46,97 @@ int TraceParse = FALSE;
 int TraceAnalyze = TRUE;
 int TraceCode = FALSE;
 
+/* number of semantic analysis threads (-jN) */
+int AnalyzeThreads = 1;
+
+/* maximum number of reported errors, 0: no limit (-eN) */
+int MaxErrors = 0;
+
+/* peephole optimizer window (-pN) and statistics (-ps) */
+int PeepholeWindow = 8;
+int PeepholeStats = FALSE;
+
+/* code generation through the IR (-ir), IR listing (-ti) */
+int UseIR = FALSE;
+int TraceIR = FALSE;
+
+/* registers for the variables of a function (-rN) */
+int VarRegisters = 3;
+
+/* TM object file in place of TM text code (-b) */
+int BinaryCode = FALSE;
+
+/* code target: TM code, x86-64 assembly (-S) or C (-C) */
+TargetKind Target = TmTarget;
+
+/* edited version of the program, analysed again
+ * incrementally after the program (-iFILE)
+ */
+static char * edited = NULL;
+
 int Error = FALSE;
 
+#if !NO_PARSE && !NO_ANALYZE
+/* Function reanalyzeEdited analyses the program
+ * syntaxTree and then, as a watch mode would after an
+ * edit, the edited version in the file edited: only
+ * its changed functions and their dependents are
+ * analysed again. Returns the syntax tree of the
+ * edited version, whose name is copied to pgm
+ */
+static TreeNode * reanalyzeEdited(TreeNode * syntaxTree, char * pgm)
+{ reanalyze(syntaxTree);
+  fclose(source);
+  source = fopen(edited,"r");
+  if (source==NULL)
+  { fprintf(stderr,"File %s not found\n",edited);
+    exit(1);
+  }
+  strcpy(pgm,edited);
+  fprintf(listing,"\nC-MINUS COMPILATION: %s\n",pgm);
+  Error = FALSE;
+  restartScanner();
+  syntaxTree = parse();
+  if (! Error) reanalyze(syntaxTree);
+  return syntaxTree;
+}
+#endif
+
 main( int argc, char * argv[] )
 { TreeNode * syntaxTree;
   char pgm[120]; /* source code file name */
-  if (argc != 2)
-    { fprintf(stderr,"usage: %s <filename>\n",argv[0]);
+  int argi = 1;
+  while (argi < argc && argv[argi][0] == '-')
+  { if (strncmp(argv[argi],"-j",2) == 0 && atoi(argv[argi]+2) > 0)
+      AnalyzeThreads = atoi(argv[argi]+2);
+    else if (strncmp(argv[argi],"-e",2) == 0)
+      MaxErrors = atoi(argv[argi]+2);
+    else if (strcmp(argv[argi],"-ir") == 0)
+      UseIR = TRUE;
+    else if (strcmp(argv[argi],"-ti") == 0)
+      UseIR = TraceIR = TRUE;
+    else if (strncmp(argv[argi],"-r",2) == 0 && isdigit(argv[argi][2]))
+      VarRegisters = atoi(argv[argi]+2);
+    else if (strcmp(argv[argi],"-b") == 0)
+      BinaryCode = TRUE;
+    else if (strcmp(argv[argi],"-S") == 0)
+      Target = X86Target;
+    else if (strcmp(argv[argi],"-C") == 0)
+      Target = CTarget;
+    else if (strcmp(argv[argi],"-ps") == 0)
+      PeepholeStats = TRUE;
+    else if (strncmp(argv[argi],"-p",2) == 0 && isdigit(argv[argi][2]))
+      PeepholeWindow = atoi(argv[argi]+2);
+    else if (strncmp(argv[argi],"-i",2) == 0 && argv[argi][2] != '\0')
+      edited = argv[argi]+2;
+    else break;
+    argi++;
+  }
+  if (argi != argc-1)
+    { fprintf(stderr,"usage: %s [-jN] [-eN] [-pN] [-ps] [-ir] [-ti] [-rN] [-b] [-S] [-C] [-iEDITED] <filename>\n",argv[0]);
       exit(1);
     }
-  strcpy(pgm,argv[1]) ;
+  strcpy(pgm,argv[argi]) ;
   if (strchr (pgm, '.') == NULL)
      strcat(pgm,".tny");
   source = fopen(pgm,"r");
@@ -74,24 +158,36 @@ main( int argc, char * argv[] )
 #if !NO_ANALYZE
   if (! Error)
   { if (TraceAnalyze) fprintf(listing,"\nBuilding Symbol Table...\n");
-    buildSymtab(syntaxTree);
-    if (TraceAnalyze) fprintf(listing,"\nChecking Types...\n");
-    typeCheck(syntaxTree);
+    if (edited != NULL) syntaxTree = reanalyzeEdited(syntaxTree,pgm);
+    else
+    { buildSymtab(syntaxTree);
+      if (TraceAnalyze) fprintf(listing,"\nChecking Types...\n");
+      typeCheck(syntaxTree);
+    }
     if (TraceAnalyze) fprintf(listing,"\nType Checking Finished\n");
+    if (! Error) foldConstants(syntaxTree);
   }
 #if !NO_CODE
   if (! Error)
   { char * codefile;
     int fnlen = strcspn(pgm,".");
-    codefile = (char *) calloc(fnlen+4, sizeof(char));
+    codefile = (char *) calloc(fnlen+5, sizeof(char));
     strncpy(codefile,pgm,fnlen);
-    strcat(codefile,".tm");
-    code = fopen(codefile,"w");
+    strcat(codefile,Target == X86Target ? ".s" : Target == CTarget ? ".c" :
+                    BinaryCode ? ".tmo" : ".tm");
+    if (strcmp(codefile,pgm) == 0)
+    { fprintf(stderr,"Code file %s would overwrite the source\n",codefile);
+      exit(1);
+    }
+    code = fopen(codefile,Target == TmTarget && BinaryCode ? "wb" : "w");
     if (code == NULL)
     { printf("Unable to open %s\n",codefile);
       exit(1);
     }
-    codeGen(syntaxTree,codefile);
+    if (Target == X86Target) x86CodeGen(syntaxTree,codefile);
+    else if (Target == CTarget) cCodeGen(syntaxTree,codefile);
+    else if (UseIR) irCodeGen(syntaxTree,codefile);
+    else codeGen(syntaxTree,codefile);
     fclose(code);
   }
 #endif
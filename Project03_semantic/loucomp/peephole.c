@@ -0,0 +1,375 @@
+/****************************************************/
+/* File: peephole.c                                 */
+/* Peephole optimizer for generated TM code         */
+/****************************************************/
+
+#include "globals.h"
+#include "code.h"
+#include "peephole.h"
+
+/* the rules of the optimizer */
+typedef enum
+   { TempCopy,     /* ST r,t(fp) ... LD r2,t(fp) => LDA r2,0(r) ...  */
+     StoreLoad,    /* ST r,x(b); LD r,x(b) => ST r,x(b)              */
+     ConstOperand, /* LDC x,k; ADD x,a,x => LDA x,k(a)               */
+     CopyForward,  /* LDA r2,0(r); use of r2 => use of r             */
+     CopyBackward, /* X r,...; LDA r2,0(r) => X r2,... if r is dead  */
+     NoOpCopy,     /* LDA r,0(r) => removed                          */
+     JumpNext,     /* jump to the next instruction => removed        */
+     JumpThread,   /* jump to LDA pc,d(pc) => jump to its target     */
+     Unreachable,  /* code after a jump that is not a target         */
+     DeadValue,    /* value put in a register that is never used    */
+     RULES
+   } Rule;
+
+static char * ruleName[RULES] =
+   { "temp spill to register copy", "load after store",
+     "constant operand", "copy propagation",
+     "load into copy target", "no-op copy",
+     "jump to next instruction", "jump threading",
+     "unreachable code", "dead register value" };
+
+/* number of times each rule was applied */
+static int hits[RULES];
+
+/* number of code locations */
+static int size;
+
+/* isTarget[loc] is TRUE if a jump (or a return
+ * address) refers to location loc
+ */
+static char * isTarget = NULL;
+
+static Instruction * at( int loc)
+{ return emitInstruction(loc); }
+
+static int isOp( Instruction * in, char * op)
+{ return in->op != NULL && strcmp(in->op,op) == 0; }
+
+/* Function isJump returns TRUE for conditional jumps */
+static int isJump( Instruction * in)
+{ return in->op[0] == 'J'; }
+
+/* Function isRelative returns TRUE if in refers to
+ * a code location relative to pc
+ */
+static int isRelative( Instruction * in)
+{ return in->rm && in->s == pc && !isOp(in,"LDC"); }
+
+/* Function isGoto returns TRUE for LDA pc,d(pc) */
+static int isGoto( Instruction * in)
+{ return isOp(in,"LDA") && in->r == pc && in->s == pc; }
+
+/* Function transfers returns TRUE if in may not
+ * continue with the next instruction
+ */
+static int transfers( Instruction * in)
+{ return isJump(in) || isOp(in,"HALT") ||
+         (in->r == pc && !isOp(in,"ST") && !isOp(in,"OUT"));
+}
+
+/* Function isDef returns TRUE if in only computes a
+ * value into register in->r
+ */
+static int isDef( Instruction * in)
+{ if (in->r == pc) return FALSE;
+  return isOp(in,"LD") || isOp(in,"LDA") || isOp(in,"LDC") ||
+         isOp(in,"IN") || isOp(in,"ADD") || isOp(in,"SUB") ||
+         isOp(in,"MUL") || isOp(in,"DIV");
+}
+
+/* Function writes returns TRUE if in changes register r */
+static int writes( Instruction * in, int r)
+{ if (isJump(in) || isOp(in,"HALT") || isOp(in,"OUT") || isOp(in,"ST"))
+    return FALSE;
+  return in->r == r;
+}
+
+/* Function reads returns TRUE if in uses register r */
+static int reads( Instruction * in, int r)
+{ if (isOp(in,"HALT") || isOp(in,"IN") || isOp(in,"LDC")) return FALSE;
+  if (isOp(in,"OUT")) return in->r == r;
+  if (! in->rm) return in->s == r || in->t == r;
+  if (isOp(in,"ST") || isJump(in)) return in->r == r || in->s == r;
+  return in->s == r;
+}
+
+/* Function next returns the next remaining location */
+static int next( int loc)
+{ do loc++; while (loc < size && at(loc)->op == NULL);
+  return loc;
+}
+
+/* Function live returns loc, or the next remaining
+ * location if loc was deleted
+ */
+static int live( int loc)
+{ while (loc < size && at(loc)->op == NULL) loc++;
+  return loc;
+}
+
+/* Function target returns the location a
+ * pc-relative instruction refers to
+ */
+static int target( int loc)
+{ return loc + 1 + at(loc)->t; }
+
+static void markTargets(void)
+{ int loc, t;
+  memset(isTarget,0,size + 1);
+  for (loc = 0; loc < size; loc++)
+    if (at(loc)->op != NULL && isRelative(at(loc)))
+    { t = target(loc);
+      if (t >= 0 && t <= size) isTarget[live(t)] = TRUE;
+    }
+}
+
+/* Function deadFrom returns TRUE if register r is
+ * set before it is used, on every path starting at
+ * loc. It gives up (FALSE) after *budget instructions
+ * and at indirect jumps
+ */
+static int deadFrom( int loc, int r, int * budget)
+{ Instruction * in;
+  loc = live(loc);
+  while (loc < size)
+  { if ((*budget)-- <= 0) return FALSE;
+    in = at(loc);
+    if (reads(in,r)) return FALSE;
+    if (isOp(in,"HALT") || (writes(in,r) && !transfers(in))) return TRUE;
+    if (isGoto(in)) loc = live(target(loc));
+    else if (isJump(in) && in->s == pc)
+    { if (!deadFrom(target(loc),r,budget)) return FALSE;
+      loc = next(loc);
+    }
+    else if (transfers(in)) return FALSE;
+    else loc = next(loc);
+  }
+  return TRUE;
+}
+
+/* Function dead returns TRUE if register r is not
+ * used after the instruction at loc
+ */
+static int dead( int loc, int r)
+{ int budget = PeepholeWindow;
+  return deadFrom(next(loc),r,&budget);
+}
+
+/* Procedure delete removes the instruction at loc;
+ * references to it now refer to the next one
+ */
+static void delete( int loc)
+{ at(loc)->op = NULL;
+  if (isTarget[loc]) isTarget[live(loc)] = TRUE;
+}
+
+/* Function tempCopy keeps the temp spilled at loc
+ * in the register its reload loads
+ */
+static int tempCopy( int loc)
+{ Instruction * st = at(loc), * in;
+  int j, k, n, r;
+  if (!isOp(st,"ST") || !st->temp || st->s != fp) return FALSE;
+  for (j = next(loc), n = 1; j < size && n < PeepholeWindow; j = next(j), n++)
+  { in = at(j);
+    if (isTarget[j] || transfers(in) || writes(in,fp)) return FALSE;
+    if (isOp(in,"LD") && in->temp && in->s == fp && in->t == st->t) break;
+    if (isOp(in,"ST") && in->s == fp && in->t == st->t) return FALSE;
+  }
+  if (j >= size || n >= PeepholeWindow) return FALSE;
+  r = at(j)->r;
+  for (k = next(loc); k < j; k = next(k))
+    if (reads(at(k),r) || writes(at(k),r)) return FALSE;
+  if (r == st->r) delete(loc);
+  else
+  { st->op = "LDA"; /* r = value of the temp */
+    st->s = st->r;
+    st->r = r;
+    st->t = 0;
+    st->temp = FALSE;
+  }
+  delete(j);
+  return TRUE;
+}
+
+/* Function storeLoad removes a load of the value
+ * just stored from the same register
+ */
+static int storeLoad( int loc)
+{ Instruction * st = at(loc), * ld;
+  int j = next(loc);
+  if (!isOp(st,"ST") || j >= size || isTarget[j]) return FALSE;
+  ld = at(j);
+  if (!isOp(ld,"LD") || ld->r != st->r || ld->s != st->s ||
+      ld->t != st->t || st->s == st->r)
+    return FALSE;
+  delete(j);
+  return TRUE;
+}
+
+/* Function constOperand turns a constant loaded for
+ * an addition or subtraction into the offset of LDA
+ */
+static int constOperand( int loc)
+{ Instruction * ldc = at(loc), * op;
+  int j = next(loc), x = ldc->r, k = ldc->t, a;
+  if (!isOp(ldc,"LDC") || j >= size || isTarget[j]) return FALSE;
+  op = at(j);
+  if (op->r != x && !dead(j,x)) return FALSE;
+  if (isOp(op,"ADD") && op->t == x && op->s != x) a = op->s;
+  else if (isOp(op,"ADD") && op->s == x && op->t != x) a = op->t;
+  else if (isOp(op,"SUB") && op->t == x && op->s != x)
+  { a = op->s;
+    k = -k;
+  }
+  else return FALSE;
+  op->op = "LDA";
+  op->rm = TRUE;
+  op->s = a;
+  op->t = k;
+  delete(loc);
+  return TRUE;
+}
+
+/* Function copyForward lets the instruction after
+ * the copy LDA r2,0(r) use r itself when r2 is not
+ * needed afterwards
+ */
+static int copyForward( int loc)
+{ Instruction * cp = at(loc), * use;
+  int j = next(loc), r2 = cp->r, r = cp->s;
+  if (!isOp(cp,"LDA") || cp->t != 0 || r == pc || r2 == pc || r == r2 ||
+      j >= size || isTarget[j])
+    return FALSE;
+  use = at(j);
+  if (!reads(use,r2) || transfers(use)) return FALSE;
+  if (!writes(use,r2) && !dead(j,r2)) return FALSE;
+  if (use->rm)
+  { if (use->s == r2) use->s = r;
+    if ((isOp(use,"ST") || isJump(use)) && use->r == r2) use->r = r;
+  }
+  else
+  { if (use->s == r2) use->s = r;
+    if (use->t == r2) use->t = r;
+    if (isOp(use,"OUT") && use->r == r2) use->r = r;
+  }
+  delete(loc);
+  return TRUE;
+}
+
+/* Function copyBackward computes the value copied
+ * by LDA r2,0(r) directly into r2 when r is not
+ * needed after the copy
+ */
+static int copyBackward( int loc)
+{ Instruction * def = at(loc), * cp;
+  int j = next(loc);
+  if (!isDef(def) || j >= size || isTarget[j]) return FALSE;
+  cp = at(j);
+  if (!isOp(cp,"LDA") || cp->t != 0 || cp->s != def->r || cp->r == def->r ||
+      cp->r == pc)
+    return FALSE;
+  if (!dead(j,def->r)) return FALSE;
+  def->r = cp->r;
+  delete(j);
+  return TRUE;
+}
+
+/* Function noOpCopy removes LDA r,0(r) */
+static int noOpCopy( int loc)
+{ Instruction * in = at(loc);
+  if (!isOp(in,"LDA") || in->t != 0 || in->r != in->s || in->r == pc)
+    return FALSE;
+  delete(loc);
+  return TRUE;
+}
+
+/* Function jumpNext removes a jump to the next
+ * instruction
+ */
+static int jumpNext( int loc)
+{ Instruction * in = at(loc);
+  if (!(isGoto(in) || (isJump(in) && in->s == pc))) return FALSE;
+  if (live(target(loc)) != next(loc)) return FALSE;
+  delete(loc);
+  return TRUE;
+}
+
+/* Function jumpThread makes a jump to an unconditional
+ * jump go directly to the final target
+ */
+static int jumpThread( int loc)
+{ Instruction * in = at(loc);
+  int t, n;
+  if (!(isGoto(in) || (isJump(in) && in->s == pc))) return FALSE;
+  t = live(target(loc));
+  for (n = 0; n < PeepholeWindow && t < size && t != loc && isGoto(at(t)); n++)
+    t = live(target(t));
+  /* stop on loops of jumps */
+  if (n == 0 || t >= size || t == loc || isGoto(at(t))) return FALSE;
+  in->t = t - (loc + 1);
+  return TRUE;
+}
+
+/* Function unreachable removes the instructions after
+ * an unconditional transfer up to the next jump target
+ */
+static int unreachable( int loc)
+{ Instruction * in = at(loc);
+  int j, n = 0;
+  if (!isOp(in,"HALT") && !((isOp(in,"LDA") || isOp(in,"LD")) && in->r == pc))
+    return FALSE;
+  for (j = next(loc); j < size && !isTarget[j]; j = next(j))
+  { delete(j);
+    n++;
+  }
+  return n > 0;
+}
+
+/* Function deadValue removes an instruction whose
+ * only effect is a register value that is not used
+ */
+static int deadValue( int loc)
+{ Instruction * in = at(loc);
+  /* IN, LD and DIV are kept: input, memory and divide faults */
+  if (!(isOp(in,"LDA") || isOp(in,"LDC") || isOp(in,"ADD") ||
+        isOp(in,"SUB") || isOp(in,"MUL")) || in->r == pc)
+    return FALSE;
+  if (!dead(loc,in->r)) return FALSE;
+  delete(loc);
+  return TRUE;
+}
+
+static int (* rules[RULES])(int) =
+   { tempCopy, storeLoad, constOperand, copyForward, copyBackward,
+     noOpCopy, jumpNext, jumpThread, unreachable, deadValue };
+
+/* Procedure peephole improves the buffered code */
+void peephole(void)
+{ int loc, rule, changed, before, total = 0;
+  if (PeepholeWindow < 2) return;
+  size = before = emitSize();
+  isTarget = (char *) realloc(isTarget, size + 1);
+  memset(hits,0,sizeof(hits));
+  do
+  { changed = FALSE;
+    markTargets();
+    for (loc = 0; loc < size; loc++)
+      for (rule = 0; rule < RULES && at(loc)->op != NULL; rule++)
+        if (rules[rule](loc))
+        { hits[rule]++;
+          changed = TRUE;
+        }
+  } while (changed);
+  emitCompact();
+  if (PeepholeStats)
+  { fprintf(listing,"\nPeephole optimization (window %d): %d -> %d instructions\n",
+            PeepholeWindow, before, emitSize());
+    for (rule = 0; rule < RULES; rule++)
+    { fprintf(listing,"  %-28s %d\n",ruleName[rule],hits[rule]);
+      total += hits[rule];
+    }
+    fprintf(listing,"  %-28s %d\n","total",total);
+  }
+}
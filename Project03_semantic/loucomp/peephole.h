@@ -0,0 +1,17 @@
+/****************************************************/
+/* File: peephole.h                                 */
+/* Peephole optimizer for generated TM code         */
+/****************************************************/
+
+#ifndef _PEEPHOLE_H_
+#define _PEEPHOLE_H_
+
+/* Procedure peephole improves the code in the code
+ * buffer, looking at most PeepholeWindow instructions
+ * ahead, and removes the deleted instructions. With
+ * PeepholeStats the hits of each rule are reported
+ * to the listing file
+ */
+void peephole(void);
+
+#endif
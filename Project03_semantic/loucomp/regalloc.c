@@ -0,0 +1,159 @@
+/****************************************************/
+/* File: regalloc.c                                 */
+/* Linear-scan register allocation of the scalar    */
+/* variables of an IR function                      */
+/****************************************************/
+
+#include "globals.h"
+#include "symtab.h"
+#include "regalloc.h"
+
+/* an access in a loop counts LOOP_WEIGHT times as
+ * much as one outside, up to MAX_DEPTH loops
+ */
+#define LOOP_WEIGHT 8
+#define MAX_DEPTH 5
+
+static int depthWeight(int depth)
+{ int w = 1;
+  if (depth > MAX_DEPTH) depth = MAX_DEPTH;
+  while (depth-- > 0) w *= LOOP_WEIGHT;
+  return w;
+}
+
+/* Procedure extend makes interval v of a cover
+ * instruction i
+ */
+static void extend(Allocation * a, int v, int i)
+{ if (a->start[v] < 0 || i < a->start[v]) a->start[v] = i;
+  if (i > a->end[v]) a->end[v] = i;
+}
+
+/* the allocation being sorted */
+static Allocation * sorting;
+
+static int byStart(const void * x, const void * y)
+{ int a = *(const int *) x, b = *(const int *) y;
+  if (sorting->start[a] != sorting->start[b])
+    return sorting->start[a] - sorting->start[b];
+  return a - b;
+}
+
+/* Function allocateVars assigns the n registers of
+ * regs[] to the variables of graph g by linear scan
+ */
+Allocation * allocateVars(Cfg * g, int * regs, int n, int callerSaved)
+{ IrFunction * f = g->fn;
+  Allocation * a = (Allocation *) malloc(sizeof(Allocation));
+  int size = g->vars + 1, b, j, v, i, k, pos, total = 0, w;
+  int * first, * order, * active, nactive = 0, * freeRegs, nfree;
+  long * callCost;
+  IrInstr * in;
+  a->vars = g->vars;
+  a->start = (int *) malloc(size * sizeof(int));
+  a->end = (int *) malloc(size * sizeof(int));
+  a->weight = (int *) calloc(size, sizeof(int));
+  a->reg = (int *) malloc(size * sizeof(int));
+  for (v = 0; v < g->vars; v++) a->start[v] = a->end[v] = a->reg[v] = -1;
+  /* number the instructions */
+  first = (int *) malloc((g->n + 1) * sizeof(int));
+  for (b = 0; b < g->n; b++)
+  { first[b] = total;
+    total += f->blocks[b].count;
+  }
+  first[g->n] = total;
+  /* intervals, weights and the cost of saving a
+   * register around the calls up to each instruction
+   */
+  callCost = (long *) calloc(total + 1, sizeof(long));
+  for (b = 0; b < g->n; b++)
+  { w = depthWeight(f->blocks[b].loopDepth);
+    for (v = bsNext(g->liveIn[b],0); v >= 0; v = bsNext(g->liveIn[b],v+1))
+      extend(a,v,first[b]);
+    for (v = bsNext(g->liveOut[b],0); v >= 0; v = bsNext(g->liveOut[b],v+1))
+      extend(a,v,first[b+1]-1);
+    for (j = 0; j < f->blocks[b].count; j++)
+    { in = &f->blocks[b].code[j];
+      pos = first[b] + j;
+      callCost[pos+1] = callCost[pos] +
+                        (in->op == IrCall && callerSaved ? 2 * w : 0);
+      if ((in->op == IrGetVar || in->op == IrSetVar) &&
+          (v = cfgVarIndex(g,in->sym)) >= 0)
+      { extend(a,v,pos);
+        a->weight[v] += w;
+      }
+    }
+  }
+  /* a register saved and restored at each call of
+   * the interval must still pay off
+   */
+  order = (int *) malloc(size * sizeof(int));
+  k = 0;
+  for (v = 0; v < g->vars; v++)
+  { if (a->start[v] < 0) continue;
+    if (a->weight[v] - (callCost[a->end[v]] - callCost[a->start[v]]) <= 0)
+      continue;
+    order[k++] = v;
+  }
+  sorting = a;
+  qsort(order,k,sizeof(int),byStart);
+  /* linear scan; active[] is sorted by end */
+  active = (int *) malloc((n + 1) * sizeof(int));
+  freeRegs = (int *) malloc((n + 1) * sizeof(int));
+  for (i = 0; i < n; i++) freeRegs[i] = regs[n-1-i];
+  nfree = n;
+  for (i = 0; i < k; i++)
+  { v = order[i];
+    /* expire the intervals that ended */
+    while (nactive > 0 && a->end[active[0]] < a->start[v])
+    { freeRegs[nfree++] = a->reg[active[0]];
+      nactive--;
+      memmove(active,active+1,nactive * sizeof(int));
+    }
+    if (nfree == 0)
+    { /* the active variable of least weight gives way */
+      int low = -1;
+      for (j = 0; j < nactive; j++)
+        if (low < 0 || a->weight[active[j]] < a->weight[active[low]]) low = j;
+      if (low < 0 || a->weight[active[low]] >= a->weight[v]) continue;
+      freeRegs[nfree++] = a->reg[active[low]];
+      a->reg[active[low]] = -1;
+      nactive--;
+      memmove(active+low,active+low+1,(nactive-low) * sizeof(int));
+    }
+    a->reg[v] = freeRegs[--nfree];
+    for (j = nactive; j > 0 && a->end[active[j-1]] > a->end[v]; j--)
+      active[j] = active[j-1];
+    active[j] = v;
+    nactive++;
+  }
+  free(first);
+  free(callCost);
+  free(order);
+  free(active);
+  free(freeRegs);
+  return a;
+}
+
+/* Procedure printAllocation prints the intervals and
+ * registers of allocation a to file f
+ */
+void printAllocation(FILE * f, Cfg * g, Allocation * a)
+{ int v;
+  fprintf(f,"\nregisters of %s:\n",g->fn->sym->name);
+  for (v = 0; v < a->vars; v++)
+  { fprintf(f,"  %-12s [%d,%d] weight %d: ",g->var[v]->name,
+            a->start[v],a->end[v],a->weight[v]);
+    if (a->reg[v] >= 0) fprintf(f,"register %d\n",a->reg[v]);
+    else fprintf(f,"memory\n");
+  }
+}
+
+/* Procedure freeAllocation releases allocation a */
+void freeAllocation(Allocation * a)
+{ free(a->start);
+  free(a->end);
+  free(a->weight);
+  free(a->reg);
+  free(a);
+}
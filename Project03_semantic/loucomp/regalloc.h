@@ -0,0 +1,45 @@
+/****************************************************/
+/* File: regalloc.h                                 */
+/* Linear-scan register allocation of the scalar    */
+/* variables of an IR function                      */
+/****************************************************/
+
+#ifndef _REGALLOC_H_
+#define _REGALLOC_H_
+
+#include "cfg.h"
+
+/* The instructions of a function are numbered in
+ * block order. The live interval of variable v (as
+ * numbered by the liveness sets of the graph) is
+ * start[v]..end[v]; reg[v] is the register kept for
+ * it over the whole interval, -1 if the variable
+ * stays in memory
+ */
+typedef struct
+   { int vars;
+     int * start, * end;
+     int * weight; /* accesses, weighted by loop depth */
+     int * reg;
+   } Allocation;
+
+/* Function allocateVars assigns the n registers of
+ * regs[] to the variables of graph g (liveness must
+ * have been computed), by linear scan over the live
+ * intervals. When registers run out, the variables
+ * with the least weight stay in memory. If the
+ * registers are callerSaved, the cost of saving them
+ * around the calls in an interval counts against
+ * the variable
+ */
+Allocation * allocateVars(Cfg * g, int * regs, int n, int callerSaved);
+
+/* Procedure printAllocation prints the intervals and
+ * registers of allocation a to file f
+ */
+void printAllocation(FILE * f, Cfg * g, Allocation * a);
+
+/* Procedure freeAllocation releases allocation a */
+void freeAllocation(Allocation * a);
+
+#endif
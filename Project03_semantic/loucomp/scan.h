@@ -19,4 +19,9 @@ extern char tokenString[MAXTOKENLEN+1];
  */
 TokenType getToken(void);
 
+/* Procedure restartScanner makes getToken read the
+ * source file again from its first line
+ */
+void restartScanner(void);
+
 #endif
@@ -35,11 +35,27 @@ static int hash ( char * key )
 /* the hash table */
 //static BucketList hashTable[SIZE]; -> delete global hashTable
 
-static Scope scopeStack[SIZE];
-static int stackTop = 0;
+/* the scope stack is per thread, so that function
+ * bodies can be analysed in parallel
+ */
+static _Thread_local Scope scopeStack[SIZE];
+static _Thread_local int stackTop = 0;
+
+/* list of closed scopes, in closing order */
+typedef struct
+   { Scope * scopes;
+     int count;
+     int size;
+   } ScopeArray;
+
+static ScopeArray scopeList;
 
-static Scope scopeList[SIZE];
-static int listTop = 0;
+/* closed scopes of a thread that collects its own */
+static _Thread_local ScopeArray collected;
+static _Thread_local int collecting = FALSE;
+
+/* number of global symbols visible to lookups (-1: all) */
+static _Thread_local int visibleGlobals = -1;
 
 /* Procedure st_insert inserts line numbers and
  * memory locations into the symbol table
@@ -63,11 +79,39 @@ BucketList st_insert(Scope scope, SymbolKind kind, ExpType type, char * name, in
     l->next = scope->symbolTable[h];
     l->type = type; // symbol type (func: return type)
     l->kind = kind; // symbol kind
+    l->scopeName = scope->name;
+    l->nestedLevel = scope->nestedLevel;
+    l->declOrder = scope->symbolCount++;
+    l->stamp = 0;
+    l->declHash = 0;
+    l->paramCount = -1;
+    l->paramTypes = NULL;
+    l->size = 1;
+    l->isParam = FALSE;
     scope->symbolTable[h] = l; 
     }
     else return NULL;
   return l;
 }
+void st_reinsert(Scope scope, BucketList l, int lineno, int loc){
+  int h = hash(l->name);
+  l->lines = (LineList) malloc(sizeof(struct LineListRec));
+  l->lines->lineno = lineno;
+  l->lines->next = NULL;
+  l->memloc = loc;
+  l->scopeName = scope->name;
+  l->nestedLevel = scope->nestedLevel;
+  l->declOrder = scope->symbolCount++;
+  l->next = scope->symbolTable[h];
+  scope->symbolTable[h] = l;
+}
+
+void clearScope(Scope scope){
+  memset(scope->symbolTable, 0, sizeof(scope->symbolTable));
+  scope->curloc = 0;
+  scope->symbolCount = 0;
+}
+
 /* Function st_lookup returns the memory 
  * location of a variable or -1 if not found
  */
@@ -80,8 +124,8 @@ void printSymTab(FILE *listing) {
     fprintf(listing, "-------------  -----------  -------------  ------------  --------  ------------\n");
 
     // 스코프 리스트 순회
-    for (int i = 0; i < listTop; i++) {
-        Scope scope = scopeList[i];
+    for (int i = 0; i < scopeList.count; i++) {
+        Scope scope = scopeList.scopes[i];
         for (int j = 0; j < SIZE; j++) {
             BucketList bucket = scope->symbolTable[j];
             while (bucket != NULL) {
@@ -122,10 +166,11 @@ Scope getCurScope() {
 
 // create new scope
 Scope createScope(char *name){
-  Scope newScope = (Scope) malloc(sizeof (struct ScopeListRec)); // create new scope
+  Scope newScope = (Scope) calloc(1, sizeof (struct ScopeListRec)); // create new scope
   newScope->name = name;
   newScope->nestedLevel = 0;
   newScope->curloc = 0;
+  newScope->parent = NULL;
 
   return newScope;
 }
@@ -139,6 +184,8 @@ void insertScope(char *name){
   Scope newScope = createScope(name);
   newScope->parent = curScope;
   newScope->nestedLevel = (curScope->nestedLevel)+1;
+  if (curScope->nestedLevel > 0) // block inside a function: same frame
+    newScope->curloc = curScope->curloc;
 
   pushScopeToStack(newScope); 
 }
@@ -156,18 +203,51 @@ BucketList checkScope(char *name){
   return symbol; // NULL if not found
 }
 
-void addSymbol(TreeNode *t, SymbolKind kind){
+BucketList addSymbol(TreeNode *t, SymbolKind kind){
   Scope curScope = getCurScope();
   //void parameter 면???????
-  st_insert(curScope, kind, t->type, t->attr.name, t->lineno, curScope->curloc++);
+  return st_insert(curScope, kind, t->type, t->attr.name, t->lineno, curScope->curloc++);
+}
+
+static void addToScopeList(ScopeArray * list, Scope scope){
+  if (list->count == list->size) {
+    list->size = list->size ? list->size * 2 : SIZE;
+    list->scopes = (Scope *) realloc(list->scopes, list->size * sizeof(Scope));
+  }
+  list->scopes[list->count++] = scope;
 }
 
 void popScopeInStack(void){
-  scopeList[listTop++] = scopeStack[stackTop-1];
+  addToScopeList(collecting ? &collected : &scopeList, scopeStack[stackTop-1]);
   scopeStack[stackTop--] = NULL;
 
 }
 
+void setVisibleGlobals(int n){
+  visibleGlobals = n;
+}
+
+void resetScopeList(void){
+  scopeList.count = 0;
+}
+
+void collectScopes(int flag){
+  collecting = flag;
+}
+
+int takeScopeList(Scope ** list){
+  int n = collected.count;
+  *list = collected.scopes;
+  collected.scopes = NULL;
+  collected.count = collected.size = 0;
+  return n;
+}
+
+void appendScopeList(Scope * list, int n){
+  int i;
+  for (i = 0; i < n; i++) addToScopeList(&scopeList, list[i]);
+}
+
 //해당하는 symbol 을 return 
 BucketList findSymbol(char * name){
   Scope curScope = getCurScope();
@@ -177,15 +257,18 @@ BucketList findSymbol(char * name){
     while((symbol != NULL) && (strcmp(name, symbol->name) != 0)){
       symbol = symbol->next;
     }
+    if (symbol != NULL && curScope->nestedLevel == 0 &&
+        visibleGlobals >= 0 && symbol->declOrder >= visibleGlobals)
+      symbol = NULL; // declared later in the source
     if (symbol != NULL) return symbol;
     curScope = curScope->parent;
   }
   return NULL; // not found
 }
 
-void addSymbolImplict(TreeNode *t, SymbolKind kind){
+BucketList addSymbolImplict(TreeNode *t, SymbolKind kind){
   Scope curScope = getCurScope();
-  st_insert(curScope, kind, Undetermined, t->attr.name, t->lineno, curScope->curloc++);
+  return st_insert(curScope, kind, Undetermined, t->attr.name, t->lineno, curScope->curloc++);
 }
 
 void insertLineno(BucketList symbol, int lineno){
@@ -198,8 +281,8 @@ void insertLineno(BucketList symbol, int lineno){
 
 Scope findScope(char *name) {
     int h = hash(name); 
-    for (int i = 0; i < listTop; i++) { 
-        Scope curScope = scopeList[i]; 
+    for (int i = 0; i < scopeList.count; i++) { 
+        Scope curScope = scopeList.scopes[i]; 
         BucketList symbol = curScope->symbolTable[h];
 
         while (symbol != NULL) { 
@@ -36,6 +36,14 @@ typedef struct BucketListRec
      ExpType type; // symbol type
      SymbolKind kind; // symbol kind
      char * scopeName;
+     int nestedLevel; // nested level of the declaring scope
+     int declOrder; // insertion order within the declaring scope
+     int stamp; // analysis round that declared the symbol
+     unsigned declHash; // hash of the declaration (functions: header)
+     int paramCount; // functions: number of parameters, -1 if unknown
+     unsigned char * paramTypes; // functions: ExpType of each parameter
+     int size; // memory cells of a variable (array length)
+     int isParam; // TRUE for function parameters
    } * BucketList;
 
 // add scope 
@@ -44,7 +52,8 @@ typedef struct ScopeListRec {
   int nestedLevel; // nested level
   struct ScopeListRec *parent; // parent scope
   BucketList symbolTable[SIZE]; // scope's symbol table
-  int curloc; // scope 내부의 location
+  int curloc; // scope 내부의 location (nested scopes continue the parent's)
+  int symbolCount; // number of symbols inserted so far
 } * Scope;
 
 
@@ -73,12 +82,54 @@ Scope createScope(char *name);
 void pushScopeToStack(Scope scope);
 void insertScope(char *name);
 BucketList checkScope(char *name);
-void addSymbol(TreeNode *t, SymbolKind kind);
+BucketList addSymbol(TreeNode *t, SymbolKind kind);
 BucketList findSymbol(char * name);
-void addSymbolImplict(TreeNode *t, SymbolKind kind);
+BucketList addSymbolImplict(TreeNode *t, SymbolKind kind);
 void insertLineno(BucketList symbol, int lineno);
 Scope findScope(char *name) ;
 BucketList findSymbolinCheck(Scope curScope, char *name);
+void popScopeInStack(void);
+
+/* Procedure st_reinsert enters the existing record l
+ * into scope again, as st_insert would enter a new
+ * one. It is used to keep the identity of symbols
+ * whose declaration did not change between analyses
+ */
+void st_reinsert(Scope scope, BucketList l, int lineno, int loc);
+
+/* Procedure clearScope removes all symbols of scope */
+void clearScope(Scope scope);
+
+/* Procedure resetScopeList empties the shared list
+ * of closed scopes
+ */
+void resetScopeList(void);
+
+/* Procedure setVisibleGlobals limits lookups of the
+ * calling thread to the first n symbols of the global
+ * scope (n < 0 removes the limit). Parallel analysis
+ * uses it so that a function body only sees the
+ * globals declared before it in the source
+ */
+void setVisibleGlobals(int n);
+
+/* Procedure collectScopes(TRUE) makes the calling
+ * thread keep the scopes it closes in a list of its
+ * own instead of the shared scope list
+ */
+void collectScopes(int flag);
+
+/* Function takeScopeList hands the scopes collected by
+ * the calling thread (in closing order) to the caller
+ * and starts a new, empty list. The count is returned
+ * and the array is stored in *list
+ */
+int takeScopeList(Scope ** list);
+
+/* Procedure appendScopeList appends collected scopes
+ * to the shared scope list
+ */
+void appendScopeList(Scope * list, int n);
 
 #endif
 
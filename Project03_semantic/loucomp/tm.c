@@ -9,412 +9,437 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
-
-#ifndef TRUE
-#define TRUE 1
-#endif
-#ifndef FALSE
-#define FALSE 0
+#include <limits.h>
+#if defined(__unix__) || defined(__APPLE__)
+#define HAVE_MMAP 1
 #endif
-
-/******* const *******/
-#define   IADDR_SIZE  1024 /* increase for large programs */
-#define   DADDR_SIZE  1024 /* increase for large programs */
-#define   NO_REGS 8
-#define   PC_REG  7
-
-#define   LINESIZE  121
-#define   WORDSIZE  20
-
-/******* type  *******/
-
-typedef enum {
-   opclRR,     /* reg operands r,s,t */
-   opclRM,     /* reg r, mem d+s */
-   opclRA      /* reg r, int d+s */
-   } OPCLASS;
-
-typedef enum {
-   /* RR instructions */
-   opHALT,    /* RR     halt, operands are ignored */
-   opIN,      /* RR     read into reg(r); s and t are ignored */
-   opOUT,     /* RR     write from reg(r), s and t are ignored */
-   opADD,    /* RR     reg(r) = reg(s)+reg(t) */
-   opSUB,    /* RR     reg(r) = reg(s)-reg(t) */
-   opMUL,    /* RR     reg(r) = reg(s)*reg(t) */
-   opDIV,    /* RR     reg(r) = reg(s)/reg(t) */
-   opRRLim,   /* limit of RR opcodes */
-
-   /* RM instructions */
-   opLD,      /* RM     reg(r) = mem(d+reg(s)) */
-   opST,      /* RM     mem(d+reg(s)) = reg(r) */
-   opRMLim,   /* Limit of RM opcodes */
-
-   /* RA instructions */
-   opLDA,     /* RA     reg(r) = d+reg(s) */
-   opLDC,     /* RA     reg(r) = d ; reg(s) is ignored */
-   opJLT,     /* RA     if reg(r)<0 then reg(7) = d+reg(s) */
-   opJLE,     /* RA     if reg(r)<=0 then reg(7) = d+reg(s) */
-   opJGT,     /* RA     if reg(r)>0 then reg(7) = d+reg(s) */
-   opJGE,     /* RA     if reg(r)>=0 then reg(7) = d+reg(s) */
-   opJEQ,     /* RA     if reg(r)==0 then reg(7) = d+reg(s) */
-   opJNE,     /* RA     if reg(r)!=0 then reg(7) = d+reg(s) */
-   opRALim    /* Limit of RA opcodes */
-   } OPCODE;
-
-typedef enum {
-   srOKAY,
-   srHALT,
-   srIMEM_ERR,
-   srDMEM_ERR,
-   srZERODIVIDE
-   } STEPRESULT;
-
-typedef struct {
-      int iop  ;
-      int iarg1  ;
-      int iarg2  ;
-      int iarg3  ;
-   } INSTRUCTION;
+#include "tmlib.h"
+#include "tmtrace.h"
 
 /******** vars ********/
 int iloc = 0 ;
 int dloc = 0 ;
 int traceflag = FALSE;
 int icountflag = FALSE;
-
-INSTRUCTION iMem [IADDR_SIZE];
-int dMem [DADDR_SIZE];
-int reg [NO_REGS];
-
-char * opCodeTab[]
-        = {"HALT","IN","OUT","ADD","SUB","MUL","DIV","????",
-            /* RR opcodes */
-           "LD","ST","????", /* RM opcodes */
-           "LDA","LDC","JLT","JLE","JGT","JGE","JEQ","JNE","????"
-           /* RA opcodes */
-          };
-
-char * stepResultTab[]
-        = {"OK","Halted","Instruction Memory Fault",
-           "Data Memory Fault","Division by 0"
-          };
-
-char pgmName[20];
-FILE *pgm  ;
-
-char in_Line[LINESIZE] ;
-int lineLen ;
-int inCol  ;
-int num  ;
-char word[WORDSIZE] ;
-char ch  ;
+int refflag = FALSE; /* run with tmStep only (-ref) */
+int batchflag = FALSE; /* run to HALT without prompts (-run) */
+int profflag = FALSE; /* profile the execution (-prof) */
+int fuseflag = TRUE; /* fuse superinstructions (-nofuse: off) */
+int fstatsflag = FALSE; /* report the fusions (-fstats) */
+int mmapflag = FALSE; /* dMem mapped and committed lazily (-mmap) */
+int dSize = DADDR_SIZE; /* dMem locations (-dN) */
+int atSteps = 0; /* steps of -run before it stops (-atN) */
+char * saveName = NULL; /* checkpoint written at the end (-saveFILE) */
+char * restoreName = NULL; /* checkpoint started from (-restoreFILE) */
+
+/* the program and the machine running it */
+TmProgram * prog = NULL;
+TmMachine * tm = NULL;
+TmStreams batchIO; /* stdin and stdout of -run */
+TmSnapshot * start = NULL; /* the state of -restoreFILE */
+
+char pgmName[FILENAME_MAX];
+
+TmScanner cmd ; /* the line of the command or IN value */
 int done  ;
 
 /********************************************/
-int opClass( int c )
-{ if      ( c <= opRRLim) return ( opclRR );
-  else if ( c <= opRMLim) return ( opclRM );
-  else                    return ( opclRA );
-} /* opClass */
-
-/********************************************/
-void writeInstruction ( int loc )
-{ printf( "%5d: ", loc) ;
-  if ( (loc >= 0) && (loc < IADDR_SIZE) )
-  { printf("%6s%3d,", opCodeTab[iMem[loc].iop], iMem[loc].iarg1);
-    switch ( opClass(iMem[loc].iop) )
-    { case opclRR: printf("%1d,%1d", iMem[loc].iarg2, iMem[loc].iarg3);
-                   break;
-      case opclRM:
-      case opclRA: printf("%3d(%1d)", iMem[loc].iarg2, iMem[loc].iarg3);
-                   break;
-    }
-    printf ("\n") ;
+/* reads a line of standard input into cmd,
+   returns FALSE at end of input */
+int readLine (void)
+{ char line[LINESIZE];
+  if (fgets(line, LINESIZE, stdin) == NULL)
+  { tmScanLine(&cmd, "") ;
+    return FALSE ;
   }
-} /* writeInstruction */
-
-/********************************************/
-void getCh (void)
-{ if (++inCol < lineLen)
-  ch = in_Line[inCol] ;
-  else ch = ' ' ;
-} /* getCh */
+  line[strcspn(line, "\n")] = '\0' ;
+  tmScanLine(&cmd, line) ;
+  return TRUE ;
+} /* readLine */
 
 /********************************************/
-int nonBlank (void)
-{ while ((inCol < lineLen)
-         && (in_Line[inCol] == ' ') )
-    inCol++ ;
-  if (inCol < lineLen)
-  { ch = in_Line[inCol] ;
-    return TRUE ; }
+/* formats the instruction at loc into buf */
+void formatInstruction ( char * buf, int loc )
+{ INSTRUCTION * in = &prog->iMem[loc];
+  if ( opClass(in->iop) == opclRR )
+    sprintf(buf, "%6s%3d,%1d,%1d", opCodeTab[in->iop],
+            in->iarg1, in->iarg2, in->iarg3);
   else
-  { ch = ' ' ;
-    return FALSE ; }
-} /* nonBlank */
-
-/********************************************/
-int getNum (void)
-{ int sign;
-  int term;
-  int temp = FALSE;
-  num = 0 ;
-  do
-  { sign = 1;
-    while ( nonBlank() && ((ch == '+') || (ch == '-')) )
-    { temp = FALSE ;
-      if (ch == '-')  sign = - sign ;
-      getCh();
-    }
-    term = 0 ;
-    nonBlank();
-    while (isdigit(ch))
-    { temp = TRUE ;
-      term = term * 10 + ( ch - '0' ) ;
-      getCh();
-    }
-    num = num + (term * sign) ;
-  } while ( (nonBlank()) && ((ch == '+') || (ch == '-')) ) ;
-  return temp;
-} /* getNum */
+    sprintf(buf, "%6s%3d,%3d(%1d)", opCodeTab[in->iop],
+            in->iarg1, in->iarg2, in->iarg3);
+} /* formatInstruction */
 
 /********************************************/
-int getWord (void)
-{ int temp = FALSE;
-  int length = 0;
-  if (nonBlank ())
-  { while (isalnum(ch))
-    { if (length < WORDSIZE-1) word [length++] =  ch ;
-      getCh() ;
-    }
-    word[length] = '\0';
-    temp = (length != 0);
+void writeInstruction ( int loc )
+{ char buf[48];
+  printf( "%5d: ", loc) ;
+  if ( (loc >= 0) && (loc < prog->iSize) )
+  { formatInstruction(buf, loc);
+    printf("%s", buf);
+    if (prog->lineTab != NULL && prog->lineTab[loc] > 0)
+      printf("   line %d", prog->lineTab[loc]);
+    printf ("\n") ;
   }
-  return temp;
-} /* getWord */
+} /* writeInstruction */
 
 /********************************************/
-int skipCh ( char c  )
-{ int temp = FALSE;
-  if ( nonBlank() && (ch == c) )
-  { getCh();
-    temp = TRUE;
+/* the IN callback of the simulation: prompts
+   until a number is entered. Returns FALSE at
+   end of input */
+int promptIn (void * ctx, int * value)
+{ int ok;
+  (void) ctx;
+  do
+  { printf("Enter value for IN instruction: ") ;
+    fflush (stdin);
+    fflush (stdout);
+    if (! readLine()) return FALSE ;
+    ok = tmGetNum(&cmd);
+    if ( ! ok ) printf ("Illegal value\n");
+    else *value = cmd.num;
   }
-  return temp;
-} /* skipCh */
+  while (! ok);
+  return TRUE;
+} /* promptIn */
 
 /********************************************/
-int atEOL(void)
-{ return ( ! nonBlank ());
-} /* atEOL */
+/* the OUT callback of the simulation */
+void printOut (void * ctx, int value)
+{ (void) ctx;
+  printf ("OUT instruction prints: %d\n", value ) ;
+} /* printOut */
 
 /********************************************/
-int error( char * msg, int lineNo, int instNo)
-{ printf("Line %d",lineNo);
-  if (instNo >= 0) printf(" (Instruction %d)",instNo);
-  printf("   %s\n",msg);
-  return FALSE;
-} /* error */
+/* reports a HALT instruction executed in the
+   simulation; an IN at the end of the input
+   halts silently */
+void writeHalt (void)
+{ INSTRUCTION * in;
+  int loc = tm->reg[PC_REG] - 1;
+  if (loc < 0 || loc >= prog->iSize) return;
+  in = &prog->iMem[loc];
+  if (in->iop == opHALT)
+    printf("HALT: %1d,%1d,%1d\n", in->iarg1, in->iarg2, in->iarg3);
+} /* writeHalt */
 
 /********************************************/
-int readInstructions (void)
-{ OPCODE op;
-  int arg1, arg2, arg3;
-  int loc, regNo, lineNo;
-  for (regNo = 0 ; regNo < NO_REGS ; regNo++)
-      reg[regNo] = 0 ;
-  dMem[0] = DADDR_SIZE - 1 ;
-  for (loc = 1 ; loc < DADDR_SIZE ; loc++)
-      dMem[loc] = 0 ;
-  for (loc = 0 ; loc < IADDR_SIZE ; loc++)
-  { iMem[loc].iop = opHALT ;
-    iMem[loc].iarg1 = 0 ;
-    iMem[loc].iarg2 = 0 ;
-    iMem[loc].iarg3 = 0 ;
+/* The binary trace (-tFILE) records each step
+   of tmStep as a TmtRecord (tmtrace.h) in a
+   buffer. The buffer goes to the file whenever it
+   fills or, as a ring of N records (-ringN), is
+   overwritten so that it keeps the last N steps
+   until tm ends. The decoder tmtrace prints it */
+#define   TRACE_BUF  4096 /* records per write */
+
+char * traceName = NULL;
+int traceRing = 0;
+FILE * traceFile = NULL;
+TmtRecord * traceBuf = NULL;
+int traceSize = 0, traceLen = 0;
+int traceWrapped = FALSE;
+unsigned long long traceSteps = 0;
+STEPRESULT traceResult = srOKAY;
+
+/* creates the trace file; the header is written
+   when it is closed */
+int openTrace (void)
+{ TmtHeader h;
+  traceSize = traceRing > 0 ? traceRing : TRACE_BUF;
+  traceBuf = (TmtRecord *) malloc(traceSize * sizeof(TmtRecord));
+  traceFile = fopen(traceName, "wb");
+  if (traceBuf == NULL || traceFile == NULL) return FALSE;
+  memset(&h, 0, sizeof(h));
+  return fwrite(&h, sizeof(h), 1, traceFile) == 1;
+} /* openTrace */
+
+/* executes one step with tmStep and records it */
+STEPRESULT traceStep (void)
+{ TmtRecord * t;
+  INSTRUCTION * in;
+  int * reg = tm->reg;
+  int pc = reg[PC_REG];
+  STEPRESULT result;
+  if (traceLen == traceSize)
+  { if (traceRing > 0) traceWrapped = TRUE;
+    else fwrite(traceBuf, sizeof(TmtRecord), traceLen, traceFile);
+    traceLen = 0;
   }
-  lineNo = 0 ;
-  while (! feof(pgm))
-  { fgets( in_Line, LINESIZE-2, pgm  ) ;
-    inCol = 0 ; 
-    lineNo++;
-    lineLen = strlen(in_Line)-1 ;
-    if (in_Line[lineLen]=='\n') in_Line[lineLen] = '\0' ;
-    else in_Line[++lineLen] = '\0';
-    if ( (nonBlank()) && (in_Line[inCol] != '*') )
-    { if (! getNum())
-        return error("Bad location", lineNo,-1);
-      loc = num;
-      if (loc > IADDR_SIZE)
-        return error("Location too large",lineNo,loc);
-      if (! skipCh(':'))
-        return error("Missing colon", lineNo,loc);
-      if (! getWord ())
-        return error("Missing opcode", lineNo,loc);
-      op = opHALT ;
-      while ((op < opRALim)
-             && (strncmp(opCodeTab[op], word, 4) != 0) )
-          op++ ;
-      if (strncmp(opCodeTab[op], word, 4) != 0)
-          return error("Illegal opcode", lineNo,loc);
-      switch ( opClass(op) )
-      { case opclRR :
-        /***********************************/
-        if ( (! getNum ()) || (num < 0) || (num >= NO_REGS) )
-            return error("Bad first register", lineNo,loc);
-        arg1 = num;
-        if ( ! skipCh(','))
-            return error("Missing comma", lineNo, loc);
-        if ( (! getNum ()) || (num < 0) || (num >= NO_REGS) )
-            return error("Bad second register", lineNo, loc);
-        arg2 = num;
-        if ( ! skipCh(',')) 
-            return error("Missing comma", lineNo,loc);
-        if ( (! getNum ()) || (num < 0) || (num >= NO_REGS) )
-            return error("Bad third register", lineNo,loc);
-        arg3 = num;
-        break;
-
-        case opclRM :
-        case opclRA :
-        /***********************************/
-        if ( (! getNum ()) || (num < 0) || (num >= NO_REGS) )
-            return error("Bad first register", lineNo,loc);
-        arg1 = num;
-        if ( ! skipCh(','))
-            return error("Missing comma", lineNo,loc);
-        if (! getNum ())
-            return error("Bad displacement", lineNo,loc);
-        arg2 = num;
-        if ( ! skipCh('(') && ! skipCh(',') )
-            return error("Missing LParen", lineNo,loc);
-        if ( (! getNum ()) || (num < 0) || (num >= NO_REGS))
-            return error("Bad second register", lineNo,loc);
-        arg3 = num;
-        break;
-        }
-      iMem[loc].iop = op;
-      iMem[loc].iarg1 = arg1;
-      iMem[loc].iarg2 = arg2;
-      iMem[loc].iarg3 = arg3;
+  t = &traceBuf[traceLen++];
+  memset(t, 0, sizeof(TmtRecord));
+  t->pc = pc;
+  if (pc < 0 || pc >= prog->iSize) t->op = TMT_NOINSTR;
+  else
+  { in = &prog->iMem[pc];
+    t->op = in->iop;
+    t->r = in->iarg1;
+    if (opClass(in->iop) == opclRR)
+    { t->s = in->iarg2;
+      t->t = in->iarg3;
+      t->b = reg[t->t];
     }
+    else
+    { t->s = in->iarg3;
+      t->d = in->iarg2;
+    }
+    t->a = reg[t->s];
   }
-  return TRUE;
-} /* readInstructions */
-
+  result = tmStep (tm);
+  t->value = reg[t->r];
+  t->next = reg[PC_REG];
+  traceSteps++;
+  traceResult = result;
+  return result;
+} /* traceStep */
+
+/* writes the rest of the trace and its header */
+void closeTrace (void)
+{ TmtHeader h;
+  if (traceWrapped)
+    fwrite(traceBuf + traceLen, sizeof(TmtRecord), traceSize - traceLen,
+           traceFile);
+  fwrite(traceBuf, sizeof(TmtRecord), traceLen, traceFile);
+  memcpy(h.magic, TMT_MAGIC, 4);
+  h.version = TMT_VERSION;
+  h.count = traceRing > 0 ? (unsigned) (traceWrapped ? traceSize : traceLen)
+            : (unsigned) traceSteps;
+  h.result = traceResult;
+  h.steps = traceSteps;
+  fseek(traceFile, 0, SEEK_SET);
+  fwrite(&h, sizeof(h), 1, traceFile);
+  fclose(traceFile);
+  traceFile = NULL;
+} /* closeTrace */
+
+/* executes one step, traced with -tFILE */
+STEPRESULT step (void)
+{ return traceFile != NULL ? traceStep () : tmStep (tm);
+} /* step */
 
 /********************************************/
-STEPRESULT stepTM (void)
-{ INSTRUCTION currentinstruction  ;
-  int pc  ;
-  int r,s,t,m  ;
-  int ok ;
-
-  pc = reg[PC_REG] ;
-  if ( (pc < 0) || (pc > IADDR_SIZE)  )
-      return srIMEM_ERR ;
-  reg[PC_REG] = pc + 1 ;
-  currentinstruction = iMem[ pc ] ;
-  switch (opClass(currentinstruction.iop) )
-  { case opclRR :
-    /***********************************/
-      r = currentinstruction.iarg1 ;
-      s = currentinstruction.iarg2 ;
-      t = currentinstruction.iarg3 ;
-      break;
+/* prints the fusions and their executions, and
+   the checks the verifier dropped, to f */
+void writeFuseStats (FILE * f)
+{ int i;
+  fprintf(f, "\n%-10s %10s %14s\n", "fused", "locations", "executions");
+  for (i = 0 ; i < TM_FUSED ; i++)
+    if (prog->fuseSites[i] > 0)
+      fprintf(f, "%-10s %10lu %14lu\n", fuseName[i], prog->fuseSites[i],
+              tm->fuseHits[i]);
+  fprintf(f, "\nunchecked: %d jumps, %d dMem accesses", prog->provenJumps,
+          prog->provenAccesses);
+  if (prog->constHigh >= 0)
+    fprintf(f, " (addresses up to %d%s)", prog->constHigh,
+            prog->constHigh < tm->dSize ? "" : ", beyond dMem: checked");
+  fprintf(f, "\n");
+} /* writeFuseStats */
 
-    case opclRM :
-    /***********************************/
-      r = currentinstruction.iarg1 ;
-      s = currentinstruction.iarg3 ;
-      m = currentinstruction.iarg2 + reg[s] ;
-      if ( (m < 0) || (m > DADDR_SIZE))
-         return srDMEM_ERR ;
-      break;
-
-    case opclRA :
-    /***********************************/
-      r = currentinstruction.iarg1 ;
-      s = currentinstruction.iarg3 ;
-      m = currentinstruction.iarg2 + reg[s] ;
-      break;
-  } /* case */
-
-  switch ( currentinstruction.iop)
-  { /* RR instructions */
-    case opHALT :
-    /***********************************/
-      printf("HALT: %1d,%1d,%1d\n",r,s,t);
-      return srHALT ;
-      /* break; */
+/********************************************/
+/* The profiler (-prof) runs the program with
+   tmStep, which counts the executions of each
+   location, the jumps taken and the reads and
+   writes of each dMem location. The report goes
+   to stderr when tm ends; an object file with a
+   line and function table lets it charge the
+   counts to source lines and functions */
+#define   PROF_TOP  20 /* entries of the ranked lists */
+
+/* returns the function holding location loc, NULL
+   if unknown */
+char * funcName (int loc)
+{ TmoFunc * funcTab = prog->funcTab;
+  int lo = 0, hi = prog->funcCount - 1, mid;
+  if (prog->funcCount == 0 || loc < funcTab[0].loc) return NULL;
+  while (lo < hi)
+  { mid = (lo + hi + 1) / 2;
+    if (funcTab[mid].loc <= loc) lo = mid;
+    else hi = mid - 1;
+  }
+  return funcTab[lo].name;
+} /* funcName */
+
+/* puts into top[] the indices of the (at most k)
+   largest non-zero key[0..n-1], largest first, and
+   returns their number */
+int topCounts (unsigned long * key, int n, int * top, int k)
+{ int i, j, found = 0;
+  for (i = 0 ; i < n ; i++)
+  { if (key[i] == 0) continue;
+    if (found == k && key[i] <= key[top[k-1]]) continue;
+    if (found < k) found++;
+    for (j = found - 1 ; j > 0 && key[top[j-1]] < key[i] ; j--)
+      top[j] = top[j-1];
+    top[j] = i;
+  }
+  return found;
+} /* topCounts */
+
+/* returns the target of the loop closed by the
+   jump at loc, -1 if it is no backward jump. A
+   jump after LDA r,1(7) is a call */
+int loopStart (int loc)
+{ INSTRUCTION * iMem = prog->iMem;
+  INSTRUCTION * in = &iMem[loc];
+  int target;
+  if (in->iarg3 != PC_REG || in->iop < opLDA) return -1;
+  if (in->iop == opLDA && in->iarg1 != PC_REG) return -1;
+  if (in->iop == opLDC) return -1;
+  target = loc + 1 + in->iarg2;
+  if (target < 0 || target > loc) return -1;
+  if (loc > 0 && iMem[loc-1].iop == opLDA && iMem[loc-1].iarg2 == 1
+      && iMem[loc-1].iarg3 == PC_REG) return -1;
+  return target;
+} /* loopStart */
+
+/* writes the profile report to f */
+void writeProfile (FILE * f)
+{ INSTRUCTION * iMem = prog->iMem;
+  int iSize = prog->iSize;
+  int * lineTab = prog->lineTab;
+  TmoFunc * funcTab = prog->funcTab;
+  int funcCount = prog->funcCount;
+  PROFCOUNT * profCount = tm->profCount;
+  unsigned long * dReads = tm->dReads, * dWrites = tm->dWrites;
+  unsigned long total = 0, reads = 0, writes = 0;
+  unsigned long * key, * sum;
+  int * top, * lineLoc;
+  int n, i, loc, line, maxLine = 0, size;
+  char buf[48], * name;
+  size = iSize > dSize ? iSize : dSize;
+  if (funcCount > size) size = funcCount;
+  key = (unsigned long *) calloc(size + 1, sizeof(unsigned long));
+  sum = (unsigned long *) calloc(iSize + 1, sizeof(unsigned long));
+  top = (int *) malloc((size + 1) * sizeof(int));
+  if (key == NULL || sum == NULL || top == NULL)
+  { fprintf(f, "no memory for the profile report\n");
+    return;
+  }
+  /* sum[loc] counts the executions before loc */
+  for (loc = 0 ; loc < iSize ; loc++)
+  { total += profCount[loc].exec;
+    sum[loc+1] = total;
+  }
+  for (i = 0 ; i < dSize ; i++)
+  { reads += dReads[i];
+    writes += dWrites[i];
+  }
+  if (total == 0) total = 1;
+  fprintf(f, "\nProfile of %s: %lu instructions, %lu dMem reads, "
+          "%lu dMem writes\n", pgmName, sum[iSize], reads, writes);
+
+  if (funcCount > 0)
+  { for (i = 0 ; i < funcCount ; i++)
+      key[i] = sum[i + 1 < funcCount ? funcTab[i+1].loc : iSize]
+               - sum[funcTab[i].loc];
+    n = topCounts(key, funcCount, top, funcCount);
+    fprintf(f, "\nFunctions:\n%14s %7s  %s\n", "instructions", "%", "function");
+    for (i = 0 ; i < n ; i++)
+      fprintf(f, "%14lu %6.2f%%  %s\n", key[top[i]],
+              100.0 * key[top[i]] / total, funcTab[top[i]].name);
+  }
 
-    case opIN :
-    /***********************************/
-      do
-      { printf("Enter value for IN instruction: ") ;
-        fflush (stdin);
-        fflush (stdout);
-        gets(in_Line);
-        lineLen = strlen(in_Line) ;
-        inCol = 0;
-        ok = getNum();
-        if ( ! ok ) printf ("Illegal value\n");
-        else reg[r] = num;
-      }
-      while (! ok);
-      break;
+  if (lineTab != NULL)
+  { for (loc = 0 ; loc < iSize ; loc++)
+      if (lineTab[loc] > maxLine) maxLine = lineTab[loc];
+    free(key);
+    key = (unsigned long *) calloc(maxLine + 1, sizeof(unsigned long));
+    lineLoc = (int *) malloc((maxLine + 1) * sizeof(int));
+    free(top);
+    top = (int *) malloc((size > maxLine ? size + 1 : maxLine + 1) * sizeof(int));
+    if (key == NULL || lineLoc == NULL || top == NULL)
+    { fprintf(f, "no memory for the profile report\n");
+      return;
+    }
+    for (line = 0 ; line <= maxLine ; line++) lineLoc[line] = -1;
+    for (loc = 0 ; loc < iSize ; loc++)
+    { line = lineTab[loc];
+      if (line <= 0) continue;
+      key[line] += profCount[loc].exec;
+      if (lineLoc[line] < 0) lineLoc[line] = loc;
+    }
+    n = topCounts(key, maxLine + 1, top, PROF_TOP);
+    fprintf(f, "\nSource lines:\n%6s %14s %7s  %s\n",
+            "line", "instructions", "%", "function");
+    for (i = 0 ; i < n ; i++)
+    { name = funcName(lineLoc[top[i]]);
+      fprintf(f, "%6d %14lu %6.2f%%  %s\n", top[i], key[top[i]],
+              100.0 * key[top[i]] / total, name != NULL ? name : "");
+    }
+    free(lineLoc);
+    free(key);
+    key = (unsigned long *) calloc(size + 1, sizeof(unsigned long));
+    if (key == NULL) return;
+  }
 
-    case opOUT :  
-      printf ("OUT instruction prints: %d\n", reg[r] ) ;
-      break;
-    case opADD :  reg[r] = reg[s] + reg[t] ;  break;
-    case opSUB :  reg[r] = reg[s] - reg[t] ;  break;
-    case opMUL :  reg[r] = reg[s] * reg[t] ;  break;
+  for (loc = 0 ; loc < iSize ; loc++) key[loc] = profCount[loc].exec;
+  n = topCounts(key, iSize, top, PROF_TOP);
+  fprintf(f, "\nInstructions:\n%6s %14s %7s  %-22s %s\n",
+          "loc", "count", "%", "instruction", "taken");
+  for (i = 0 ; i < n ; i++)
+  { loc = top[i];
+    formatInstruction(buf, loc);
+    fprintf(f, "%6d %14lu %6.2f%%  %-22s", loc, key[loc],
+            100.0 * key[loc] / total, buf);
+    if (iMem[loc].iop >= opJLT)
+      fprintf(f, " %lu/%lu", profCount[loc].taken, key[loc]);
+    if (lineTab != NULL && lineTab[loc] > 0)
+      fprintf(f, "   line %d", lineTab[loc]);
+    fprintf(f, "\n");
+  }
 
-    case opDIV :
-    /***********************************/
-      if ( reg[t] != 0 ) reg[r] = reg[s] / reg[t];
-      else return srZERODIVIDE ;
-      break;
+  /* a loop is charged the instructions from its
+     start to its backward jump */
+  for (loc = 0 ; loc < iSize ; loc++)
+  { key[loc] = 0;
+    i = loopStart(loc);
+    if (i >= 0 && profCount[loc].exec > 0) key[loc] = sum[loc+1] - sum[i];
+  }
+  n = topCounts(key, iSize, top, PROF_TOP);
+  if (n > 0)
+  { fprintf(f, "\nLoops:\n%6s %6s %14s %14s %7s  %s\n",
+            "start", "end", "iterations", "instructions", "%", "where");
+    for (i = 0 ; i < n ; i++)
+    { loc = top[i];
+      fprintf(f, "%6d %6d %14lu %14lu %6.2f%%  ", loopStart(loc), loc,
+              iMem[loc].iop == opLDA ? profCount[loc].exec
+                                     : profCount[loc].taken,
+              key[loc], 100.0 * key[loc] / total);
+      name = funcName(loc);
+      if (name != NULL) fprintf(f, "%s ", name);
+      if (lineTab != NULL && lineTab[loc] > 0)
+        fprintf(f, "line %d", lineTab[loc]);
+      fprintf(f, "\n");
+    }
+  }
 
-    /*************** RM instructions ********************/
-    case opLD :    reg[r] = dMem[m] ;  break;
-    case opST :    dMem[m] = reg[r] ;  break;
-
-    /*************** RA instructions ********************/
-    case opLDA :    reg[r] = m ; break;
-    case opLDC :    reg[r] = currentinstruction.iarg2 ;   break;
-    case opJLT :    if ( reg[r] <  0 ) reg[PC_REG] = m ; break;
-    case opJLE :    if ( reg[r] <=  0 ) reg[PC_REG] = m ; break;
-    case opJGT :    if ( reg[r] >  0 ) reg[PC_REG] = m ; break;
-    case opJGE :    if ( reg[r] >=  0 ) reg[PC_REG] = m ; break;
-    case opJEQ :    if ( reg[r] == 0 ) reg[PC_REG] = m ; break;
-    case opJNE :    if ( reg[r] != 0 ) reg[PC_REG] = m ; break;
-
-    /* end of legal instructions */
-  } /* case */
-  return srOKAY ;
-} /* stepTM */
+  for (i = 0 ; i < dSize ; i++) key[i] = dReads[i] + dWrites[i];
+  n = topCounts(key, dSize, top, PROF_TOP);
+  if (n > 0)
+  { fprintf(f, "\nData:\n%10s %14s %14s\n", "loc", "reads", "writes");
+    for (i = 0 ; i < n ; i++)
+      fprintf(f, "%10d %14lu %14lu\n", top[i], dReads[top[i]],
+              dWrites[top[i]]);
+  }
+  free(key);
+  free(sum);
+  free(top);
+} /* writeProfile */
 
 /********************************************/
 int doCommand (void)
-{ char cmd;
+{ char c;
   int stepcnt=0, i;
   int printcnt;
   int stepResult;
-  int regNo, loc;
   do
   { printf ("Enter command: ");
     fflush (stdin);
     fflush (stdout);
-    gets(in_Line);
-    lineLen = strlen(in_Line);
-    inCol = 0;
+    if (! readLine()) return FALSE ;
   }
-  while (! getWord ());
+  while (! tmGetWord (&cmd));
 
-  cmd = word[0] ;
-  switch ( cmd )
+  c = cmd.word[0] ;
+  switch ( c )
   { case 't' :
     /***********************************/
       traceflag = ! traceflag ;
@@ -457,8 +482,8 @@ int doCommand (void)
 
     case 's' :
     /***********************************/
-      if ( atEOL ())  stepcnt = 1;
-      else if ( getNum ())  stepcnt = abs(num);
+      if ( tmAtEOL (&cmd))  stepcnt = 1;
+      else if ( tmGetNum (&cmd))  stepcnt = abs(cmd.num);
       else   printf("Step count?\n");
       break;
 
@@ -467,7 +492,7 @@ int doCommand (void)
     case 'r' :
     /***********************************/
       for (i = 0; i < NO_REGS; i++)
-      { printf("%1d: %4d    ", i,reg[i]);
+      { printf("%1d: %4d    ", i,tm->reg[i]);
         if ( (i % 4) == 3 ) printf ("\n");
       }
       break;
@@ -475,14 +500,14 @@ int doCommand (void)
     case 'i' :
     /***********************************/
       printcnt = 1 ;
-      if ( getNum ())
-      { iloc = num ;
-        if ( getNum ()) printcnt = num ;
+      if ( tmGetNum (&cmd))
+      { iloc = cmd.num ;
+        if ( tmGetNum (&cmd)) printcnt = cmd.num ;
       }
-      if ( ! atEOL ())
+      if ( ! tmAtEOL (&cmd))
         printf ("Instruction locations?\n");
       else
-      { while ((iloc >= 0) && (iloc < IADDR_SIZE)
+      { while ((iloc >= 0) && (iloc < prog->iSize)
                 && (printcnt > 0) )
         { writeInstruction(iloc);
           iloc++ ;
@@ -494,16 +519,16 @@ int doCommand (void)
     case 'd' :
     /***********************************/
       printcnt = 1 ;
-      if ( getNum  ())
-      { dloc = num ;
-        if ( getNum ()) printcnt = num ;
+      if ( tmGetNum (&cmd))
+      { dloc = cmd.num ;
+        if ( tmGetNum (&cmd)) printcnt = cmd.num ;
       }
-      if ( ! atEOL ())
+      if ( ! tmAtEOL (&cmd))
         printf("Data locations?\n");
       else
-      { while ((dloc >= 0) && (dloc < DADDR_SIZE)
+      { while ((dloc >= 0) && (dloc < tm->dSize)
                   && (printcnt > 0))
-        { printf("%5d: %5d\n",dloc,dMem[dloc]);
+        { printf("%5d: %5d\n",dloc,tm->dMem[dloc]);
           dloc++;
           printcnt--;
         }
@@ -515,37 +540,38 @@ int doCommand (void)
       iloc = 0;
       dloc = 0;
       stepcnt = 0;
-      for (regNo = 0;  regNo < NO_REGS ; regNo++)
-            reg[regNo] = 0 ;
-      dMem[0] = DADDR_SIZE - 1 ;
-      for (loc = 1 ; loc < DADDR_SIZE ; loc++)
-            dMem[loc] = 0 ;
+      if (! (start != NULL ? tmRestore (tm, start) : tmReset (tm)))
+        return FALSE;
       break;
 
     case 'q' : return FALSE;  /* break; */
 
-    default : printf("Command %c unknown.\n", cmd); break;
+    default : printf("Command %c unknown.\n", c); break;
   }  /* case */
   stepResult = srOKAY;
   if ( stepcnt > 0 )
-  { if ( cmd == 'g' )
+  { if ( c == 'g' )
     { stepcnt = 0;
-      while (stepResult == srOKAY)
-      { iloc = reg[PC_REG] ;
+      if ( ! traceflag && ! refflag && ! profflag && traceFile == NULL )
+        stepResult = tmRun (tm, &stepcnt);
+      else while (stepResult == srOKAY)
+      { iloc = tm->reg[PC_REG] ;
         if ( traceflag ) writeInstruction( iloc ) ;
-        stepResult = stepTM ();
+        stepResult = step ();
         stepcnt++;
       }
+      if ( stepResult == srHALT ) writeHalt ();
       if ( icountflag )
         printf("Number of instructions executed = %d\n",stepcnt);
     }
     else
     { while ((stepcnt > 0) && (stepResult == srOKAY))
-      { iloc = reg[PC_REG] ;
+      { iloc = tm->reg[PC_REG] ;
         if ( traceflag ) writeInstruction( iloc ) ;
-        stepResult = stepTM ();
+        stepResult = step ();
         stepcnt-- ;
       }
+      if ( stepResult == srHALT ) writeHalt ();
     }
     printf( "%s\n",stepResultTab[stepResult] );
   }
@@ -553,27 +579,168 @@ int doCommand (void)
 } /* doCommand */
 
 
+/********************************************/
+/* runs the program to the end without prompts
+   (-run), or for atSteps steps (-atN), and returns
+   the exit status: 0 after HALT or atSteps steps,
+   else the STEPRESULT of the fault */
+int runBatch (void)
+{ STEPRESULT stepResult = srOKAY;
+  int stepcnt = 0;
+  if (refflag || profflag || traceFile != NULL)
+    while (stepResult == srOKAY && (atSteps == 0 || stepcnt < atSteps))
+    { stepResult = step ();
+      stepcnt++;
+    }
+  else if (atSteps > 0) stepResult = tmRunSteps (tm, atSteps, &stepcnt);
+  else stepResult = tmRun (tm, &stepcnt);
+  tmFlush (&batchIO);
+  if (stepResult == srOKAY)
+    fprintf(stderr, "Stopped after %llu steps\n", tm->steps);
+  if (stepResult == srOKAY || stepResult == srHALT) return 0;
+  /* a faulting instruction has advanced the pc */
+  fprintf(stderr, "%s at location %d\n", stepResultTab[stepResult],
+          stepResult == srIMEM_ERR ? tm->reg[PC_REG] : tm->reg[PC_REG] - 1);
+  return stepResult;
+} /* runBatch */
+
+/********************************************/
+/* A checkpoint (tmckpt.h) holds the registers,
+   dMem, the steps run and, with -run, the bytes of
+   standard input read. -restoreFILE goes on from
+   it: -run skips the input read before, and the
+   c(lear command of the simulation goes back to
+   it. -saveFILE writes one when tm ends */
+
+/* reads the checkpoint restoreName into start */
+int loadCheckpoint (void)
+{ FILE * f = fopen(restoreName, "rb");
+  if (f == NULL)
+  { printf("file '%s' not found\n", restoreName);
+    return FALSE;
+  }
+  start = tmLoadSnapshot (prog, f, restoreName);
+  fclose(f);
+  return start != NULL;
+} /* loadCheckpoint */
+
+/* writes the checkpoint saveName; returns FALSE
+   if it cannot */
+int saveCheckpoint (void)
+{ TmSnapshot * s = tmSnapshot (tm);
+  FILE * f;
+  int ok;
+  if (s == NULL) return FALSE;
+  s->inPos = batchflag ? tmStreamsPos (&batchIO) : 0;
+  f = fopen(saveName, "wb");
+  ok = f != NULL && tmSaveSnapshot (s, f);
+  if (f != NULL && fclose(f) != 0) ok = FALSE;
+  tmFreeSnapshot (s);
+  if (! ok) printf("cannot write checkpoint file %s\n", saveName);
+  return ok;
+} /* saveCheckpoint */
+
+/********************************************/
+/* sets dSize from option text "N", "Nk", "NM" or
+   "NG" (locations); returns FALSE if it is bad */
+int setDSize (char * text)
+{ char * end;
+  double n = strtod(text, &end);
+  if (end == text) return FALSE;
+  switch (*end)
+  { case 'k' : case 'K' : n *= 1024.0; end++; break;
+    case 'm' : case 'M' : n *= 1024.0 * 1024.0; end++; break;
+    case 'g' : case 'G' : n *= 1024.0 * 1024.0 * 1024.0; end++; break;
+  }
+  /* 2G is taken as the largest int */
+  if (*end != '\0' || n < 8 || n > (double) INT_MAX + 1.0) return FALSE;
+  dSize = n > (double) INT_MAX ? INT_MAX : (int) n;
+  return TRUE;
+} /* setDSize */
+
 /********************************************/
 /* E X E C U T I O N   B E G I N S   H E R E */
 /********************************************/
 
 main( int argc, char * argv[] )
-{ if (argc != 2)
-  { printf("usage: %s <filename>\n",argv[0]);
+{ int argi = 1, status;
+  while (argi < argc && argv[argi][0] == '-')
+  { if (strcmp(argv[argi],"-ref") == 0) refflag = TRUE;
+    else if (strcmp(argv[argi],"-run") == 0) batchflag = TRUE;
+    else if (strcmp(argv[argi],"-prof") == 0) profflag = TRUE;
+    else if (strcmp(argv[argi],"-nofuse") == 0) fuseflag = FALSE;
+    else if (strcmp(argv[argi],"-fstats") == 0) fstatsflag = TRUE;
+    else if (strncmp(argv[argi],"-at",3) == 0 && atoi(argv[argi]+3) > 0)
+      atSteps = atoi(argv[argi]+3);
+    else if (strncmp(argv[argi],"-save",5) == 0 && argv[argi][5] != '\0')
+      saveName = argv[argi]+5;
+    else if (strncmp(argv[argi],"-restore",8) == 0 && argv[argi][8] != '\0')
+      restoreName = argv[argi]+8;
+    else if (strncmp(argv[argi],"-ring",5) == 0 && atoi(argv[argi]+5) > 0)
+      traceRing = atoi(argv[argi]+5);
+    else if (strncmp(argv[argi],"-t",2) == 0 && argv[argi][2] != '\0')
+      traceName = argv[argi]+2;
+#ifdef HAVE_MMAP
+    else if (strcmp(argv[argi],"-mmap") == 0) mmapflag = TRUE;
+#endif
+    else if (strncmp(argv[argi],"-d",2) == 0)
+    { if (! setDSize(argv[argi]+2)) break;
+    }
+    else break;
+    argi++;
+  }
+  if (argi != argc-1 || strlen(argv[argi]) + 4 > sizeof(pgmName))
+  { printf("usage: %s [-ref] [-run [-atN]] [-prof] [-tFILE [-ringN]]\n"
+         "       [-nofuse] [-fstats] [-dN[kMG]] [-mmap]\n"
+         "       [-saveFILE] [-restoreFILE] <filename>\n",argv[0]);
     exit(1);
   }
-  strcpy(pgmName,argv[1]) ;
+  strcpy(pgmName,argv[argi]) ;
   if (strchr (pgmName, '.') == NULL)
      strcat(pgmName,".tm");
-  pgm = fopen(pgmName,"r");
-  if (pgm == NULL)
-  { printf("file '%s' not found\n",pgmName);
+  prog = tmLoad(pgmName, fuseflag);
+  if (prog == NULL) exit(1);
+  /* a checkpoint brings its dMem size */
+  if (restoreName != NULL)
+  { if (! loadCheckpoint ()) exit(1);
+    dSize = start->dSize;
+  }
+  tm = tmNew(prog, dSize, mmapflag);
+  if (tm == NULL) exit(1);
+  if (start != NULL && ! tmRestore (tm, start))
+  { printf("cannot restore %s\n", restoreName);
     exit(1);
   }
-
-  /* read the program */
-  if ( ! readInstructions ())
-         exit(1) ;
+  if (batchflag)
+  { tmStreamsInit(&batchIO, stdin, stdout);
+    tm->in = tmReadInt;
+    tm->out = tmWriteInt;
+    tm->ctx = &batchIO;
+    if (start != NULL && ! tmStreamsSkip (&batchIO, start->inPos))
+    { printf("input shorter than at checkpoint %s\n", restoreName);
+      exit(1);
+    }
+  }
+  else
+  { tm->in = promptIn;
+    tm->out = printOut;
+  }
+  if (profflag && ! tmProfile (tm))
+  { printf("cannot allocate the profile\n");
+    exit(1);
+  }
+  if (traceName != NULL && ! openTrace ())
+  { printf("cannot write trace file %s\n", traceName);
+    exit(1);
+  }
+  if (batchflag)
+  { status = runBatch () ;
+    if (saveName != NULL && ! saveCheckpoint () && status == 0) status = 1;
+    if (traceFile != NULL) closeTrace () ;
+    if (profflag) writeProfile (stderr) ;
+    if (fstatsflag) writeFuseStats (stderr) ;
+    return status;
+  }
   /* switch input file to terminal */
   /* reset( input ); */
   /* read-eval-print */
@@ -582,5 +749,9 @@ main( int argc, char * argv[] )
      done = ! doCommand ();
   while (! done );
   printf("Simulation done.\n");
+  if (saveName != NULL) saveCheckpoint () ;
+  if (traceFile != NULL) closeTrace () ;
+  if (profflag) writeProfile (stderr) ;
+  if (fstatsflag) writeFuseStats (stderr) ;
   return 0;
 }
@@ -0,0 +1,36 @@
+/****************************************************/
+/* File: tmckpt.h                                   */
+/* Checkpoint of a TM machine, written by tm        */
+/* (-saveFILE) and resumed by tm (-restoreFILE)     */
+/* and tmrun (-cFILE)                               */
+/****************************************************/
+
+#ifndef _TMCKPT_H_
+#define _TMCKPT_H_
+
+/* A checkpoint file holds, in the byte order of
+ * the machine that wrote it, a TmcHeader and runs
+ * TmcRun, each followed by its count dMem values.
+ * The dMem locations outside the runs hold 0
+ */
+#define TMC_MAGIC    "TMC\032"
+#define TMC_VERSION  1
+
+typedef struct
+   { char magic[4];     /* TMC_MAGIC */
+     unsigned version;  /* TMC_VERSION */
+     unsigned program;  /* hash of the iMem of the program */
+     int iSize;         /* locations of the program */
+     int dSize;         /* dMem locations */
+     unsigned runs;     /* number of runs of dMem values */
+     int reg[8];        /* registers, reg(7) the pc */
+     unsigned long long steps; /* steps run so far */
+     long long inPos;   /* bytes of input read so far */
+   } TmcHeader;
+
+typedef struct
+   { int start;         /* first dMem location */
+     int count;         /* number of values */
+   } TmcRun;
+
+#endif
@@ -0,0 +1,1312 @@
+/****************************************************/
+/* File: tmlib.c                                    */
+/* The TM ("Tiny Machine") as a library             */
+/* Compiler Construction: Principles and Practice   */
+/* Kenneth C. Louden                                */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define HAVE_MMAP 1
+#endif
+#include "tmlib.h"
+#include "tmckpt.h"
+
+char * opCodeTab[]
+        = {"HALT","IN","OUT","ADD","SUB","MUL","DIV","????",
+            /* RR opcodes */
+           "LD","ST","????", /* RM opcodes */
+           "LDA","LDC","JLT","JLE","JGT","JGE","JEQ","JNE","????"
+           /* RA opcodes */
+          };
+
+char * stepResultTab[]
+        = {"OK","Halted","Instruction Memory Fault",
+           "Data Memory Fault","Division by 0","Illegal value"
+          };
+
+char * fuseName[TM_FUSED]
+        = {"ST;LD", "LD;LD", "LDC;ADD", "LDC;SUB",
+           "SUB;JLT", "SUB;JLE", "SUB;JGT", "SUB;JGE", "SUB;JEQ", "SUB;JNE",
+           "compare"
+          };
+
+/********************************************/
+int opClass( int c )
+{ if      ( c <= opRRLim) return ( opclRR );
+  else if ( c <= opRMLim) return ( opclRM );
+  else                    return ( opclRA );
+} /* opClass */
+
+/********************************************/
+/* starts scanner s on a copy of text */
+void tmScanLine (TmScanner * s, const char * text)
+{ strncpy(s->line, text, LINESIZE - 1);
+  s->line[LINESIZE-1] = '\0';
+  s->len = strlen(s->line);
+  s->col = 0;
+} /* tmScanLine */
+
+/********************************************/
+static void getCh (TmScanner * s)
+{ if (++s->col < s->len)
+  s->ch = s->line[s->col] ;
+  else s->ch = ' ' ;
+} /* getCh */
+
+/********************************************/
+int tmNonBlank (TmScanner * s)
+{ while ((s->col < s->len)
+         && (s->line[s->col] == ' ') )
+    s->col++ ;
+  if (s->col < s->len)
+  { s->ch = s->line[s->col] ;
+    return TRUE ; }
+  else
+  { s->ch = ' ' ;
+    return FALSE ; }
+} /* tmNonBlank */
+
+/********************************************/
+int tmGetNum (TmScanner * s)
+{ int sign;
+  int term;
+  int temp = FALSE;
+  s->num = 0 ;
+  do
+  { sign = 1;
+    while ( tmNonBlank(s) && ((s->ch == '+') || (s->ch == '-')) )
+    { temp = FALSE ;
+      if (s->ch == '-')  sign = - sign ;
+      getCh(s);
+    }
+    term = 0 ;
+    tmNonBlank(s);
+    while (isdigit(s->ch))
+    { temp = TRUE ;
+      term = term * 10 + ( s->ch - '0' ) ;
+      getCh(s);
+    }
+    s->num = s->num + (term * sign) ;
+  } while ( (tmNonBlank(s)) && ((s->ch == '+') || (s->ch == '-')) ) ;
+  return temp;
+} /* tmGetNum */
+
+/********************************************/
+int tmGetWord (TmScanner * s)
+{ int temp = FALSE;
+  int length = 0;
+  if (tmNonBlank (s))
+  { while (isalnum(s->ch))
+    { if (length < WORDSIZE-1) s->word [length++] =  s->ch ;
+      getCh(s) ;
+    }
+    s->word[length] = '\0';
+    temp = (length != 0);
+  }
+  return temp;
+} /* tmGetWord */
+
+/********************************************/
+int tmSkipCh (TmScanner * s, char c)
+{ int temp = FALSE;
+  if ( tmNonBlank(s) && (s->ch == c) )
+  { getCh(s);
+    temp = TRUE;
+  }
+  return temp;
+} /* tmSkipCh */
+
+/********************************************/
+int tmAtEOL (TmScanner * s)
+{ return ( ! tmNonBlank (s));
+} /* tmAtEOL */
+
+/********************************************/
+static int error( char * msg, int lineNo, int instNo)
+{ printf("Line %d",lineNo);
+  if (instNo >= 0) printf(" (Instruction %d)",instNo);
+  printf("   %s\n",msg);
+  return FALSE;
+} /* error */
+
+/********************************************/
+/* makes iMem hold location loc; new locations
+   are HALT 0,0,0 */
+static int growIMem (TmProgram * p, int loc)
+{ int size = p->iCapacity > 0 ? p->iCapacity : 1024;
+  INSTRUCTION * mem;
+  if (loc < p->iSize) return TRUE;
+  if (loc >= p->iCapacity)
+  { while (size <= loc) size *= 2;
+    mem = (INSTRUCTION *) realloc(p->iMem, size * sizeof(INSTRUCTION));
+    if (mem == NULL) return FALSE;
+    p->iMem = mem;
+    p->iCapacity = size;
+  }
+  memset(p->iMem + p->iSize, 0, (loc + 1 - p->iSize) * sizeof(INSTRUCTION));
+  p->iSize = loc + 1;
+  return TRUE;
+} /* growIMem */
+
+/********************************************/
+static int readInstructions (TmProgram * p, FILE * pgm)
+{ OPCODE op;
+  int arg1, arg2, arg3;
+  int loc, lineNo;
+  TmScanner sc, * s = &sc;
+  char * in_Line = s->line;
+  p->iSize = 0;
+  lineNo = 0 ;
+  while (! feof(pgm))
+  { fgets( in_Line, LINESIZE-2, pgm  ) ;
+    s->col = 0 ; 
+    lineNo++;
+    s->len = strlen(in_Line)-1 ;
+    if (in_Line[s->len]=='\n') in_Line[s->len] = '\0' ;
+    else in_Line[++s->len] = '\0';
+    if ( (tmNonBlank(s)) && (in_Line[s->col] != '*') )
+    { if (! tmGetNum(s))
+        return error("Bad location", lineNo,-1);
+      loc = s->num;
+      if (loc < 0)
+        return error("Bad location", lineNo,loc);
+      if (loc > IADDR_MAX)
+        return error("Location too large",lineNo,loc);
+      if (! tmSkipCh(s,':'))
+        return error("Missing colon", lineNo,loc);
+      if (! tmGetWord (s))
+        return error("Missing opcode", lineNo,loc);
+      op = opHALT ;
+      while ((op < opRALim)
+             && (strncmp(opCodeTab[op], s->word, 4) != 0) )
+          op++ ;
+      if (strncmp(opCodeTab[op], s->word, 4) != 0)
+          return error("Illegal opcode", lineNo,loc);
+      switch ( opClass(op) )
+      { case opclRR :
+        /***********************************/
+        if ( (! tmGetNum (s)) || (s->num < 0) || (s->num >= NO_REGS) )
+            return error("Bad first register", lineNo,loc);
+        arg1 = s->num;
+        if ( ! tmSkipCh(s,','))
+            return error("Missing comma", lineNo, loc);
+        if ( (! tmGetNum (s)) || (s->num < 0) || (s->num >= NO_REGS) )
+            return error("Bad second register", lineNo, loc);
+        arg2 = s->num;
+        if ( ! tmSkipCh(s,',')) 
+            return error("Missing comma", lineNo,loc);
+        if ( (! tmGetNum (s)) || (s->num < 0) || (s->num >= NO_REGS) )
+            return error("Bad third register", lineNo,loc);
+        arg3 = s->num;
+        break;
+
+        case opclRM :
+        case opclRA :
+        /***********************************/
+        if ( (! tmGetNum (s)) || (s->num < 0) || (s->num >= NO_REGS) )
+            return error("Bad first register", lineNo,loc);
+        arg1 = s->num;
+        if ( ! tmSkipCh(s,','))
+            return error("Missing comma", lineNo,loc);
+        if (! tmGetNum (s))
+            return error("Bad displacement", lineNo,loc);
+        arg2 = s->num;
+        if ( ! tmSkipCh(s,'(') && ! tmSkipCh(s,',') )
+            return error("Missing LParen", lineNo,loc);
+        if ( (! tmGetNum (s)) || (s->num < 0) || (s->num >= NO_REGS))
+            return error("Bad second register", lineNo,loc);
+        arg3 = s->num;
+        break;
+        }
+      if (! growIMem(p,loc))
+        return error("Out of memory",lineNo,loc);
+      p->iMem[loc].iop = op;
+      p->iMem[loc].iarg1 = arg1;
+      p->iMem[loc].iarg2 = arg2;
+      p->iMem[loc].iarg3 = arg3;
+    }
+  }
+  return TRUE;
+} /* readInstructions */
+
+/********************************************/
+/* loads a TM object file (tmobj.h). The file is
+   mapped and iMem points into it, so the loader
+   only checks each instruction */
+static int loadObject (TmProgram * p, FILE * pgm, const char * pgmName)
+{ TmoHeader h;
+  long size, want, funcs;
+  char * image;
+  TmoInstr * code;
+  int loc, funcCount;
+  if (fread(&h, sizeof(h), 1, pgm) != 1 || memcmp(h.magic, TMO_MAGIC, 4) != 0)
+  { printf("%s: not a TM object file\n", pgmName);
+    return FALSE;
+  }
+  if (h.version != TMO_VERSION)
+  { printf("%s: TM object version %u, expected %d\n",
+           pgmName, h.version, TMO_VERSION);
+    return FALSE;
+  }
+  if (h.count > IADDR_MAX + 1u)
+  { printf("%s: %u instructions, at most %d\n",
+           pgmName, h.count, IADDR_MAX + 1);
+    return FALSE;
+  }
+  want = (long) sizeof(h) + (long) h.count * sizeof(TmoInstr);
+  if (h.flags & TMO_LINES) want += (long) h.count * sizeof(int);
+  funcs = want;
+  funcCount = 0;
+  if (h.flags & TMO_FUNCS)
+  { fseek(pgm, funcs, SEEK_SET);
+    if (fread(&funcCount, sizeof(int), 1, pgm) != 1
+        || funcCount < 0 || funcCount > (int) h.count)
+    { printf("%s: bad function table\n", pgmName);
+      return FALSE;
+    }
+    want += sizeof(int) + (long) funcCount * sizeof(TmoFunc);
+  }
+  fseek(pgm, 0, SEEK_END);
+  size = ftell(pgm);
+  if (size < want)
+  { printf("%s: truncated TM object file\n", pgmName);
+    return FALSE;
+  }
+  image = NULL;
+#ifdef HAVE_MMAP
+  image = (char *) mmap(NULL, (size_t) want, PROT_READ, MAP_PRIVATE,
+                        fileno(pgm), 0);
+  if (image == (char *) MAP_FAILED) image = NULL;
+  else p->imageMapped = TRUE;
+#endif
+  if (image == NULL)
+  { image = (char *) malloc(want);
+    rewind(pgm);
+    if (image == NULL || fread(image, 1, want, pgm) != (size_t) want)
+    { printf("%s: cannot read TM object file\n", pgmName);
+      free(image);
+      return FALSE;
+    }
+  }
+  p->image = image;
+  p->imageSize = want;
+  code = (TmoInstr *) (image + sizeof(h));
+  for (loc = 0 ; loc < (int) h.count ; loc++)
+  { if (code[loc].op < 0 || code[loc].op >= opRALim
+        || code[loc].op == opRRLim || code[loc].op == opRMLim)
+    { printf("%s: illegal opcode %d at location %d\n",
+             pgmName, code[loc].op, loc);
+      return FALSE;
+    }
+    /* RR: registers r,a,b  RM and RA: r,d(b) */
+    if (code[loc].r < 0 || code[loc].r >= NO_REGS
+        || code[loc].b < 0 || code[loc].b >= NO_REGS
+        || (opClass(code[loc].op) == opclRR
+            && (code[loc].a < 0 || code[loc].a >= NO_REGS)))
+    { printf("%s: bad register at location %d\n", pgmName, loc);
+      return FALSE;
+    }
+  }
+  /* TmoInstr has the layout of INSTRUCTION */
+  p->iMem = (INSTRUCTION *) code;
+  p->iSize = h.count;
+  p->iCapacity = 0;
+  p->lineTab = h.flags & TMO_LINES ? (int *) (code + h.count) : NULL;
+  if (h.flags & TMO_FUNCS)
+  { TmoFunc * funcTab = (TmoFunc *) (image + funcs + sizeof(int));
+    p->funcTab = funcTab;
+    p->funcCount = funcCount;
+    for (loc = 0 ; loc < funcCount ; loc++)
+    { if (memchr(funcTab[loc].name, '\0', TMO_NAMESIZE) == NULL
+          || funcTab[loc].loc < 0 || funcTab[loc].loc > p->iSize
+          || (loc > 0 && funcTab[loc].loc < funcTab[loc-1].loc))
+      { printf("%s: bad function table\n", pgmName);
+        return FALSE;
+      }
+    }
+  }
+  return TRUE;
+} /* loadObject */
+
+/********************************************/
+STEPRESULT tmStep (TmMachine * tm)
+{ INSTRUCTION currentinstruction  ;
+  INSTRUCTION * iMem = tm->prog->iMem;
+  int iSize = tm->prog->iSize;
+  int * reg = tm->reg;
+  int * dMem = tm->dMem;
+  int dSize = tm->dSize;
+  int pc  ;
+  int r,s,t,m  ;
+
+  tm->steps++ ;
+  pc = reg[PC_REG] ;
+  if ( (pc < 0) || (pc >= iSize)  )
+      return srIMEM_ERR ;
+  reg[PC_REG] = pc + 1 ;
+  tm->lastLoc = pc ;
+  currentinstruction = iMem[ pc ] ;
+  if (tm->profCount != NULL) tm->profCount[pc].exec++ ;
+  switch (opClass(currentinstruction.iop) )
+  { case opclRR :
+    /***********************************/
+      r = currentinstruction.iarg1 ;
+      s = currentinstruction.iarg2 ;
+      t = currentinstruction.iarg3 ;
+      break;
+
+    case opclRM :
+    /***********************************/
+      r = currentinstruction.iarg1 ;
+      s = currentinstruction.iarg3 ;
+      m = currentinstruction.iarg2 + reg[s] ;
+      if ( (m < 0) || (m >= dSize))
+         return srDMEM_ERR ;
+      break;
+
+    case opclRA :
+    /***********************************/
+      r = currentinstruction.iarg1 ;
+      s = currentinstruction.iarg3 ;
+      m = currentinstruction.iarg2 + reg[s] ;
+      break;
+  } /* case */
+
+  switch ( currentinstruction.iop)
+  { /* RR instructions */
+    case opHALT :
+    /***********************************/
+      return srHALT ;
+      /* break; */
+
+    case opIN :
+    /***********************************/
+      if (tm->in == NULL || ! tm->in(tm->ctx, &reg[r])) return srIN_ERR ;
+      break;
+
+    case opOUT :  
+      if (tm->out != NULL) tm->out(tm->ctx, reg[r]);
+      break;
+    case opADD :  reg[r] = reg[s] + reg[t] ;  break;
+    case opSUB :  reg[r] = reg[s] - reg[t] ;  break;
+    case opMUL :  reg[r] = reg[s] * reg[t] ;  break;
+
+    case opDIV :
+    /***********************************/
+      if ( reg[t] != 0 ) reg[r] = reg[s] / reg[t];
+      else return srZERODIVIDE ;
+      break;
+
+    /*************** RM instructions ********************/
+    case opLD :
+      reg[r] = dMem[m] ;
+      if (tm->dReads != NULL) tm->dReads[m]++ ;
+      break;
+    case opST :
+      dMem[m] = reg[r] ;
+      if (tm->dWrites != NULL) tm->dWrites[m]++ ;
+      break;
+
+    /*************** RA instructions ********************/
+    case opLDA :    reg[r] = m ; break;
+    case opLDC :    reg[r] = currentinstruction.iarg2 ;   break;
+    case opJLT :    if ( reg[r] <  0 ) reg[PC_REG] = m ; break;
+    case opJLE :    if ( reg[r] <=  0 ) reg[PC_REG] = m ; break;
+    case opJGT :    if ( reg[r] >  0 ) reg[PC_REG] = m ; break;
+    case opJGE :    if ( reg[r] >=  0 ) reg[PC_REG] = m ; break;
+    case opJEQ :    if ( reg[r] == 0 ) reg[PC_REG] = m ; break;
+    case opJNE :    if ( reg[r] != 0 ) reg[PC_REG] = m ; break;
+
+    /* end of legal instructions */
+  } /* case */
+  /* a jump to the next location counts as not taken */
+  if (tm->profCount != NULL && currentinstruction.iop >= opJLT
+      && reg[PC_REG] != pc + 1)
+    tm->profCount[pc].taken++ ;
+  return srOKAY ;
+} /* tmStep */
+
+/********************************************/
+/* The fast engine runs predecoded instructions:
+   a handler and resolved operands per location.
+   An operand d(7) is known at load time (the pc
+   of the next instruction plus d), so it is
+   turned into an address off ZERO_REG, a register
+   that always holds 0. The rare instructions (IN,
+   OUT, HALT, writes to the pc other than jumps,
+   reads of the pc by RR instructions) are left to
+   tmStep. Location iSize holds a handler
+   that reports running off the end of iMem.
+
+   The decoder verifies what it can at load time
+   and drops the checks it proves unnecessary:
+   a register no instruction writes holds 0 from
+   tmReset on (gp in the code of the compiler), so
+   it is read as ZERO_REG too; a jump off ZERO_REG
+   has a known target, and one in 0..iSize needs
+   no check; an LD or ST off ZERO_REG has a known
+   address, and one of 0 or more needs no check
+   if dMem is larger than the highest of them
+   (constHigh). The rest keep their checks: a
+   known jump out of iMem and a conditional jump
+   to a computed target are left to tmStep, a
+   computed address or a jump through fhJMPR is
+   checked when it is executed */
+#define   ZERO_REG  NO_REGS
+
+typedef enum {
+   fhSTEP,    /* executed by tmStep */
+   fhIMEM,    /* pc out of iMem */
+   fhADD, fhSUB, fhMUL, fhDIV,
+   fhLD, fhST, fhLDA, fhLDC,
+   fhLDK, fhSTK, /* LD/ST of the verified address d */
+   fhJLT, fhJLE, fhJGT, fhJGE, fhJEQ, fhJNE, /* to the verified d */
+   fhJMP,     /* LDA/LDC to the pc: pc = d, verified */
+   fhJMPR,    /* LDA to the pc: pc = d+reg(s) */
+   fhIN, fhOUT,
+   /* superinstructions: the sequence starting at
+      their location */
+   fhSTLD,    /* ST; LD */
+   fhLDLD,    /* LD; LD */
+   fhLDCADD,  /* LDC; ADD */
+   fhLDCSUB,  /* LDC; SUB */
+   fhSUBJLT, fhSUBJLE, fhSUBJGT, fhSUBJGE, fhSUBJEQ, fhSUBJNE, /* SUB; Jcc */
+   fhSET,     /* SUB; Jcc 2(7); LDC 0; LDA 7,1(7); LDC 1 (d: the Jcc) */
+   fhLIMIT
+   } HANDLER;
+
+/* most steps a superinstruction runs (fhSET) */
+#define   FUSE_LONGEST  4
+
+typedef struct tm_decoded {
+      HANDLER h ;
+      void * addr ; /* label of h (threaded dispatch) */
+      int r, s, t, d ;
+   } DECODED;
+
+/* threaded dispatch needs the GCC label address
+   extension; other compilers switch on h */
+#ifndef THREADED
+#ifdef __GNUC__
+#define THREADED 1
+#else
+#define THREADED 0
+#endif
+#endif
+
+/********************************************/
+/* returns TRUE if the SUB at loc starts the
+   compare sequence of the TM code generators:
+   SUB r,s,t; Jcc r,2(7); LDC r,0(0); LDA 7,1(7);
+   LDC r,1(0), which sets r to 1 or 0 */
+static int isCompare (TmProgram * prog, int loc)
+{ DECODED * p = &prog->fastMem[loc];
+  int iSize = prog->iSize;
+  int r = p->r;
+  return loc + 4 < iSize
+         && p[1].h >= fhJLT && p[1].h <= fhJNE && p[1].r == r
+         && p[1].d == loc + 4
+         && p[2].h == fhLDC && p[2].r == r && p[2].d == 0
+         && p[3].h == fhJMP && p[3].d == loc + 5
+         && p[4].h == fhLDC && p[4].r == r && p[4].d == 1;
+} /* isCompare */
+
+/********************************************/
+/* fuses the common sequences of the code
+   generators into superinstructions. A fused
+   location runs its whole sequence in one
+   dispatch, but counts and faults at each of its
+   instructions as they would alone. The locations
+   after it keep their own handlers, so jumps into
+   the sequence and tmStep are not affected */
+static void fuseInstructions (TmProgram * prog)
+{ int loc;
+  HANDLER h, next;
+  DECODED * p;
+  memset(prog->fuseSites, 0, sizeof(prog->fuseSites));
+  for (loc = 0 ; loc + 1 < prog->iSize ; loc++)
+  { p = &prog->fastMem[loc];
+    h = p->h;
+    /* the next location is not fused yet */
+    next = p[1].h;
+    if (h == fhSUB && isCompare(prog,loc))
+    { p->h = fhSET;
+      p->d = next;
+    }
+    else if (h == fhSUB && next >= fhJLT && next <= fhJNE)
+      p->h = fhSUBJLT + (next - fhJLT);
+    else if (h == fhST && next == fhLD) p->h = fhSTLD;
+    else if (h == fhLD && next == fhLD) p->h = fhLDLD;
+    else if (h == fhLDC && next == fhADD) p->h = fhLDCADD;
+    else if (h == fhLDC && next == fhSUB) p->h = fhLDCSUB;
+    else continue;
+    prog->fuseSites[p->h - fhSTLD]++;
+  }
+} /* fuseInstructions */
+
+/********************************************/
+/* returns the set of registers (bit n for
+   register n) that no instruction writes */
+static int zeroRegisters (TmProgram * prog)
+{ INSTRUCTION * in;
+  int loc, zero = (1 << NO_REGS) - 1;
+  for (loc = 0 ; loc < prog->iSize ; loc++)
+  { in = &prog->iMem[loc];
+    switch (in->iop)
+    { case opIN : case opADD : case opSUB : case opMUL : case opDIV :
+      case opLD : case opLDA : case opLDC :
+        zero &= ~ (1 << in->iarg1);
+        break;
+    }
+  }
+  return zero & ~ (1 << PC_REG);
+} /* zeroRegisters */
+
+/* returns ZERO_REG for a register of zero, else r */
+#define   OPERAND(r)  (zero & (1 << (r)) ? ZERO_REG : (r))
+
+/********************************************/
+/* predecodes and verifies iMem into fastMem */
+static int decodeInstructions (TmProgram * prog, int fuse)
+{ INSTRUCTION * iMem = prog->iMem;
+  int iSize = prog->iSize;
+  int zero = zeroRegisters (prog);
+  int loc, op, r, s, t, d;
+  DECODED * fastMem, * p;
+  free(prog->fastMem);
+  fastMem = prog->fastMem = (DECODED *) malloc((iSize + 1) * sizeof(DECODED));
+  if (fastMem == NULL) return FALSE;
+  prog->constHigh = -1;
+  prog->provenJumps = prog->provenAccesses = 0;
+  for (loc = 0 ; loc <= iSize ; loc++)
+  { p = &fastMem[loc];
+    if (loc == iSize)
+    { p->h = fhIMEM;
+      continue;
+    }
+    op = iMem[loc].iop;
+    r = iMem[loc].iarg1;
+    p->h = fhSTEP;
+    p->r = r;
+    if ((op == opIN || op == opOUT) && r != PC_REG)
+    { p->h = op == opIN ? fhIN : fhOUT;
+      continue;
+    }
+    if (opClass(op) == opclRR)
+    { s = iMem[loc].iarg2;
+      t = iMem[loc].iarg3;
+      if (op < opADD || r == PC_REG || s == PC_REG || t == PC_REG) continue;
+      p->h = op == opADD ? fhADD : op == opSUB ? fhSUB :
+             op == opMUL ? fhMUL : fhDIV;
+      p->s = OPERAND(s);
+      p->t = OPERAND(t);
+      continue;
+    }
+    s = iMem[loc].iarg3;
+    d = iMem[loc].iarg2;
+    if (s == PC_REG)
+    { s = ZERO_REG;
+      d += loc + 1;
+    }
+    else s = OPERAND(s);
+    if (op == opLDC)
+    { s = ZERO_REG;
+      d = iMem[loc].iarg2;
+    }
+    p->s = s;
+    p->d = d;
+    if (op >= opJLT || r == PC_REG)
+    { /* only plain jumps are kept; a jump that is
+         not verified and not LDA is left to tmStep */
+      if (r == PC_REG && op != opLDA && op != opLDC) continue;
+      if (s == ZERO_REG && d >= 0 && d <= iSize)
+      { p->h = op <= opLDC ? fhJMP : fhJLT + (op - opJLT);
+        prog->provenJumps++;
+      }
+      else if (op == opLDA) p->h = fhJMPR;
+      continue;
+    }
+    switch (op)
+    { case opLD :  p->h = fhLD;  break;
+      case opST :  p->h = fhST;  break;
+      case opLDA : p->h = fhLDA; break;
+      case opLDC : p->h = fhLDC; break;
+    }
+    if ((op == opLD || op == opST) && s == ZERO_REG && d >= 0)
+    { p->h = op == opLD ? fhLDK : fhSTK;
+      if (d > prog->constHigh) prog->constHigh = d;
+      prog->provenAccesses++;
+    }
+  }
+  if (fuse) fuseInstructions (prog);
+  return TRUE;
+} /* decodeInstructions */
+
+#undef OPERAND
+
+/********************************************/
+/* runs the predecoded program on machine tm from
+   reg(7) until a step does not return srOKAY,
+   counting the steps in *count as the loop over
+   tmStep does. It pauses, returning srOKAY, at a
+   taken jump with fewer than slack of limit steps
+   left: without a taken jump the pc only grows, so
+   the steps cannot run out in between. With tm
+   NULL it only fills in the handler labels of
+   program prog */
+static STEPRESULT runFast (TmProgram * prog, TmMachine * tm, int limit,
+                           int * count)
+{ DECODED * fastMem = prog->fastMem;
+  int iSize = prog->iSize;
+  int * reg, * dMem, dSize;
+  unsigned long * fuseHits;
+  int reg_[NO_REGS+1];
+  int pc, m, i, left = limit; /* steps left */
+  int slack = iSize + FUSE_LONGEST;
+  unsigned long long steps;
+  DECODED * ip;
+  STEPRESULT result;
+#if THREADED
+  static void * labels[] =
+     { &&L_fhSTEP, &&L_fhIMEM,
+       &&L_fhADD, &&L_fhSUB, &&L_fhMUL, &&L_fhDIV,
+       &&L_fhLD, &&L_fhST, &&L_fhLDA, &&L_fhLDC, &&L_fhLDK, &&L_fhSTK,
+       &&L_fhJLT, &&L_fhJLE, &&L_fhJGT, &&L_fhJGE, &&L_fhJEQ, &&L_fhJNE,
+       &&L_fhJMP, &&L_fhJMPR, &&L_fhIN, &&L_fhOUT,
+       &&L_fhSTLD, &&L_fhLDLD, &&L_fhLDCADD, &&L_fhLDCSUB,
+       &&L_fhSUBJLT, &&L_fhSUBJLE, &&L_fhSUBJGT, &&L_fhSUBJGE,
+       &&L_fhSUBJEQ, &&L_fhSUBJNE, &&L_fhSET };
+  if (tm == NULL)
+  { for (i = 0 ; i <= iSize ; i++)
+      fastMem[i].addr = labels[fastMem[i].h];
+    return srOKAY;
+  }
+#define HANDLER(h)   L_##h:
+#define DISPATCH()   do { ip = &fastMem[pc]; left--; goto *ip->addr; } while (0)
+#else
+#define HANDLER(h)   case h:
+#define DISPATCH()   goto dispatch
+#endif
+/* a jump to m; a bad target fails in the next step */
+#define JUMP(m)      do { pc = (m); if (pc < 0 || pc > iSize) goto badJump; \
+                          if (left < slack) goto pause; \
+                          DISPATCH(); } while (0)
+/* a jump to the verified target m */
+#define GOTO(m)      do { pc = (m); if (left < slack) goto pause; \
+                          DISPATCH(); } while (0)
+/* an error of the instruction at pc */
+#define FAIL(sr)     do { pc++; result = (sr); goto stop; } while (0)
+/* a superinstruction h, and its step to the next
+   instruction of its sequence */
+#define SUPER(h)     HANDLER(h) fuseHits[h - fhSTLD]++;
+#define NEXT()       do { pc++; ip++; left--; } while (0)
+/* SUB; Jcc */
+#define SUBJ(h,rel)  SUPER(h) \
+                     reg_[ip->r] = reg_[ip->s] - reg_[ip->t]; NEXT(); \
+                     if (reg_[ip->r] rel 0) GOTO(ip->d); \
+                     pc++; DISPATCH();
+
+#if ! THREADED
+  if (tm == NULL) return srOKAY;
+#endif
+  reg = tm->reg;
+  dMem = tm->dMem;
+  dSize = tm->dSize;
+  fuseHits = tm->fuseHits;
+  steps = tm->steps;
+  for (i = 0 ; i < NO_REGS ; i++) reg_[i] = reg[i];
+  reg_[ZERO_REG] = 0;
+  pc = reg[PC_REG];
+  if (left < slack)
+  { *count = 0;
+    return srOKAY;
+  }
+  if (pc < 0 || pc >= iSize)
+  { tm->steps++;
+    *count = 1;
+    return srIMEM_ERR;
+  }
+#if THREADED
+  DISPATCH();
+#else
+dispatch:
+  ip = &fastMem[pc];
+  left--;
+  switch (ip->h)
+  {
+#endif
+  HANDLER(fhSTEP)
+    for (i = 0 ; i < PC_REG ; i++) reg[i] = reg_[i];
+    reg[PC_REG] = pc;
+    result = tmStep(tm);
+    for (i = 0 ; i < PC_REG ; i++) reg_[i] = reg[i];
+    pc = reg[PC_REG];
+    if (result != srOKAY) goto stop;
+    JUMP(pc);
+  HANDLER(fhIMEM)
+    result = srIMEM_ERR;
+    goto stop;
+  HANDLER(fhADD)
+    reg_[ip->r] = reg_[ip->s] + reg_[ip->t]; pc++; DISPATCH();
+  HANDLER(fhSUB)
+    reg_[ip->r] = reg_[ip->s] - reg_[ip->t]; pc++; DISPATCH();
+  HANDLER(fhMUL)
+    reg_[ip->r] = reg_[ip->s] * reg_[ip->t]; pc++; DISPATCH();
+  HANDLER(fhDIV)
+    if (reg_[ip->t] == 0) FAIL(srZERODIVIDE);
+    reg_[ip->r] = reg_[ip->s] / reg_[ip->t]; pc++; DISPATCH();
+  HANDLER(fhLD)
+    m = ip->d + reg_[ip->s];
+    if (m < 0 || m >= dSize) FAIL(srDMEM_ERR);
+    reg_[ip->r] = dMem[m]; pc++; DISPATCH();
+  HANDLER(fhST)
+    m = ip->d + reg_[ip->s];
+    if (m < 0 || m >= dSize) FAIL(srDMEM_ERR);
+    dMem[m] = reg_[ip->r]; pc++; DISPATCH();
+  HANDLER(fhLDA)
+    reg_[ip->r] = ip->d + reg_[ip->s]; pc++; DISPATCH();
+  HANDLER(fhLDC)
+    reg_[ip->r] = ip->d; pc++; DISPATCH();
+  HANDLER(fhLDK)
+    reg_[ip->r] = dMem[ip->d]; pc++; DISPATCH();
+  HANDLER(fhSTK)
+    dMem[ip->d] = reg_[ip->r]; pc++; DISPATCH();
+  HANDLER(fhJLT)
+    if (reg_[ip->r] <  0) GOTO(ip->d);
+    pc++; DISPATCH();
+  HANDLER(fhJLE)
+    if (reg_[ip->r] <= 0) GOTO(ip->d);
+    pc++; DISPATCH();
+  HANDLER(fhJGT)
+    if (reg_[ip->r] >  0) GOTO(ip->d);
+    pc++; DISPATCH();
+  HANDLER(fhJGE)
+    if (reg_[ip->r] >= 0) GOTO(ip->d);
+    pc++; DISPATCH();
+  HANDLER(fhJEQ)
+    if (reg_[ip->r] == 0) GOTO(ip->d);
+    pc++; DISPATCH();
+  HANDLER(fhJNE)
+    if (reg_[ip->r] != 0) GOTO(ip->d);
+    pc++; DISPATCH();
+  HANDLER(fhJMP)
+    GOTO(ip->d);
+  HANDLER(fhJMPR)
+    JUMP(ip->d + reg_[ip->s]);
+  HANDLER(fhIN)
+    if (tm->in == NULL || ! tm->in(tm->ctx, &reg_[ip->r])) FAIL(srIN_ERR);
+    pc++; DISPATCH();
+  HANDLER(fhOUT)
+    if (tm->out != NULL) tm->out(tm->ctx, reg_[ip->r]);
+    pc++; DISPATCH();
+  SUPER(fhSTLD)
+    m = ip->d + reg_[ip->s];
+    if (m < 0 || m >= dSize) FAIL(srDMEM_ERR);
+    dMem[m] = reg_[ip->r]; NEXT();
+    m = ip->d + reg_[ip->s];
+    if (m < 0 || m >= dSize) FAIL(srDMEM_ERR);
+    reg_[ip->r] = dMem[m]; pc++; DISPATCH();
+  SUPER(fhLDLD)
+    m = ip->d + reg_[ip->s];
+    if (m < 0 || m >= dSize) FAIL(srDMEM_ERR);
+    reg_[ip->r] = dMem[m]; NEXT();
+    m = ip->d + reg_[ip->s];
+    if (m < 0 || m >= dSize) FAIL(srDMEM_ERR);
+    reg_[ip->r] = dMem[m]; pc++; DISPATCH();
+  SUPER(fhLDCADD)
+    reg_[ip->r] = ip->d; NEXT();
+    reg_[ip->r] = reg_[ip->s] + reg_[ip->t]; pc++; DISPATCH();
+  SUPER(fhLDCSUB)
+    reg_[ip->r] = ip->d; NEXT();
+    reg_[ip->r] = reg_[ip->s] - reg_[ip->t]; pc++; DISPATCH();
+  SUBJ(fhSUBJLT, <)
+  SUBJ(fhSUBJLE, <=)
+  SUBJ(fhSUBJGT, >)
+  SUBJ(fhSUBJGE, >=)
+  SUBJ(fhSUBJEQ, ==)
+  SUBJ(fhSUBJNE, !=)
+  SUPER(fhSET)
+    reg_[ip->r] = reg_[ip->s] - reg_[ip->t];
+    i = ip->d; NEXT();
+    m = reg_[ip->r];
+    if (i == fhJLT ? m < 0 : i == fhJLE ? m <= 0 : i == fhJGT ? m > 0 :
+        i == fhJGE ? m >= 0 : i == fhJEQ ? m == 0 : m != 0)
+    { /* the jump to LDC r,1 */
+      pc += 3; ip += 3; left--;
+      reg_[ip->r] = 1; pc++; DISPATCH();
+    }
+    NEXT();
+    reg_[ip->r] = 0; NEXT();
+    pc += 2; DISPATCH();
+#if ! THREADED
+  }
+#endif
+badJump:
+  left--;
+  result = srIMEM_ERR;
+  goto stop;
+pause:
+  result = srOKAY;
+stop:
+  for (i = 0 ; i < PC_REG ; i++) reg[i] = reg_[i];
+  reg[PC_REG] = pc;
+  tm->lastLoc = ip - fastMem;
+  tm->steps = steps + (limit - left);
+  *count = limit - left;
+  return result;
+#undef HANDLER
+#undef DISPATCH
+#undef JUMP
+#undef GOTO
+#undef FAIL
+#undef SUPER
+#undef NEXT
+#undef SUBJ
+} /* runFast */
+
+/********************************************/
+/* loads program file name, text or object file */
+TmProgram * tmLoad (const char * name, int fuse)
+{ TmProgram * p;
+  FILE * pgm;
+  char magic[4];
+  int ok;
+  pgm = fopen(name, "rb");
+  if (pgm == NULL)
+  { printf("file '%s' not found\n", name);
+    return NULL;
+  }
+  p = (TmProgram *) calloc(1, sizeof(TmProgram));
+  if (p == NULL)
+  { fclose(pgm);
+    return NULL;
+  }
+  if (fread(magic, 1, 4, pgm) == 4 && memcmp(magic, TMO_MAGIC, 4) == 0)
+  { rewind(pgm);
+    ok = loadObject(p, pgm, name);
+  }
+  else
+  { rewind(pgm);
+    ok = readInstructions(p, pgm);
+  }
+  fclose(pgm);
+  if (ok && ! decodeInstructions(p, fuse))
+  { printf("cannot allocate %d iMem locations\n", p->iSize);
+    ok = FALSE;
+  }
+  if (! ok)
+  { tmFreeProgram(p);
+    return NULL;
+  }
+  runFast(p, NULL, 0, NULL);
+  return p;
+} /* tmLoad */
+
+/********************************************/
+void tmFreeProgram (TmProgram * p)
+{ if (p == NULL) return;
+  if (p->iCapacity > 0) free(p->iMem);
+#ifdef HAVE_MMAP
+  if (p->imageMapped) munmap(p->image, (size_t) p->imageSize);
+  else
+#endif
+  free(p->image);
+  free(p->fastMem);
+  free(p);
+} /* tmFreeProgram */
+
+/********************************************/
+TmMachine * tmNew (TmProgram * p, int dSize, int mapped)
+{ TmMachine * m = (TmMachine *) calloc(1, sizeof(TmMachine));
+  if (m == NULL) return NULL;
+  m->prog = p;
+  m->dSize = dSize;
+#ifdef HAVE_MMAP
+  m->mapped = mapped;
+#endif
+  if (! tmReset(m))
+  { tmFree(m);
+    return NULL;
+  }
+  return m;
+} /* tmNew */
+
+/********************************************/
+/* releases the dMem of m */
+static void freeDMem (TmMachine * m)
+{
+#ifdef HAVE_MMAP
+  if (m->mapped || m->cow)
+  { if (m->dMem != NULL) munmap(m->dMem, (size_t) m->dSize * sizeof(int));
+  }
+  else
+#endif
+  free(m->dMem);
+  m->dMem = NULL;
+  m->cow = FALSE;
+} /* freeDMem */
+
+/********************************************/
+void tmFree (TmMachine * m)
+{ if (m == NULL) return;
+  freeDMem(m);
+  free(m->profCount);
+  free(m->dReads);
+  free(m->dWrites);
+  free(m);
+} /* tmFree */
+
+/********************************************/
+/* A mapped dMem is mapped anew, so only the
+   pages used get committed */
+int tmReset (TmMachine * m)
+{ int regNo;
+  for (regNo = 0 ; regNo < NO_REGS ; regNo++)
+      m->reg[regNo] = 0 ;
+  m->steps = 0 ;
+  if (m->cow) freeDMem(m);
+#ifdef HAVE_MMAP
+  if (m->mapped)
+  { if (m->dMem != NULL) munmap(m->dMem, (size_t) m->dSize * sizeof(int));
+    m->dMem = (int *) mmap(NULL, (size_t) m->dSize * sizeof(int),
+                           PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (m->dMem == (int *) MAP_FAILED) m->dMem = NULL;
+  }
+  else
+#endif
+  { if (m->dMem == NULL) m->dMem = (int *) calloc(m->dSize, sizeof(int));
+    else memset(m->dMem, 0, (size_t) m->dSize * sizeof(int));
+  }
+  if (m->dMem == NULL)
+  { printf("cannot allocate %d dMem locations\n", m->dSize);
+    return FALSE;
+  }
+  m->dMem[0] = m->dSize - 1 ;
+  return TRUE;
+} /* tmReset */
+
+/********************************************/
+int tmProfile (TmMachine * m)
+{ m->profCount = (PROFCOUNT *) calloc(m->prog->iSize + 1, sizeof(PROFCOUNT));
+  m->dReads = (unsigned long *) calloc(m->dSize, sizeof(unsigned long));
+  m->dWrites = (unsigned long *) calloc(m->dSize, sizeof(unsigned long));
+  return m->profCount != NULL && m->dReads != NULL && m->dWrites != NULL;
+} /* tmProfile */
+
+/********************************************/
+/* the fast engine runs all but the last steps */
+STEPRESULT tmRunSteps (TmMachine * m, int n, int * count)
+{ STEPRESULT result = srOKAY;
+  int cnt = 0;
+  if (m->profCount == NULL && m->prog->constHigh < m->dSize)
+    result = runFast(m->prog, m, n, &cnt);
+  while (cnt < n && result == srOKAY)
+  { result = tmStep(m);
+    cnt++;
+  }
+  *count = cnt;
+  return result;
+} /* tmRunSteps */
+
+/********************************************/
+STEPRESULT tmRun (TmMachine * m, int * count)
+{ STEPRESULT result = srOKAY;
+  int cnt = 0, n;
+  /* the unchecked LD and ST need constHigh in dMem */
+  if (m->profCount == NULL && m->prog->constHigh < m->dSize)
+  { do
+    { result = runFast(m->prog, m, INT_MAX, &n);
+      cnt += n;
+    } while (result == srOKAY);
+    *count = cnt;
+    return result;
+  }
+  while (result == srOKAY)
+  { result = tmStep(m);
+    cnt++;
+  }
+  *count = cnt;
+  return result;
+} /* tmRun */
+
+/********************************************/
+/* A checkpoint file names its program by a hash
+   of iMem; a text and an object file of the same
+   code have the same iMem */
+#define   TMC_GAP  4 /* zeros that end a run of dMem values */
+
+/* returns the hash (FNV-1a) of the iMem of p */
+static unsigned programHash (TmProgram * p)
+{ unsigned char * b = (unsigned char *) p->iMem;
+  size_t i, n = (size_t) p->iSize * sizeof(INSTRUCTION);
+  unsigned h = 2166136261u;
+  for (i = 0 ; i < n ; i++) h = (h ^ b[i]) * 16777619u;
+  return h;
+} /* programHash */
+
+/* allocates the zero dMem of snapshot s: a shared
+   mapping of a temporary file if possible, which
+   holds the zeros as holes */
+static int allocSnapshot (TmSnapshot * s)
+{ size_t size = (size_t) s->dSize * sizeof(int);
+#ifdef HAVE_MMAP
+  int zero = 0;
+  s->file = tmpfile();
+  if (s->file != NULL
+      && fseek(s->file, (long) (size - sizeof(int)), SEEK_SET) == 0
+      && fwrite(&zero, sizeof(int), 1, s->file) == 1
+      && fflush(s->file) == 0)
+  { s->dMem = (int *) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                           fileno(s->file), 0);
+    if (s->dMem != (int *) MAP_FAILED) return TRUE;
+  }
+  if (s->file != NULL) fclose(s->file);
+  s->file = NULL;
+#endif
+  s->dMem = (int *) calloc(s->dSize, sizeof(int));
+  return s->dMem != NULL;
+} /* allocSnapshot */
+
+/********************************************/
+void tmFreeSnapshot (TmSnapshot * s)
+{ if (s == NULL) return;
+#ifdef HAVE_MMAP
+  if (s->file != NULL)
+  { munmap(s->dMem, (size_t) s->dSize * sizeof(int));
+    fclose(s->file);
+  }
+  else
+#endif
+  free(s->dMem);
+  free(s);
+} /* tmFreeSnapshot */
+
+/********************************************/
+/* Only the blocks of dMem that hold a value are
+   copied, so a mapped snapshot stays sparse */
+TmSnapshot * tmSnapshot (TmMachine * m)
+{ TmSnapshot * s = (TmSnapshot *) calloc(1, sizeof(TmSnapshot));
+  int loc, n, i;
+  if (s == NULL) return NULL;
+  s->prog = m->prog;
+  memcpy(s->reg, m->reg, sizeof(s->reg));
+  s->dSize = m->dSize;
+  s->steps = m->steps;
+  if (! allocSnapshot(s))
+  { free(s);
+    return NULL;
+  }
+  for (loc = 0 ; loc < m->dSize ; loc += n)
+  { n = m->dSize - loc < 1024 ? m->dSize - loc : 1024;
+    for (i = 0 ; i < n && m->dMem[loc+i] == 0 ; i++)
+      ;
+    if (i < n) memcpy(s->dMem + loc, m->dMem + loc, n * sizeof(int));
+  }
+  return s;
+} /* tmSnapshot */
+
+/********************************************/
+int tmRestore (TmMachine * m, TmSnapshot * s)
+{ if (m->prog != s->prog || m->dSize != s->dSize) return FALSE;
+#ifdef HAVE_MMAP
+  if (s->file != NULL)
+  { int * dMem = (int *) mmap(NULL, (size_t) s->dSize * sizeof(int),
+                              PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                              fileno(s->file), 0);
+    if (dMem == (int *) MAP_FAILED) return FALSE;
+    freeDMem(m);
+    m->dMem = dMem;
+    m->cow = TRUE;
+  }
+  else
+#endif
+  { if (m->cow && ! tmReset(m)) return FALSE;
+    memcpy(m->dMem, s->dMem, (size_t) s->dSize * sizeof(int));
+  }
+  memcpy(m->reg, s->reg, sizeof(m->reg));
+  m->steps = s->steps;
+  return TRUE;
+} /* tmRestore */
+
+/* finds the next run of dMem values of s from
+   location loc into *run; FALSE if there is none */
+static int nextRun (TmSnapshot * s, int loc, TmcRun * run)
+{ int end;
+  while (loc < s->dSize && s->dMem[loc] == 0) loc++;
+  if (loc == s->dSize) return FALSE;
+  run->start = end = loc;
+  while (loc < s->dSize && loc - end < TMC_GAP)
+    if (s->dMem[loc++] != 0) end = loc;
+  run->count = end - run->start;
+  return TRUE;
+} /* nextRun */
+
+/********************************************/
+int tmSaveSnapshot (TmSnapshot * s, FILE * f)
+{ TmcHeader h;
+  TmcRun run;
+  int loc;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, TMC_MAGIC, 4);
+  h.version = TMC_VERSION;
+  h.program = programHash(s->prog);
+  h.iSize = s->prog->iSize;
+  h.dSize = s->dSize;
+  memcpy(h.reg, s->reg, sizeof(h.reg));
+  h.steps = s->steps;
+  h.inPos = s->inPos;
+  for (loc = 0 ; nextRun(s, loc, &run) ; loc = run.start + run.count)
+    h.runs++;
+  fwrite(&h, sizeof(h), 1, f);
+  for (loc = 0 ; nextRun(s, loc, &run) ; loc = run.start + run.count)
+  { fwrite(&run, sizeof(run), 1, f);
+    fwrite(s->dMem + run.start, sizeof(int), run.count, f);
+  }
+  return fflush(f) == 0 && ! ferror(f);
+} /* tmSaveSnapshot */
+
+/********************************************/
+/* A checkpoint must name program p and may not
+   set a register that no instruction of p writes,
+   as the fast engine takes it for 0 */
+TmSnapshot * tmLoadSnapshot (TmProgram * p, FILE * f, const char * name)
+{ TmcHeader h;
+  TmcRun run;
+  TmSnapshot * s;
+  unsigned i;
+  if (fread(&h, sizeof(h), 1, f) != 1 || memcmp(h.magic, TMC_MAGIC, 4) != 0
+      || h.version != TMC_VERSION)
+  { printf("%s: not a TM checkpoint file\n", name);
+    return NULL;
+  }
+  if (h.program != programHash(p) || h.iSize != p->iSize)
+  { printf("%s: checkpoint of another program\n", name);
+    return NULL;
+  }
+  for (i = 0 ; i < NO_REGS ; i++)
+    if (zeroRegisters(p) & (1 << i) && h.reg[i] != 0) break;
+  if (h.dSize < 8 || i < NO_REGS)
+  { printf("%s: bad checkpoint\n", name);
+    return NULL;
+  }
+  s = (TmSnapshot *) calloc(1, sizeof(TmSnapshot));
+  if (s == NULL) return NULL;
+  s->prog = p;
+  memcpy(s->reg, h.reg, sizeof(s->reg));
+  s->dSize = h.dSize;
+  s->steps = h.steps;
+  s->inPos = h.inPos;
+  if (! allocSnapshot(s))
+  { printf("cannot allocate %d dMem locations\n", h.dSize);
+    free(s);
+    return NULL;
+  }
+  for (i = 0 ; i < h.runs ; i++)
+  { if (fread(&run, sizeof(run), 1, f) != 1 || run.start < 0 || run.count < 0
+        || run.count > s->dSize - run.start
+        || fread(s->dMem + run.start, sizeof(int), run.count, f)
+           != (size_t) run.count)
+    { printf("%s: truncated checkpoint file\n", name);
+      tmFreeSnapshot(s);
+      return NULL;
+    }
+  }
+  return s;
+} /* tmLoadSnapshot */
+
+/********************************************/
+void tmStreamsInit (TmStreams * io, FILE * in, FILE * out)
+{ io->in = in;
+  io->out = out;
+  io->inPos = io->inLen = io->outLen = 0;
+  io->inRead = 0;
+} /* tmStreamsInit */
+
+/* returns the next input character, EOF at end */
+static int inChar (TmStreams * io)
+{ if (io->inPos == io->inLen)
+  { io->inLen = fread(io->inBuf, 1, IOBUFSIZE, io->in);
+    io->inPos = 0;
+    if (io->inLen <= 0)
+    { io->inLen = 0;
+      return EOF;
+    }
+    io->inRead += io->inLen;
+  }
+  return (unsigned char) io->inBuf[io->inPos++];
+} /* inChar */
+
+/* reads the next integer of the input into *value;
+   returns FALSE at end of input or at a malformed
+   word */
+int tmReadInt (void * ctx, int * value)
+{ TmStreams * io = (TmStreams *) ctx;
+  int c, sign, digits;
+  unsigned n;
+  do c = inChar(io); while (c != EOF && isspace(c));
+  if (c == EOF) return FALSE;
+  sign = 1;
+  while (c == '+' || c == '-')
+  { if (c == '-') sign = - sign;
+    c = inChar(io);
+  }
+  n = 0;
+  digits = 0;
+  while (c != EOF && isdigit(c))
+  { n = n * 10 + (c - '0');
+    digits++;
+    c = inChar(io);
+  }
+  if (digits == 0 || (c != EOF && ! isspace(c))) return FALSE;
+  *value = (int) (sign * n);
+  return TRUE;
+} /* tmReadInt */
+
+/* writes the output buffered so far */
+void tmFlush (TmStreams * io)
+{ fwrite(io->outBuf, 1, io->outLen, io->out);
+  fflush(io->out);
+  io->outLen = 0;
+} /* tmFlush */
+
+/* appends value and a newline to the output */
+void tmWriteInt (void * ctx, int value)
+{ TmStreams * io = (TmStreams *) ctx;
+  char digits[12];
+  unsigned n = value < 0 ? - (unsigned) value : (unsigned) value;
+  int len = 0;
+  if (io->outLen > IOBUFSIZE - 16) tmFlush(io);
+  do
+  { digits[len++] = '0' + n % 10;
+    n /= 10;
+  } while (n > 0);
+  if (value < 0) io->outBuf[io->outLen++] = '-';
+  while (len > 0) io->outBuf[io->outLen++] = digits[--len];
+  io->outBuf[io->outLen++] = '\n';
+} /* tmWriteInt */
+
+/********************************************/
+long long tmStreamsPos (TmStreams * io)
+{ return io->inRead - io->inLen + io->inPos;
+} /* tmStreamsPos */
+
+/* a file is positioned, other input is read */
+int tmStreamsSkip (TmStreams * io, long long pos)
+{ /* a seek past the end succeeds, so the last byte
+     skipped is read to see that it is there */
+  if (pos > 0 && fseek(io->in, (long) pos - 1, SEEK_SET) == 0)
+  { io->inPos = io->inLen = 0;
+    io->inRead = pos;
+    return getc(io->in) != EOF;
+  }
+  while (tmStreamsPos(io) < pos)
+    if (inChar(io) == EOF) return FALSE;
+  return TRUE;
+} /* tmStreamsSkip */
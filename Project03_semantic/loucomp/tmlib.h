@@ -0,0 +1,254 @@
+/****************************************************/
+/* File: tmlib.h                                    */
+/* The TM ("Tiny Machine") as a library: programs   */
+/* loaded once and machines that run them, any      */
+/* number at a time                                 */
+/****************************************************/
+
+#ifndef _TMLIB_H_
+#define _TMLIB_H_
+
+#include <stdio.h>
+#include "tmobj.h"
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/******* const *******/
+#define   IADDR_MAX   (1 << 26) /* largest iMem location */
+#define   DADDR_SIZE  1024 /* default dMem size */
+#define   NO_REGS 8
+#define   PC_REG  7
+
+#define   LINESIZE  121
+#define   WORDSIZE  20
+
+/******* type  *******/
+
+typedef enum {
+   opclRR,     /* reg operands r,s,t */
+   opclRM,     /* reg r, mem d+s */
+   opclRA      /* reg r, int d+s */
+   } OPCLASS;
+
+typedef enum {
+   /* RR instructions */
+   opHALT,    /* RR     halt, operands are ignored */
+   opIN,      /* RR     read into reg(r); s and t are ignored */
+   opOUT,     /* RR     write from reg(r), s and t are ignored */
+   opADD,    /* RR     reg(r) = reg(s)+reg(t) */
+   opSUB,    /* RR     reg(r) = reg(s)-reg(t) */
+   opMUL,    /* RR     reg(r) = reg(s)*reg(t) */
+   opDIV,    /* RR     reg(r) = reg(s)/reg(t) */
+   opRRLim,   /* limit of RR opcodes */
+
+   /* RM instructions */
+   opLD,      /* RM     reg(r) = mem(d+reg(s)) */
+   opST,      /* RM     mem(d+reg(s)) = reg(r) */
+   opRMLim,   /* Limit of RM opcodes */
+
+   /* RA instructions */
+   opLDA,     /* RA     reg(r) = d+reg(s) */
+   opLDC,     /* RA     reg(r) = d ; reg(s) is ignored */
+   opJLT,     /* RA     if reg(r)<0 then reg(7) = d+reg(s) */
+   opJLE,     /* RA     if reg(r)<=0 then reg(7) = d+reg(s) */
+   opJGT,     /* RA     if reg(r)>0 then reg(7) = d+reg(s) */
+   opJGE,     /* RA     if reg(r)>=0 then reg(7) = d+reg(s) */
+   opJEQ,     /* RA     if reg(r)==0 then reg(7) = d+reg(s) */
+   opJNE,     /* RA     if reg(r)!=0 then reg(7) = d+reg(s) */
+   opRALim    /* Limit of RA opcodes */
+   } OPCODE;
+
+typedef enum {
+   srOKAY,
+   srHALT,
+   srIMEM_ERR,
+   srDMEM_ERR,
+   srZERODIVIDE,
+   srIN_ERR       /* IN found no value: end or bad input */
+   } STEPRESULT;
+
+typedef struct {
+      int iop  ;
+      int iarg1  ;
+      int iarg2  ;
+      int iarg3  ;
+   } INSTRUCTION;
+
+/* execution profile: counts per iMem location */
+typedef struct {
+      unsigned long exec ;  /* times executed */
+      unsigned long taken ; /* times the jump was taken */
+   } PROFCOUNT;
+
+/* kinds of superinstructions of the fast engine */
+#define   TM_FUSED  11
+
+extern char * opCodeTab[];
+extern char * stepResultTab[];
+extern char * fuseName[TM_FUSED];
+
+/* A program: iMem holds locations 0 to iSize-1, as
+   many as the program uses. A loaded program is
+   only read, so machines in several threads may
+   share it */
+typedef struct tm_program {
+      INSTRUCTION * iMem ;
+      int iSize, iCapacity ; /* iCapacity 0: iMem is not owned */
+      int * lineTab ;        /* source line per location, or NULL */
+      TmoFunc * funcTab ;    /* functions by entry, or NULL */
+      int funcCount ;
+      struct tm_decoded * fastMem ; /* the predecoded program */
+      unsigned long fuseSites[TM_FUSED] ; /* locations fused */
+      int provenJumps, provenAccesses ; /* checks dropped by the verifier */
+      int constHigh ;        /* highest unchecked dMem address, or -1 */
+      void * image ;         /* the object file mapped or read */
+      long imageSize ;
+      int imageMapped ;
+   } TmProgram;
+
+/* the IN callback stores the next value in *value
+   and returns FALSE at the end of the input; the
+   OUT callback writes value */
+typedef int (* TmInput) (void * ctx, int * value);
+typedef void (* TmOutput) (void * ctx, int value);
+
+/* A machine: registers, dMem and the IO of one
+   execution of a program */
+typedef struct tm_machine {
+      TmProgram * prog ;
+      int reg [NO_REGS] ;
+      int * dMem ;
+      int dSize ;
+      int mapped ;           /* dMem mapped and committed lazily */
+      TmInput in ;
+      TmOutput out ;
+      void * ctx ;           /* passed to in and out */
+      int lastLoc ;          /* location of the last instruction run */
+      unsigned long long steps ; /* steps run since tmReset */
+      int cow ;              /* dMem mapped copy-on-write from a snapshot */
+      PROFCOUNT * profCount ; /* NULL: no profile */
+      unsigned long * dReads, * dWrites ;
+      unsigned long fuseHits[TM_FUSED] ; /* superinstructions run */
+   } TmMachine;
+
+/* A line of TM text and the reader of its numbers
+   and words */
+typedef struct {
+      char line[LINESIZE] ;
+      int len, col ;
+      char ch ;
+      int num ;
+      char word[WORDSIZE] ;
+   } TmScanner;
+
+/* Buffered integer IO for the IN and OUT callbacks:
+   the input is parsed for whitespace separated
+   integers; at its end or at a malformed word IN
+   fails, as in the runtimes of -S and -C */
+#define   IOBUFSIZE  65536
+
+typedef struct {
+      FILE * in, * out ;
+      char inBuf[IOBUFSIZE] ;
+      int inPos, inLen ;
+      long long inRead ;     /* bytes read into inBuf in all */
+      char outBuf[IOBUFSIZE] ;
+      int outLen ;
+   } TmStreams;
+
+int opClass (int c);
+
+/* the scanner: tmScanLine starts on text, the
+   others return FALSE if the item is not next */
+void tmScanLine (TmScanner * s, const char * text);
+int tmNonBlank (TmScanner * s);
+int tmGetNum (TmScanner * s);
+int tmGetWord (TmScanner * s);
+int tmSkipCh (TmScanner * s, char c);
+int tmAtEOL (TmScanner * s);
+
+/* tmLoad reads a TM text or object file, reporting
+   errors on stdout; fuse selects superinstructions.
+   Returns NULL on failure */
+TmProgram * tmLoad (const char * name, int fuse);
+void tmFreeProgram (TmProgram * p);
+
+/* tmNew makes a machine for program p with dSize
+   dMem locations, mapped lazily if mapped, and
+   resets it; NULL if there is no memory */
+TmMachine * tmNew (TmProgram * p, int dSize, int mapped);
+void tmFree (TmMachine * m);
+
+/* tmReset clears the registers and dMem; dMem[0]
+   holds the highest address. The fast engine
+   relies on the registers no instruction writes
+   staying 0 */
+int tmReset (TmMachine * m);
+
+/* tmProfile makes m count its steps (PROFCOUNT)
+   and the reads and writes of each dMem location */
+int tmProfile (TmMachine * m);
+
+/* tmStep executes one instruction */
+STEPRESULT tmStep (TmMachine * m);
+
+/* tmRunSteps executes up to n instructions, as
+   tmRun does, stopping at the first result other
+   than srOKAY; *count is the number executed */
+STEPRESULT tmRunSteps (TmMachine * m, int n, int * count);
+
+/* tmRun executes instructions until a result other
+   than srOKAY, on the predecoded program unless m
+   is profiling or its dMem is too small for the
+   verified addresses; *count is the number executed */
+STEPRESULT tmRun (TmMachine * m, int * count);
+
+/* A snapshot: the state of a machine, from which
+   any number of machines of the same program can
+   go on. Where mmap is available dMem is kept in
+   a temporary file that the machines map copy-on-
+   write, so they share the pages none of them
+   writes */
+typedef struct {
+      TmProgram * prog ;
+      int reg [NO_REGS] ;
+      int * dMem ;
+      int dSize ;
+      unsigned long long steps ;
+      long long inPos ;      /* input read so far, set by the caller */
+      FILE * file ;          /* holds dMem if mapped */
+   } TmSnapshot;
+
+/* tmSnapshot takes the state of m, NULL if there
+   is no memory */
+TmSnapshot * tmSnapshot (TmMachine * m);
+void tmFreeSnapshot (TmSnapshot * s);
+
+/* tmRestore puts m, of the program and dSize of s,
+   in the state of s */
+int tmRestore (TmMachine * m, TmSnapshot * s);
+
+/* tmSaveSnapshot writes s as a checkpoint file
+   (tmckpt.h); tmLoadSnapshot reads one for program
+   p, reporting errors on stdout; NULL on failure */
+int tmSaveSnapshot (TmSnapshot * s, FILE * f);
+TmSnapshot * tmLoadSnapshot (TmProgram * p, FILE * f, const char * name);
+
+/* stdio callbacks for TmStreams */
+void tmStreamsInit (TmStreams * io, FILE * in, FILE * out);
+int tmReadInt (void * io, int * value);
+void tmWriteInt (void * io, int value);
+void tmFlush (TmStreams * io);
+
+/* tmStreamsPos returns the bytes of input read so
+   far; tmStreamsSkip skips the first pos bytes of
+   the input, FALSE if it is shorter */
+long long tmStreamsPos (TmStreams * io);
+int tmStreamsSkip (TmStreams * io, long long pos);
+
+#endif
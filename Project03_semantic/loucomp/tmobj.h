@@ -0,0 +1,59 @@
+/****************************************************/
+/* File: tmobj.h                                    */
+/* Binary object format of TM programs (.tmo),      */
+/* written by the compiler (-b) and loaded by tm    */
+/****************************************************/
+
+#ifndef _TMOBJ_H_
+#define _TMOBJ_H_
+
+/* A .tmo file holds, in the byte order of the
+ * machine that wrote it:
+ *   a TmoHeader
+ *   count TmoInstr, for locations 0 to count-1
+ *   if flags has TMO_LINES: count ints, the source
+ *     line of each instruction (0: none)
+ *   if flags has TMO_FUNCS: an int n and n TmoFunc,
+ *     in order of entry location
+ * tm maps the file and runs the instructions in
+ * place, so a TmoInstr has the layout of its
+ * INSTRUCTION
+ */
+#define TMO_MAGIC    "TMO\032"
+#define TMO_VERSION  1
+
+/* flags of the optional sections */
+#define TMO_LINES    1
+#define TMO_FUNCS    2
+
+typedef struct
+   { char magic[4];    /* TMO_MAGIC */
+     unsigned version; /* TMO_VERSION */
+     unsigned count;   /* number of instructions */
+     unsigned flags;   /* TMO_LINES, ... */
+   } TmoHeader;
+
+/* RR: op r,a,b   RM and RA: op r,a(b) */
+typedef struct
+   { int op, r, a, b;
+   } TmoInstr;
+
+/* a function and its entry location; the name is
+ * cut to TMO_NAMESIZE-1 characters
+ */
+#define TMO_NAMESIZE 28
+
+typedef struct
+   { int loc;
+     char name[TMO_NAMESIZE];
+   } TmoFunc;
+
+/* opcodes, numbered as in tm.c */
+typedef enum
+   { TMO_HALT, TMO_IN, TMO_OUT, TMO_ADD, TMO_SUB, TMO_MUL, TMO_DIV,
+     TMO_LD = 8, TMO_ST,
+     TMO_LDA = 11, TMO_LDC, TMO_JLT, TMO_JLE, TMO_JGT, TMO_JGE,
+     TMO_JEQ, TMO_JNE
+   } TmoOp;
+
+#endif
@@ -0,0 +1,170 @@
+/****************************************************/
+/* File: tmrun.c                                    */
+/* Runs a TM program on many input files at once:   */
+/* the program is loaded once and each of N worker  */
+/* threads runs it on its own machine, writing the  */
+/* output of input file F to F.out. With -cFILE     */
+/* each run starts from checkpoint FILE and reads   */
+/* its input file from the start                    */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include "tmlib.h"
+
+#define   MAX_THREADS  256
+
+TmProgram * prog = NULL;
+int dSize = DADDR_SIZE; /* dMem locations (-dN) */
+int fuseflag = TRUE; /* fuse superinstructions (-nofuse: off) */
+char * startName = NULL; /* checkpoint the runs start from (-cFILE) */
+TmSnapshot * start = NULL;
+
+/* the input files; a worker takes the next one
+   under the lock */
+char ** inputs;
+int inputCount = 0;
+int nextInput = 0;
+int failures = 0;
+pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+/********************************************/
+/* runs the program on input file name with
+   machine m; returns FALSE if it did not HALT */
+int runInput (TmMachine * m, TmStreams * io, char * name)
+{ FILE * in, * out;
+  char * outName;
+  STEPRESULT result;
+  int count;
+  outName = (char *) malloc(strlen(name) + 5);
+  if (outName == NULL) return FALSE;
+  sprintf(outName, "%s.out", name);
+  in = fopen(name, "rb");
+  out = fopen(outName, "wb");
+  if (in == NULL || out == NULL)
+  { fprintf(stderr, "%s: cannot open %s\n", name,
+            in == NULL ? name : outName);
+    if (in != NULL) fclose(in);
+    if (out != NULL) fclose(out);
+    free(outName);
+    return FALSE;
+  }
+  free(outName);
+  tmStreamsInit(io, in, out);
+  m->ctx = io;
+  result = srOKAY;
+  if (! (start != NULL ? tmRestore(m, start) : tmReset(m)))
+    result = srDMEM_ERR;
+  else result = tmRun(m, &count);
+  tmFlush(io);
+  fclose(in);
+  fclose(out);
+  if (result == srHALT) return TRUE;
+  /* a faulting instruction has advanced the pc */
+  fprintf(stderr, "%s: %s at location %d\n", name, stepResultTab[result],
+          result == srIMEM_ERR ? m->reg[PC_REG] : m->reg[PC_REG] - 1);
+  return FALSE;
+} /* runInput */
+
+/********************************************/
+/* a worker: runs the program on input files
+   until none is left */
+void * worker (void * arg)
+{ TmMachine * m;
+  TmStreams * io;
+  int i, failed = 0;
+  (void) arg;
+  m = tmNew(prog, start != NULL ? start->dSize : dSize, FALSE);
+  io = (TmStreams *) malloc(sizeof(TmStreams));
+  if (m == NULL || io == NULL)
+  { fprintf(stderr, "cannot allocate a machine\n");
+    pthread_mutex_lock(&lock);
+    failures++;
+    pthread_mutex_unlock(&lock);
+    tmFree(m);
+    free(io);
+    return NULL;
+  }
+  m->in = tmReadInt;
+  m->out = tmWriteInt;
+  for (;;)
+  { pthread_mutex_lock(&lock);
+    i = nextInput < inputCount ? nextInput++ : -1;
+    pthread_mutex_unlock(&lock);
+    if (i < 0) break;
+    if (! runInput(m, io, inputs[i])) failed++;
+  }
+  pthread_mutex_lock(&lock);
+  failures += failed;
+  pthread_mutex_unlock(&lock);
+  tmFree(m);
+  free(io);
+  return NULL;
+} /* worker */
+
+/********************************************/
+/* sets dSize from option text "N", "Nk", "NM" or
+   "NG" (locations); returns FALSE if it is bad */
+int setDSize (char * text)
+{ char * end;
+  double n = strtod(text, &end);
+  if (end == text) return FALSE;
+  switch (*end)
+  { case 'k' : case 'K' : n *= 1024.0; end++; break;
+    case 'm' : case 'M' : n *= 1024.0 * 1024.0; end++; break;
+    case 'g' : case 'G' : n *= 1024.0 * 1024.0 * 1024.0; end++; break;
+  }
+  /* 2G is taken as the largest int */
+  if (*end != '\0' || n < 8 || n > (double) INT_MAX + 1.0) return FALSE;
+  dSize = n > (double) INT_MAX ? INT_MAX : (int) n;
+  return TRUE;
+} /* setDSize */
+
+/********************************************/
+int main (int argc, char * argv[])
+{ pthread_t threads[MAX_THREADS];
+  int argi = 1, threadCount = 1, started, i;
+  while (argi < argc && argv[argi][0] == '-')
+  { if (strncmp(argv[argi],"-j",2) == 0 && atoi(argv[argi]+2) > 0)
+      threadCount = atoi(argv[argi]+2);
+    else if (strcmp(argv[argi],"-nofuse") == 0) fuseflag = FALSE;
+    else if (strncmp(argv[argi],"-c",2) == 0 && argv[argi][2] != '\0')
+      startName = argv[argi]+2;
+    else if (strncmp(argv[argi],"-d",2) == 0)
+    { if (! setDSize(argv[argi]+2)) break;
+    }
+    else break;
+    argi++;
+  }
+  if (argc - argi < 2 || (argi < argc && argv[argi][0] == '-'))
+  { fprintf(stderr, "usage: %s [-jN] [-dN[kMG]] [-nofuse] [-cFILE] <program> <input>...\n",
+            argv[0]);
+    exit(1);
+  }
+  if (threadCount > MAX_THREADS) threadCount = MAX_THREADS;
+  prog = tmLoad(argv[argi], fuseflag);
+  if (prog == NULL) exit(1);
+  if (startName != NULL)
+  { FILE * f = fopen(startName, "rb");
+    if (f == NULL)
+    { printf("file '%s' not found\n", startName);
+      exit(1);
+    }
+    start = tmLoadSnapshot(prog, f, startName);
+    fclose(f);
+    if (start == NULL) exit(1);
+  }
+  inputs = argv + argi + 1;
+  inputCount = argc - argi - 1;
+  if (threadCount > inputCount) threadCount = inputCount;
+  for (started = 0 ; started < threadCount ; started++)
+    if (pthread_create(&threads[started], NULL, worker, NULL) != 0) break;
+  if (started == 0) worker(NULL);
+  for (i = 0 ; i < started ; i++) pthread_join(threads[i], NULL);
+  tmFreeSnapshot(start);
+  tmFreeProgram(prog);
+  return failures > 0 ? 1 : 0;
+} /* main */
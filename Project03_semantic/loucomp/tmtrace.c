@@ -0,0 +1,108 @@
+/****************************************************/
+/* File: tmtrace.c                                  */
+/* Decoder of the binary traces of tm (-tFILE)      */
+/****************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tmtrace.h"
+
+/* the opcodes of the TM, by number */
+static char * opCodeTab[]
+        = {"HALT","IN","OUT","ADD","SUB","MUL","DIV","????",
+           "LD","ST","????",
+           "LDA","LDC","JLT","JLE","JGT","JGE","JEQ","JNE","????"
+          };
+
+#define OP_LIMIT 19 /* first number past the opcodes */
+#define OP_LD    8
+#define OP_ST    9
+#define OP_LDA   11
+#define OP_JLT   13
+
+static char * resultTab[]
+        = {"OK","Halted","Instruction Memory Fault",
+           "Data Memory Fault","Division by 0","Illegal value"
+          };
+
+/* Procedure printRecord prints step n of the trace */
+static void printRecord(unsigned long long n, TmtRecord * t)
+{ char * op;
+  printf("%10llu %5d: ", n, t->pc);
+  if (t->op == TMT_NOINSTR || t->op >= OP_LIMIT)
+  { printf("(pc out of iMem)\n");
+    return;
+  }
+  op = opCodeTab[t->op];
+  if (t->op < OP_LD)
+  { printf("%6s%3d,%1d,%1d   ", op, t->r, t->s, t->t);
+    if (t->op == 0) printf("\n");
+    else if (t->op <= 2) printf("r%d = %d\n", t->r, t->value);
+    else printf("r%d = %d   (r%d = %d, r%d = %d)\n", t->r, t->value,
+                t->s, t->a, t->t, t->b);
+    return;
+  }
+  printf("%6s%3d,%3d(%1d)   ", op, t->r, t->d, t->s);
+  if (t->op == OP_LD)
+    printf("r%d = %d <- dMem[%d]\n", t->r, t->value, t->d + t->a);
+  else if (t->op == OP_ST)
+    printf("dMem[%d] <- %d\n", t->d + t->a, t->value);
+  else if (t->op < OP_JLT && t->r != 7)
+    printf("r%d = %d\n", t->r, t->value);
+  else if (t->op < OP_JLT)
+    printf("jump to %d\n", t->next);
+  else if (t->next != t->pc + 1)
+    printf("r%d = %d, jump to %d\n", t->r, t->value, t->next);
+  else printf("r%d = %d, no jump\n", t->r, t->value);
+}
+
+int main(int argc, char * argv[])
+{ FILE * f;
+  TmtHeader h;
+  TmtRecord t;
+  unsigned long long first, n;
+  unsigned i, skip = 0, last = 0;
+  int argi = 1;
+  if (argi < argc && strncmp(argv[argi],"-l",2) == 0)
+  { last = (unsigned) atol(argv[argi]+2);
+    argi++;
+  }
+  if (argi != argc-1)
+  { fprintf(stderr,"usage: %s [-lN] <tracefile>\n",argv[0]);
+    exit(1);
+  }
+  f = fopen(argv[argi],"rb");
+  if (f == NULL)
+  { fprintf(stderr,"file '%s' not found\n",argv[argi]);
+    exit(1);
+  }
+  if (fread(&h,sizeof(h),1,f) != 1 || memcmp(h.magic,TMT_MAGIC,4) != 0)
+  { fprintf(stderr,"%s: not a TM trace\n",argv[argi]);
+    exit(1);
+  }
+  if (h.version != TMT_VERSION)
+  { fprintf(stderr,"%s: trace version %u, expected %d\n",
+            argv[argi],h.version,TMT_VERSION);
+    exit(1);
+  }
+  first = h.steps - h.count + 1;
+  printf("trace of %llu steps, records of steps %llu to %llu, ended: %s\n",
+         h.steps, first, h.steps,
+         h.result < 6 ? resultTab[h.result] : "?");
+  /* only the last N records (-lN) */
+  if (last > 0 && last < h.count)
+  { skip = h.count - last;
+    fseek(f, (long) skip * sizeof(TmtRecord), SEEK_CUR);
+  }
+  n = first + skip;
+  for (i = skip; i < h.count; i++, n++)
+  { if (fread(&t,sizeof(t),1,f) != 1)
+    { fprintf(stderr,"%s: truncated trace\n",argv[argi]);
+      exit(1);
+    }
+    printRecord(n,&t);
+  }
+  fclose(f);
+  return 0;
+}
@@ -0,0 +1,43 @@
+/****************************************************/
+/* File: tmtrace.h                                  */
+/* Binary instruction trace of tm (-tFILE), read    */
+/* by the decoder tmtrace                           */
+/****************************************************/
+
+#ifndef _TMTRACE_H_
+#define _TMTRACE_H_
+
+/* A trace file holds, in the byte order of the
+ * machine that wrote it, a TmtHeader and count
+ * TmtRecord, oldest first. A ring trace keeps the
+ * last steps only: the first record is then step
+ * steps-count+1 of the run
+ */
+#define TMT_MAGIC    "TMT\032"
+#define TMT_VERSION  1
+
+typedef struct
+   { char magic[4];     /* TMT_MAGIC */
+     unsigned version;  /* TMT_VERSION */
+     unsigned count;    /* number of records */
+     unsigned result;   /* STEPRESULT of the last step */
+     unsigned long long steps; /* steps traced in all */
+   } TmtHeader;
+
+/* one step: the instruction at pc as in iMem, the
+ * values of reg(s) and reg(t) before it, the value
+ * of reg(r) after it (ST: the value stored) and the
+ * pc after it. op is TMT_NOINSTR for a pc out of iMem
+ */
+#define TMT_NOINSTR  255
+
+typedef struct
+   { int pc;
+     unsigned char op, r, s, t; /* RM and RA: s is the base */
+     int d;                     /* RM and RA displacement */
+     int a, b;                  /* reg(s), reg(t) before */
+     int value;                 /* reg(r) after */
+     int next;                  /* pc after */
+   } TmtRecord;
+
+#endif
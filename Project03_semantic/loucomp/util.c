@@ -77,6 +77,9 @@ TreeNode * newStmtNode(StmtKind kind)
     t->nodekind = StmtK;
     t->kind.stmt = kind;
     t->lineno = lineno;
+    t->attr.name = NULL;
+    t->type = Void;
+    t->symbol = NULL;
   }
   return t;
 }
@@ -95,7 +98,9 @@ TreeNode * newExpNode(ExpKind kind)
     t->nodekind = ExpK;
     t->kind.exp = kind;
     t->lineno = lineno;
+    t->attr.name = NULL;
     t->type = Void;
+    t->symbol = NULL;
   }
   return t;
 }
@@ -116,7 +121,9 @@ TreeNode * newDeclNode(DeclKind kind)
     t->nodekind = DeclK;
     t->kind.decl = kind;
     t->lineno = lineno;
+    t->attr.name = NULL;
     t->type = Void;
+    t->symbol = NULL;
   }
   return t;
   
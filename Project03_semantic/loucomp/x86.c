@@ -0,0 +1,518 @@
+/****************************************************/
+/* File: x86.c                                      */
+/* x86-64 code generator for the C-Minus compiler   */
+/* (GNU assembler, System V calling convention)     */
+/****************************************************/
+
+#include <stdarg.h>
+#include "globals.h"
+#include "symtab.h"
+#include "ir.h"
+#include "cfg.h"
+#include "regalloc.h"
+#include "x86.h"
+
+/* Every variable cell takes 8 bytes. The frame of
+ * a function, below the saved rbp:
+ *   the callee-saved registers it uses
+ *   the cells of its parameters and locals (an array
+ *     from its lowest address, element i at +8*i)
+ *   the slots of the vregs whose value is stored
+ * Integers are 32 bit and wrap around as on the TM;
+ * array parameters hold 64-bit addresses. The hot
+ * scalar variables live in callee-saved registers
+ * (allocateVars), so they survive calls
+ */
+#define NVARREGS 5
+static char * varReg32[NVARREGS] = { "%ebx", "%r12d", "%r13d", "%r14d", "%r15d" };
+static char * varReg64[NVARREGS] = { "%rbx", "%r12", "%r13", "%r14", "%r15" };
+static int varRegs[NVARREGS] = { 0, 1, 2, 3, 4 };
+
+/* registers of the first six arguments */
+static char * argReg32[6] = { "%edi", "%esi", "%edx", "%ecx", "%r8d", "%r9d" };
+static char * argReg64[6] = { "%rdi", "%rsi", "%rdx", "%rcx", "%r8", "%r9" };
+
+/* condition codes of IrLt..IrNe and of their negations */
+static char * cc[] = { "l", "le", "g", "ge", "e", "ne" };
+static char * notCc[] = { "ge", "g", "le", "l", "ne", "e" };
+
+/* the function being translated */
+static IrFunction * fn;
+static Cfg * graph;
+static Allocation * alloc;
+static int saved; /* number of callee-saved registers used */
+static int slots; /* number of vreg slots */
+static int divUsed; /* TRUE if a division by zero check jumps out */
+
+/* what a vreg is: */
+typedef enum
+   { Const,   /* the constant val[v]                         */
+     Var,     /* the value of variable sym[v], read lazily   */
+     Addr,    /* the address of array sym[v]                 */
+     Index,   /* address ia[v] + 8 * (vreg ib[v])            */
+     Slot     /* stored in slot slot[v]                      */
+   } Kind;
+
+static Kind * kind;
+static int * val, * ia, * ib, * slot, * isPtr, * lastUse;
+static BucketList * sym;
+
+/* the vreg whose value is in eax only, -1 if none */
+static int cached;
+
+/* the vregs of the current block that are lazily read
+ * variables
+ */
+static int * lazy;
+static int lazyCount;
+
+/* Procedure out writes a line of assembly */
+static void out(const char * fmt, ...)
+{ va_list ap;
+  va_start(ap, fmt);
+  vfprintf(code, fmt, ap);
+  va_end(ap);
+  fputc('\n', code);
+}
+
+/* Function buffer returns one of a few rotating
+ * buffers for operand text
+ */
+static char * buffer(void)
+{ static char bufs[6][80];
+  static int n = 0;
+  n = (n + 1) % 6;
+  return bufs[n];
+}
+
+/* Function varIndex returns the register number of
+ * variable s, -1 if it is in memory
+ */
+static int varIndex(BucketList s)
+{ int v = s->nestedLevel > 0 ? cfgVarIndex(graph,s) : -1;
+  return v >= 0 ? alloc->reg[v] : -1;
+}
+
+/* Function cell returns the memory operand of cell
+ * i of variable s (element i of an array)
+ */
+static char * cell(BucketList s, int i)
+{ char * b = buffer();
+  if (s->nestedLevel == 0)
+    sprintf(b,"cmg_%s+%d(%%rip)",s->name,8*i);
+  else
+    sprintf(b,"%d(%%rbp)",-8*(saved + s->memloc + s->size) + 8*i);
+  return b;
+}
+
+/* Function varOperand returns the operand of scalar
+ * variable s (wide: 64-bit)
+ */
+static char * varOperand(BucketList s, int wide)
+{ int r = varIndex(s);
+  if (r >= 0) return wide ? varReg64[r] : varReg32[r];
+  return cell(s,0);
+}
+
+/* Function slotOperand returns the operand of slot n */
+static char * slotOperand(int n)
+{ char * b = buffer();
+  sprintf(b,"%d(%%rbp)",-8*(saved + fn->frameSize + n + 1));
+  return b;
+}
+
+/* Function operand returns the operand text of a
+ * Const, Var or Slot vreg v
+ */
+static char * operand(int v)
+{ char * b;
+  switch (kind[v])
+  { case Const :
+      b = buffer();
+      sprintf(b,"$%d",val[v]);
+      return b;
+    case Var :
+      return varOperand(sym[v],isPtr[v]);
+    default :
+      return slotOperand(slot[v]);
+  }
+}
+
+/* Function address returns the memory operand of
+ * the cell k after address vreg a; it may use rax
+ * and r10, which carry no arguments
+ */
+static char * address(int a, int k)
+{ char * b = buffer();
+  int base = kind[a] == Index ? ia[a] : a;
+  char * breg;
+  int d = 8 * k;
+  /* the base, as displacement d from register breg */
+  if (kind[base] == Addr && sym[base]->nestedLevel > 0)
+  { d += -8*(saved + sym[base]->memloc + sym[base]->size);
+    breg = "%rbp";
+  }
+  else if (kind[base] == Addr)
+  { out("\tleaq\tcmg_%s(%%rip), %%rax",sym[base]->name);
+    breg = "%rax";
+  }
+  else if (kind[base] == Var && varIndex(sym[base]) >= 0)
+    breg = varReg64[varIndex(sym[base])];
+  else
+  { out("\tmovq\t%s, %%rax",operand(base));
+    breg = "%rax";
+  }
+  if (kind[a] != Index)
+  { sprintf(b,"%d(%s)",d,breg);
+    return b;
+  }
+  if (kind[ib[a]] == Const) out("\tmovq\t$%d, %%r10",val[ib[a]]);
+  else out("\tmovslq\t%s, %%r10",operand(ib[a]));
+  sprintf(b,"%d(%s,%%r10,8)",d,breg);
+  return b;
+}
+
+/* Procedure load puts the value of vreg v into the
+ * register named r32/r64
+ */
+static void load(int v, char * r32, char * r64)
+{ if (v == cached && strcmp(r32,"%eax") == 0) return;
+  if (v == cached) out("\tmovl\t%%eax, %s",r32);
+  else if (kind[v] == Addr || kind[v] == Index)
+  { char * a = address(v,0);
+    out("\tleaq\t%s, %s",a,r64);
+  }
+  else if (isPtr[v]) out("\tmovq\t%s, %s",operand(v),r64);
+  else out("\tmovl\t%s, %s",operand(v),r32);
+}
+
+/* Procedure materialize stores the value of a lazily
+ * read variable v in a slot, before the variable
+ * changes
+ */
+static void materialize(int v)
+{ char * r = isPtr[v] ? "%r11" : "%r11d";
+  out(isPtr[v] ? "\tmovq\t%s, %s" : "\tmovl\t%s, %s",operand(v),r);
+  slot[v] = slots++;
+  kind[v] = Slot;
+  out(isPtr[v] ? "\tmovq\t%s, %s" : "\tmovl\t%s, %s",r,slotOperand(slot[v]));
+}
+
+/* Procedure changing materializes the live lazy
+ * reads of variable s (NULL: of all globals) before
+ * instruction j changes it
+ */
+static void changing(BucketList s, int j)
+{ int i, v;
+  for (i = 0; i < lazyCount; i++)
+  { v = lazy[i];
+    if (kind[v] != Var || lastUse[v] <= j) continue;
+    if (s == NULL ? sym[v]->nestedLevel == 0 : sym[v] == s) materialize(v);
+  }
+}
+
+/* Procedure result records that the value of vreg v
+ * is in eax; it is kept only there when the next
+ * instruction uses it at once
+ */
+static void result(int v, int b, int j)
+{ IrBlock * bl = &fn->blocks[b];
+  IrInstr * next = j + 1 < bl->count ? &bl->code[j+1] : NULL;
+  kind[v] = Slot;
+  isPtr[v] = FALSE;
+  if (next != NULL && lastUse[v] == j + 1 &&
+      ((next->a == v && next->b != v &&
+        (next->op == IrCopy || (next->op >= IrAdd && next->op <= IrNe) ||
+         next->op == IrSetVar || next->op == IrOutput ||
+         next->op == IrBranch || next->op == IrReturn)) ||
+       (next->op == IrStore && next->b == v && next->a != v)))
+  { cached = v;
+    return;
+  }
+  slot[v] = slots++;
+  out("\tmovl\t%%eax, %s",slotOperand(slot[v]));
+}
+
+/* the callee-saved registers used, as a mask */
+static int usedMask;
+
+/* Procedure restore returns from the function */
+static void restore(void)
+{ int i = 0, r;
+  for (r = 0; r < NVARREGS; r++)
+    if (usedMask & (1 << r))
+      out("\tmovq\t%d(%%rbp), %s",-8*(++i),varReg64[r]);
+  out("\tleave");
+  out("\tret");
+}
+
+/* Procedure genCall translates the Call at j and
+ * the Args before it
+ */
+static void genCall(int b, int j)
+{ IrInstr * code = fn->blocks[b].code, * in = &code[j];
+  int n = in->k, i, v, stack = n > 6 ? n - 6 : 0, pad = stack % 2;
+  changing(NULL,j);
+  if (pad) out("\tsubq\t$8, %%rsp");
+  for (i = n - 1; i >= 6; i--)
+  { v = code[j-n+i].a;
+    load(v,"%eax","%rax");
+    out("\tpushq\t%%rax");
+  }
+  for (i = 0; i < n && i < 6; i++)
+    load(code[j-n+i].a,argReg32[i],argReg64[i]);
+  out("\tcall\tcm_%s",in->sym->name);
+  if (stack + pad > 0) out("\taddq\t$%d, %%rsp",8*(stack+pad));
+  if (in->dst >= 0) result(in->dst,b,j);
+}
+
+/* Procedure genInstr translates instruction j of
+ * block b
+ */
+static void genInstr(int b, int j)
+{ IrInstr * in = &fn->blocks[b].code[j];
+  char * a, * op;
+  int v = in->dst, r;
+  switch (in->op)
+  { case IrConst :
+      kind[v] = Const;
+      val[v] = in->k;
+      isPtr[v] = FALSE;
+      break;
+    case IrGetVar :
+      kind[v] = Var;
+      sym[v] = in->sym;
+      isPtr[v] = in->sym->type == IntegerArray;
+      lazy[lazyCount++] = v;
+      break;
+    case IrAddr :
+      kind[v] = Addr;
+      sym[v] = in->sym;
+      isPtr[v] = TRUE;
+      break;
+    case IrCopy :
+      load(in->a,"%eax","%rax");
+      result(v,b,j);
+      break;
+    case IrAdd :
+      if (isPtr[in->a])
+      { /* element address of an array */
+        kind[v] = Index;
+        ia[v] = in->a;
+        ib[v] = in->b;
+        isPtr[v] = TRUE;
+        break;
+      }
+      /* fall through */
+    case IrSub :
+    case IrMul :
+      load(in->a,"%eax","%rax");
+      op = in->op == IrAdd ? "addl" : in->op == IrSub ? "subl" : "imull";
+      out("\t%s\t%s, %%eax",op,in->b == cached ? "%eax" : operand(in->b));
+      result(v,b,j);
+      break;
+    case IrDiv :
+      load(in->b,"%ecx","%rcx");
+      load(in->a,"%eax","%rax");
+      out("\ttestl\t%%ecx, %%ecx");
+      out("\tje\t.L%s_div",fn->sym->name);
+      out("\tcltd");
+      out("\tidivl\t%%ecx");
+      divUsed = TRUE;
+      result(v,b,j);
+      break;
+    case IrLt : case IrLe : case IrGt : case IrGe : case IrEq : case IrNe :
+      /* the TM compares the wrapped difference with 0 */
+      load(in->a,"%eax","%rax");
+      out("\tsubl\t%s, %%eax",operand(in->b));
+      out("\ttestl\t%%eax, %%eax");
+      out("\tset%s\t%%al",cc[in->op - IrLt]);
+      out("\tmovzbl\t%%al, %%eax");
+      result(v,b,j);
+      break;
+    case IrSetVar :
+      changing(in->sym,j);
+      r = varIndex(in->sym);
+      if (in->a != cached && (r >= 0 || kind[in->a] == Const ||
+                              (kind[in->a] == Var && varIndex(sym[in->a]) >= 0)))
+        out("\tmovl\t%s, %s",operand(in->a),varOperand(in->sym,FALSE));
+      else
+      { load(in->a,"%eax","%rax");
+        out("\tmovl\t%%eax, %s",varOperand(in->sym,FALSE));
+      }
+      break;
+    case IrLoad :
+      a = address(in->a,in->k);
+      out("\tmovl\t%s, %%eax",a);
+      result(v,b,j);
+      break;
+    case IrStore :
+      if (kind[in->b] == Const ||
+          (kind[in->b] == Var && varIndex(sym[in->b]) >= 0))
+      { a = address(in->a,in->k);
+        out("\tmovl\t%s, %s",operand(in->b),a);
+      }
+      else
+      { load(in->b,"%edx","%rdx");
+        a = address(in->a,in->k);
+        out("\tmovl\t%%edx, %s",a);
+      }
+      break;
+    case IrInput :
+      out("\tcall\tcm_input");
+      result(v,b,j);
+      break;
+    case IrOutput :
+      load(in->a,"%edi","%rdi");
+      out("\tcall\tcm_output");
+      break;
+    case IrArg :
+      break;
+    case IrCall :
+      genCall(b,j);
+      break;
+    case IrJump :
+      if (in->target != b + 1) out("\tjmp\t.L%s_%d",fn->sym->name,in->target);
+      break;
+    case IrBranch :
+      load(in->a,"%eax","%rax");
+      if (in->b >= 0) out("\tsubl\t%s, %%eax",operand(in->b));
+      out("\ttestl\t%%eax, %%eax");
+      if (in->target == b + 1)
+        out("\tj%s\t.L%s_%d",notCc[in->k - IrLt],fn->sym->name,in->other);
+      else
+      { out("\tj%s\t.L%s_%d",cc[in->k - IrLt],fn->sym->name,in->target);
+        if (in->other != b + 1) out("\tjmp\t.L%s_%d",fn->sym->name,in->other);
+      }
+      break;
+    case IrReturn :
+      if (in->a >= 0) load(in->a,"%eax","%rax");
+      restore();
+      break;
+  }
+}
+
+/* Procedure genFunc translates function f */
+static void genFunc(IrFunction * f)
+{ int n = f->vregs + 1, b, j, i, r, v, inReg;
+  char * home;
+  TreeNode * p;
+  BucketList s;
+  IrInstr * in;
+  fn = f;
+  graph = cfgBuild(f);
+  cfgLiveness(graph);
+  alloc = allocateVars(graph,varRegs,NVARREGS,FALSE);
+  if (TraceIR) printAllocation(listing,graph,alloc);
+  usedMask = 0;
+  for (v = 0; v < alloc->vars; v++)
+    if (alloc->reg[v] >= 0) usedMask |= 1 << alloc->reg[v];
+  for (saved = 0, r = 0; r < NVARREGS; r++)
+    if (usedMask & (1 << r)) saved++;
+  kind = (Kind *) calloc(n, sizeof(Kind));
+  val = (int *) calloc(n, sizeof(int));
+  ia = (int *) calloc(n, sizeof(int));
+  ib = (int *) calloc(n, sizeof(int));
+  slot = (int *) calloc(n, sizeof(int));
+  isPtr = (int *) calloc(n, sizeof(int));
+  lastUse = (int *) calloc(n, sizeof(int));
+  sym = (BucketList *) calloc(n, sizeof(BucketList));
+  lazy = (int *) malloc(n * sizeof(int));
+  slots = 0;
+  divUsed = FALSE;
+  out("");
+  out("\t.globl\tcm_%s",f->sym->name);
+  out("\t.type\tcm_%s, @function",f->sym->name);
+  out("cm_%s:",f->sym->name);
+  out("\tpushq\t%%rbp");
+  out("\tmovq\t%%rsp, %%rbp");
+  out("\tsubq\t$.L%s_frame, %%rsp",f->sym->name);
+  for (i = 0, r = 0; r < NVARREGS; r++)
+    if (usedMask & (1 << r)) out("\tmovq\t%s, %d(%%rbp)",varReg64[r],-8*(++i));
+  /* parameters come in registers, then on the stack.
+   * The interval of a parameter written before it is
+   * read starts at that write, so its register may be
+   * another live parameter's: it goes to its cell
+   */
+  for (i = 0, p = f->tree->child[0]; p != NULL; p = p->sibling)
+  { if ((s = p->symbol) == NULL) continue;
+    r = s->type == IntegerArray;
+    inReg = varIndex(s) >= 0 && bsHas(graph->liveIn[0],cfgVarIndex(graph,s));
+    home = inReg ? varOperand(s,r) : cell(s,0);
+    if (i < 6)
+      out(r ? "\tmovq\t%s, %s" : "\tmovl\t%s, %s",
+          r ? argReg64[i] : argReg32[i],home);
+    else if (inReg)
+      out(r ? "\tmovq\t%d(%%rbp), %s" : "\tmovl\t%d(%%rbp), %s",
+          16+8*(i-6),home);
+    else
+    { out(r ? "\tmovq\t%d(%%rbp), %%rax" : "\tmovl\t%d(%%rbp), %%eax",16+8*(i-6));
+      out(r ? "\tmovq\t%%rax, %s" : "\tmovl\t%%eax, %s",home);
+    }
+    i++;
+  }
+  for (b = 0; b < f->blockCount; b++)
+  { IrBlock * bl = &f->blocks[b];
+    for (j = 0; j < bl->count; j++)
+    { in = &bl->code[j];
+      if (in->a >= 0) lastUse[in->a] = j;
+      if (in->b >= 0) lastUse[in->b] = j;
+      if (in->dst >= 0) lastUse[in->dst] = j;
+    }
+    /* the parts of an element address live as long as it */
+    for (j = 0; j < bl->count; j++)
+    { in = &bl->code[j];
+      if (in->op == IrAdd && lastUse[in->dst] > lastUse[in->a])
+        lastUse[in->a] = lastUse[in->dst];
+      if (in->op == IrAdd && lastUse[in->dst] > lastUse[in->b])
+        lastUse[in->b] = lastUse[in->dst];
+    }
+    out(".L%s_%d:",f->sym->name,b);
+    cached = -1;
+    lazyCount = 0;
+    for (j = 0; j < bl->count; j++)
+    { int keep;
+      genInstr(b,j);
+      keep = bl->code[j].dst >= 0 && cached == bl->code[j].dst;
+      if (!keep) cached = -1;
+    }
+  }
+  if (divUsed)
+  { out(".L%s_div:",f->sym->name);
+    out("\tcall\tcm_divzero");
+  }
+  out("\t.set\t.L%s_frame, %d",f->sym->name,
+      16 * ((8 * (saved + f->frameSize + slots) + 15) / 16));
+  out("\t.size\tcm_%s, .-cm_%s",f->sym->name,f->sym->name);
+  free(kind); free(val); free(ia); free(ib); free(slot);
+  free(isPtr); free(lastUse); free(sym); free(lazy);
+  freeAllocation(alloc);
+  cfgFree(graph);
+}
+
+/* Procedure x86CodeGen generates x86-64 assembly
+ * for the syntax tree to the code file
+ */
+void x86CodeGen(TreeNode * syntaxTree, char * codefile)
+{ IrProgram * p = irBuild(syntaxTree);
+  TreeNode * t;
+  int i;
+  if (TraceIR)
+  { fprintf(listing,"\nIntermediate code:\n");
+    irPrint(listing,p);
+  }
+  if (irVerify(p) > 0)
+  { Error = TRUE;
+    irFree(p);
+    return;
+  }
+  out("# C-MINUS Compilation to x86-64 assembly");
+  out("# File: %s",codefile);
+  out("\t.text");
+  for (i = 0; i < p->count; i++) genFunc(&p->funcs[i]);
+  for (t = syntaxTree; t != NULL; t = t->sibling)
+    if (t->nodekind == DeclK && t->kind.decl == VarK && t->symbol != NULL)
+      out("\t.comm\tcmg_%s,%d,8",t->symbol->name,8 * t->symbol->size);
+  out("\t.section\t.note.GNU-stack,\"\",@progbits");
+  irFree(p);
+}
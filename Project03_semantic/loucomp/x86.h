@@ -0,0 +1,18 @@
+/****************************************************/
+/* File: x86.h                                      */
+/* x86-64 code generator for the C-Minus compiler   */
+/* (GNU assembler, System V calling convention)     */
+/****************************************************/
+
+#ifndef _X86_H_
+#define _X86_H_
+
+/* Procedure x86CodeGen generates GNU assembly for
+ * x86-64 to the code file by way of the IR. The
+ * functions are named cm_<name>; the program is
+ * linked with the runtime cmrt.c, which supplies
+ * main, input and output
+ */
+void x86CodeGen(TreeNode * syntaxTree, char * codefile);
+
+#endif
@@ -0,0 +1,2113 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 0
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
+#line 7 "cminus.y"
+
+#define YYPARSER /* distinguishes Yacc output from other code files */
+
+#include "globals.h"
+#include "util.h"
+#include "scan.h"
+#include "parse.h"
+
+#define YYSTYPE TreeNode *
+static char * savedName; /* for use in assignments */
+static int savedNum;
+static int savedLineNo;  /* ditto */
+static TreeNode * savedTree; /* stores syntax tree for later return */
+
+
+static int yylex(void);
+
+#line 89 "y.tab.c"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+/* Use api.header.include to #include this header
+   instead of duplicating it here.  */
+#ifndef YY_YY_Y_TAB_H_INCLUDED
+# define YY_YY_Y_TAB_H_INCLUDED
+/* Debug traces.  */
+#ifndef YYDEBUG
+# define YYDEBUG 0
+#endif
+#if YYDEBUG
+extern int yydebug;
+#endif
+
+/* Token kinds.  */
+#ifndef YYTOKENTYPE
+# define YYTOKENTYPE
+  enum yytokentype
+  {
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    IF = 258,                      /* IF  */
+    WHILE = 259,                   /* WHILE  */
+    RETURN = 260,                  /* RETURN  */
+    INT = 261,                     /* INT  */
+    VOID = 262,                    /* VOID  */
+    RPAREN = 263,                  /* RPAREN  */
+    ELSE = 264,                    /* ELSE  */
+    ID = 265,                      /* ID  */
+    NUM = 266,                     /* NUM  */
+    EQ = 267,                      /* EQ  */
+    NE = 268,                      /* NE  */
+    LT = 269,                      /* LT  */
+    LE = 270,                      /* LE  */
+    GT = 271,                      /* GT  */
+    GE = 272,                      /* GE  */
+    LPAREN = 273,                  /* LPAREN  */
+    LBRACE = 274,                  /* LBRACE  */
+    RBRACE = 275,                  /* RBRACE  */
+    LCURLY = 276,                  /* LCURLY  */
+    RCURLY = 277,                  /* RCURLY  */
+    COMMA = 278,                   /* COMMA  */
+    SEMI = 279,                    /* SEMI  */
+    ERROR = 280,                   /* ERROR  */
+    PLUS = 281,                    /* PLUS  */
+    MINUS = 282,                   /* MINUS  */
+    TIMES = 283,                   /* TIMES  */
+    OVER = 284,                    /* OVER  */
+    ASSIGN = 285                   /* ASSIGN  */
+  };
+  typedef enum yytokentype yytoken_kind_t;
+#endif
+/* Token kinds.  */
+#define YYEMPTY -2
+#define YYEOF 0
+#define YYerror 256
+#define YYUNDEF 257
+#define IF 258
+#define WHILE 259
+#define RETURN 260
+#define INT 261
+#define VOID 262
+#define RPAREN 263
+#define ELSE 264
+#define ID 265
+#define NUM 266
+#define EQ 267
+#define NE 268
+#define LT 269
+#define LE 270
+#define GT 271
+#define GE 272
+#define LPAREN 273
+#define LBRACE 274
+#define RBRACE 275
+#define LCURLY 276
+#define RCURLY 277
+#define COMMA 278
+#define SEMI 279
+#define ERROR 280
+#define PLUS 281
+#define MINUS 282
+#define TIMES 283
+#define OVER 284
+#define ASSIGN 285
+
+/* Value type.  */
+#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
+typedef int YYSTYPE;
+# define YYSTYPE_IS_TRIVIAL 1
+# define YYSTYPE_IS_DECLARED 1
+#endif
+
+
+extern YYSTYPE yylval;
+
+
+int yyparse (void);
+
+
+#endif /* !YY_YY_Y_TAB_H_INCLUDED  */
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_IF = 3,                         /* IF  */
+  YYSYMBOL_WHILE = 4,                      /* WHILE  */
+  YYSYMBOL_RETURN = 5,                     /* RETURN  */
+  YYSYMBOL_INT = 6,                        /* INT  */
+  YYSYMBOL_VOID = 7,                       /* VOID  */
+  YYSYMBOL_RPAREN = 8,                     /* RPAREN  */
+  YYSYMBOL_ELSE = 9,                       /* ELSE  */
+  YYSYMBOL_ID = 10,                        /* ID  */
+  YYSYMBOL_NUM = 11,                       /* NUM  */
+  YYSYMBOL_EQ = 12,                        /* EQ  */
+  YYSYMBOL_NE = 13,                        /* NE  */
+  YYSYMBOL_LT = 14,                        /* LT  */
+  YYSYMBOL_LE = 15,                        /* LE  */
+  YYSYMBOL_GT = 16,                        /* GT  */
+  YYSYMBOL_GE = 17,                        /* GE  */
+  YYSYMBOL_LPAREN = 18,                    /* LPAREN  */
+  YYSYMBOL_LBRACE = 19,                    /* LBRACE  */
+  YYSYMBOL_RBRACE = 20,                    /* RBRACE  */
+  YYSYMBOL_LCURLY = 21,                    /* LCURLY  */
+  YYSYMBOL_RCURLY = 22,                    /* RCURLY  */
+  YYSYMBOL_COMMA = 23,                     /* COMMA  */
+  YYSYMBOL_SEMI = 24,                      /* SEMI  */
+  YYSYMBOL_ERROR = 25,                     /* ERROR  */
+  YYSYMBOL_PLUS = 26,                      /* PLUS  */
+  YYSYMBOL_MINUS = 27,                     /* MINUS  */
+  YYSYMBOL_TIMES = 28,                     /* TIMES  */
+  YYSYMBOL_OVER = 29,                      /* OVER  */
+  YYSYMBOL_ASSIGN = 30,                    /* ASSIGN  */
+  YYSYMBOL_YYACCEPT = 31,                  /* $accept  */
+  YYSYMBOL_program = 32,                   /* program  */
+  YYSYMBOL_declaration_list = 33,          /* declaration_list  */
+  YYSYMBOL_declaration = 34,               /* declaration  */
+  YYSYMBOL_identifier = 35,                /* identifier  */
+  YYSYMBOL_number = 36,                    /* number  */
+  YYSYMBOL_type_specifier = 37,            /* type_specifier  */
+  YYSYMBOL_var_declaration = 38,           /* var_declaration  */
+  YYSYMBOL_fun_declaration = 39,           /* fun_declaration  */
+  YYSYMBOL_params = 40,                    /* params  */
+  YYSYMBOL_param_list = 41,                /* param_list  */
+  YYSYMBOL_param = 42,                     /* param  */
+  YYSYMBOL_compound_stmt = 43,             /* compound_stmt  */
+  YYSYMBOL_local_declarations = 44,        /* local_declarations  */
+  YYSYMBOL_statement_list = 45,            /* statement_list  */
+  YYSYMBOL_statement = 46,                 /* statement  */
+  YYSYMBOL_expression_stmt = 47,           /* expression_stmt  */
+  YYSYMBOL_selection_stmt = 48,            /* selection_stmt  */
+  YYSYMBOL_iteration_stmt = 49,            /* iteration_stmt  */
+  YYSYMBOL_return_stmt = 50,               /* return_stmt  */
+  YYSYMBOL_expression = 51,                /* expression  */
+  YYSYMBOL_var = 52,                       /* var  */
+  YYSYMBOL_simple_expression = 53,         /* simple_expression  */
+  YYSYMBOL_relop = 54,                     /* relop  */
+  YYSYMBOL_additive_expression = 55,       /* additive_expression  */
+  YYSYMBOL_addop = 56,                     /* addop  */
+  YYSYMBOL_term = 57,                      /* term  */
+  YYSYMBOL_mulop = 58,                     /* mulop  */
+  YYSYMBOL_factor = 59,                    /* factor  */
+  YYSYMBOL_call = 60,                      /* call  */
+  YYSYMBOL_args = 61,                      /* args  */
+  YYSYMBOL_arg_list = 62                   /* arg_list  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* !defined yyoverflow */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  9
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   96
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  31
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  32
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  65
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  104
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   285
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
+      25,    26,    27,    28,    29,    30
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
+{
+       0,    38,    38,    40,    49,    52,    53,    56,    64,    72,
+      77,    84,    92,   111,   123,   124,   132,   142,   145,   152,
+     161,   171,   182,   187,   200,   206,   207,   208,   209,   210,
+     214,   218,   225,   233,   244,   254,   259,   268,   275,   281,
+     287,   298,   306,   313,   317,   320,   323,   326,   329,   335,
+     343,   350,   351,   355,   363,   370,   371,   375,   379,   383,
+     387,   397,   407,   409,   415,   424
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "IF", "WHILE",
+  "RETURN", "INT", "VOID", "RPAREN", "ELSE", "ID", "NUM", "EQ", "NE", "LT",
+  "LE", "GT", "GE", "LPAREN", "LBRACE", "RBRACE", "LCURLY", "RCURLY",
+  "COMMA", "SEMI", "ERROR", "PLUS", "MINUS", "TIMES", "OVER", "ASSIGN",
+  "$accept", "program", "declaration_list", "declaration", "identifier",
+  "number", "type_specifier", "var_declaration", "fun_declaration",
+  "params", "param_list", "param", "compound_stmt", "local_declarations",
+  "statement_list", "statement", "expression_stmt", "selection_stmt",
+  "iteration_stmt", "return_stmt", "expression", "var",
+  "simple_expression", "relop", "additive_expression", "addop", "term",
+  "mulop", "factor", "call", "args", "arg_list", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-92)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-16)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int8 yypact[] =
+{
+       1,   -92,   -92,     9,     1,   -92,    18,   -92,   -92,   -92,
+     -92,   -92,    32,    36,    38,   -92,    45,    18,    61,    48,
+     -92,   -92,    50,    53,    54,     1,    52,    57,   -92,   -92,
+     -92,   -92,   -92,     1,    18,   -92,    12,   -14,    60,    62,
+      30,   -92,     3,   -92,   -92,    28,   -92,   -92,   -92,   -92,
+     -92,   -92,    55,    51,   -92,    47,    37,   -92,   -92,     3,
+       3,   -92,    58,    75,     3,     3,   -92,     3,   -92,   -92,
+     -92,   -92,   -92,   -92,   -92,   -92,     3,     3,   -92,   -92,
+       3,    76,    77,   -92,   -92,   -92,    78,    64,    68,   -92,
+     -92,    41,    37,   -92,    34,    34,   -92,     3,   -92,    80,
+     -92,   -92,    34,   -92
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       0,     9,    10,     0,     2,     4,     0,     5,     6,     1,
+       3,     7,     0,     0,     0,    11,    10,     0,     0,    14,
+      17,     8,     0,    18,     0,     0,     0,     0,    22,    13,
+      16,    12,    19,    24,     0,    21,     0,     0,     0,     0,
+       0,    60,     0,    20,    31,    39,    26,    23,    25,    27,
+      28,    29,     0,    58,    38,    42,    50,    54,    59,     0,
+       0,    35,     0,     0,    63,     0,    30,     0,    43,    44,
+      45,    46,    47,    48,    51,    52,     0,     0,    55,    56,
+       0,     0,     0,    36,    57,    65,     0,    62,     0,    37,
+      58,    41,    49,    53,     0,     0,    61,     0,    40,    33,
+      34,    64,     0,    32
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int8 yypgoto[] =
+{
+     -92,   -92,   -92,    86,    -5,   -92,    -7,    59,   -92,   -92,
+     -92,    66,    69,   -92,   -92,   -91,   -92,   -92,   -92,   -92,
+     -40,   -45,   -92,   -92,    19,   -92,    17,   -92,    16,   -92,
+     -92,   -92
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int8 yydefgoto[] =
+{
+       0,     3,     4,     5,    45,    22,     6,     7,     8,    18,
+      19,    20,    46,    33,    36,    47,    48,    49,    50,    51,
+      52,    53,    54,    76,    55,    77,    56,    80,    57,    58,
+      86,    87
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int8 yytable[] =
+{
+      62,    12,    63,    99,   100,    14,    17,     1,     2,     9,
+      15,   103,    23,    11,    41,    38,    39,    40,    17,    81,
+      82,    42,    11,    41,    85,    88,    34,    89,    11,    37,
+      42,    90,    90,    28,    43,    90,    44,    38,    39,    40,
+      11,    41,     1,    16,    11,    41,    64,    65,    42,    21,
+      13,    14,    42,   -15,    61,    28,    15,   101,    44,    68,
+      69,    70,    71,    72,    73,    78,    79,    74,    75,    24,
+      26,    25,    27,    74,    75,    28,    31,    32,    59,    66,
+      60,    67,    83,    84,    94,    95,    96,    97,    98,   102,
+      10,    30,    35,    29,    92,    91,    93
+};
+
+static const yytype_int8 yycheck[] =
+{
+      40,     6,    42,    94,    95,    19,    13,     6,     7,     0,
+      24,   102,    17,    10,    11,     3,     4,     5,    25,    59,
+      60,    18,    10,    11,    64,    65,    33,    67,    10,    34,
+      18,    76,    77,    21,    22,    80,    24,     3,     4,     5,
+      10,    11,     6,     7,    10,    11,    18,    19,    18,    11,
+      18,    19,    18,     8,    24,    21,    24,    97,    24,    12,
+      13,    14,    15,    16,    17,    28,    29,    26,    27,     8,
+      20,    23,    19,    26,    27,    21,    24,    20,    18,    24,
+      18,    30,    24,     8,     8,     8,     8,    23,    20,     9,
+       4,    25,    33,    24,    77,    76,    80
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
+{
+       0,     6,     7,    32,    33,    34,    37,    38,    39,     0,
+      34,    10,    35,    18,    19,    24,     7,    37,    40,    41,
+      42,    11,    36,    35,     8,    23,    20,    19,    21,    43,
+      42,    24,    20,    44,    37,    38,    45,    35,     3,     4,
+       5,    11,    18,    22,    24,    35,    43,    46,    47,    48,
+      49,    50,    51,    52,    53,    55,    57,    59,    60,    18,
+      18,    24,    51,    51,    18,    19,    24,    30,    12,    13,
+      14,    15,    16,    17,    26,    27,    54,    56,    28,    29,
+      58,    51,    51,    24,     8,    51,    61,    62,    51,    51,
+      52,    55,    57,    59,     8,     8,     8,    23,    20,    46,
+      46,    51,     9,    46
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    31,    32,    33,    33,    34,    34,    35,    36,    37,
+      37,    38,    38,    39,    40,    40,    41,    41,    42,    42,
+      43,    44,    44,    45,    45,    46,    46,    46,    46,    46,
+      47,    47,    48,    48,    49,    50,    50,    51,    51,    52,
+      52,    53,    53,    54,    54,    54,    54,    54,    54,    55,
+      55,    56,    56,    57,    57,    58,    58,    59,    59,    59,
+      59,    60,    61,    61,    62,    62
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     1,     2,     1,     1,     1,     1,     1,     1,
+       1,     3,     6,     6,     1,     1,     3,     1,     2,     4,
+       4,     2,     0,     2,     0,     1,     1,     1,     1,     1,
+       2,     1,     7,     5,     5,     2,     3,     3,     1,     1,
+       4,     3,     1,     1,     1,     1,     1,     1,     1,     3,
+       1,     1,     1,     3,     1,     1,     1,     3,     1,     1,
+       1,     4,     1,     0,     3,     1
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)]);
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+
+
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
+{
+  YY_USE (yyvaluep);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/* Lookahead token kind.  */
+int yychar;
+
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Number of syntax errors so far.  */
+int yynerrs;
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (void)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* program: declaration_list  */
+#line 38 "cminus.y"
+                           { savedTree = yyvsp[0];}
+#line 1308 "y.tab.c"
+    break;
+
+  case 3: /* declaration_list: declaration_list declaration  */
+#line 41 "cminus.y"
+                    {YYSTYPE t = yyvsp[-1];
+                    if (t != NULL)
+                    { while (t->sibling != NULL)
+                        t = t->sibling;
+                        t->sibling = yyvsp[0];
+                        yyval = yyvsp[-1]; 
+                    } else yyval = yyvsp[0];
+                    }
+#line 1321 "y.tab.c"
+    break;
+
+  case 4: /* declaration_list: declaration  */
+#line 49 "cminus.y"
+                                  {yyval = yyvsp[0];}
+#line 1327 "y.tab.c"
+    break;
+
+  case 5: /* declaration: var_declaration  */
+#line 52 "cminus.y"
+                              { yyval = yyvsp[0]; }
+#line 1333 "y.tab.c"
+    break;
+
+  case 6: /* declaration: fun_declaration  */
+#line 53 "cminus.y"
+                              {yyval = yyvsp[0];}
+#line 1339 "y.tab.c"
+    break;
+
+  case 7: /* identifier: ID  */
+#line 57 "cminus.y"
+            {
+                yyval = newExpNode(IdK);
+                yyval->attr.name = copyString(tokenString);
+                yyval->lineno = lineno;
+            }
+#line 1349 "y.tab.c"
+    break;
+
+  case 8: /* number: NUM  */
+#line 65 "cminus.y"
+        {
+            yyval = newExpNode(ConstK); 
+            yyval->attr.val = atoi(tokenString);
+            yyval->type = Integer;
+        }
+#line 1359 "y.tab.c"
+    break;
+
+  case 9: /* type_specifier: INT  */
+#line 73 "cminus.y"
+                {
+                    yyval = newExpNode(TypeK);
+                    yyval->type = Integer;
+                }
+#line 1368 "y.tab.c"
+    break;
+
+  case 10: /* type_specifier: VOID  */
+#line 78 "cminus.y"
+                {
+                    yyval = newExpNode(TypeK);
+                    yyval->type = Void;
+                }
+#line 1377 "y.tab.c"
+    break;
+
+  case 11: /* var_declaration: type_specifier identifier SEMI  */
+#line 85 "cminus.y"
+                {
+                    yyval = newDeclNode(VarK);                                             
+                    yyval->attr.name = copyString(yyvsp[-1]->attr.name);
+                    yyval->type = yyvsp[-2]->type;
+                    yyval->lineno = lineno;
+                    free(yyvsp[-2]); free(yyvsp[-1]);
+                }
+#line 1389 "y.tab.c"
+    break;
+
+  case 12: /* var_declaration: type_specifier identifier LBRACE number RBRACE SEMI  */
+#line 93 "cminus.y"
+                {
+                yyval = newDeclNode(VarK);
+                yyval->lineno = yyvsp[-4]->lineno;
+                yyval->child[0] = yyvsp[-2];
+                
+                if (yyvsp[-5]->type == Integer){
+                    yyval->type = IntegerArray;
+                }
+                else{
+                    yyval->type =VoidArray;  
+                }
+
+                yyval->attr.name = yyvsp[-4]->attr.name;
+
+                free(yyvsp[-5]); free(yyvsp[-4]);
+                }
+#line 1410 "y.tab.c"
+    break;
+
+  case 13: /* fun_declaration: type_specifier identifier LPAREN params RPAREN compound_stmt  */
+#line 112 "cminus.y"
+                  {
+                    yyval = newDeclNode(FunK);
+                    yyval->child[0] = yyvsp[-2];
+                    yyval->child[1] = yyvsp[0];
+                    yyval->lineno = lineno;
+                    yyval->type = yyvsp[-5]->type;
+                    yyval->attr.name = copyString(yyvsp[-4]->attr.name);
+                  }
+#line 1423 "y.tab.c"
+    break;
+
+  case 14: /* params: param_list  */
+#line 123 "cminus.y"
+                    {yyval = yyvsp[0];}
+#line 1429 "y.tab.c"
+    break;
+
+  case 15: /* params: VOID  */
+#line 125 "cminus.y"
+        {
+          yyval = newDeclNode(ParamK);
+          yyval->type = Void;
+          yyval->lineno = lineno;
+        }
+#line 1439 "y.tab.c"
+    break;
+
+  case 16: /* param_list: param_list COMMA param  */
+#line 133 "cminus.y"
+            { YYSTYPE t = yyvsp[-2];
+              if (t != NULL) {
+                 while (t->sibling != NULL) { t = t->sibling; }
+                 t->sibling = yyvsp[0];
+                 yyval = yyvsp[-2];
+               } else {
+                 yyval = yyvsp[0];
+               }
+            }
+#line 1453 "y.tab.c"
+    break;
+
+  case 17: /* param_list: param  */
+#line 142 "cminus.y"
+                    {yyval = yyvsp[0];}
+#line 1459 "y.tab.c"
+    break;
+
+  case 18: /* param: type_specifier identifier  */
+#line 146 "cminus.y"
+        {
+          yyval = newDeclNode(ParamK);
+          yyval->type = yyvsp[-1]->type;
+          yyval->attr.name = yyvsp[0]->attr.name;
+          yyval->lineno = lineno; 
+        }
+#line 1470 "y.tab.c"
+    break;
+
+  case 19: /* param: type_specifier identifier LBRACE RBRACE  */
+#line 153 "cminus.y"
+        {
+          yyval = newDeclNode(ParamK);
+          yyval->type = yyvsp[-3]->type == Integer ? IntegerArray : VoidArray;
+          yyval->attr.name = yyvsp[-2]->attr.name;
+          yyval->lineno = lineno;
+        }
+#line 1481 "y.tab.c"
+    break;
+
+  case 20: /* compound_stmt: LCURLY local_declarations statement_list RCURLY  */
+#line 162 "cminus.y"
+        {
+            yyval = newStmtNode(CompK);
+            yyval->child[0] = yyvsp[-2]; 
+            yyval->child[1] = yyvsp[-1];
+            yyval->lineno = lineno;
+        }
+#line 1492 "y.tab.c"
+    break;
+
+  case 21: /* local_declarations: local_declarations var_declaration  */
+#line 172 "cminus.y"
+        {
+            YYSTYPE t = yyvsp[-1];
+            if (t != NULL) {
+                while (t->sibling != NULL) 
+                t = t->sibling;
+                t->sibling = yyvsp[0];
+                yyval = yyvsp[-1];
+            } else yyval = yyvsp[0];
+        }
+#line 1506 "y.tab.c"
+    break;
+
+  case 22: /* local_declarations: %empty  */
+#line 182 "cminus.y"
+        {
+            yyval = NULL;
+        }
+#line 1514 "y.tab.c"
+    break;
+
+  case 23: /* statement_list: statement_list statement  */
+#line 188 "cminus.y"
+            {
+                 YYSTYPE temp = yyvsp[-1];
+                   if(temp == NULL){
+                        yyval = yyvsp[0];
+                   }
+                   else{
+                        while (temp->sibling != NULL)
+                            temp = temp->sibling;
+                        temp->sibling = yyvsp[0];
+                        yyval = yyvsp[-1]; 
+                   }
+              }
+#line 1531 "y.tab.c"
+    break;
+
+  case 24: /* statement_list: %empty  */
+#line 200 "cminus.y"
+              { 
+                yyval = NULL;
+                }
+#line 1539 "y.tab.c"
+    break;
+
+  case 25: /* statement: expression_stmt  */
+#line 206 "cminus.y"
+                      { yyval = yyvsp[0]; }
+#line 1545 "y.tab.c"
+    break;
+
+  case 26: /* statement: compound_stmt  */
+#line 207 "cminus.y"
+                    { yyval = yyvsp[0]; }
+#line 1551 "y.tab.c"
+    break;
+
+  case 27: /* statement: selection_stmt  */
+#line 208 "cminus.y"
+                     { yyval = yyvsp[0]; }
+#line 1557 "y.tab.c"
+    break;
+
+  case 28: /* statement: iteration_stmt  */
+#line 209 "cminus.y"
+                     { yyval = yyvsp[0]; }
+#line 1563 "y.tab.c"
+    break;
+
+  case 29: /* statement: return_stmt  */
+#line 210 "cminus.y"
+                  { yyval = yyvsp[0]; }
+#line 1569 "y.tab.c"
+    break;
+
+  case 30: /* expression_stmt: expression SEMI  */
+#line 215 "cminus.y"
+        {
+            yyval = yyvsp[-1];
+        }
+#line 1577 "y.tab.c"
+    break;
+
+  case 31: /* expression_stmt: SEMI  */
+#line 219 "cminus.y"
+        {
+            yyval = NULL; // Empty statement
+        }
+#line 1585 "y.tab.c"
+    break;
+
+  case 32: /* selection_stmt: IF LPAREN expression RPAREN statement ELSE statement  */
+#line 226 "cminus.y"
+        {
+            yyval = newStmtNode(IfK);
+            yyval->child[0] = yyvsp[-4]; // Condition
+            yyval->child[1] = yyvsp[-2]; // Then-Statement
+            yyval->child[2] = yyvsp[0]; // Else-Statement
+            yyval->lineno = lineno;
+        }
+#line 1597 "y.tab.c"
+    break;
+
+  case 33: /* selection_stmt: IF LPAREN expression RPAREN statement  */
+#line 234 "cminus.y"
+        {
+            yyval = newStmtNode(IfK);
+            yyval->child[0] = yyvsp[-2];
+            yyval->child[1] = yyvsp[0]; 
+            yyval->child[2] = NULL;
+            yyval->lineno = lineno;
+        }
+#line 1609 "y.tab.c"
+    break;
+
+  case 34: /* iteration_stmt: WHILE LPAREN expression RPAREN statement  */
+#line 245 "cminus.y"
+        {
+            yyval = newStmtNode(WhileK);
+            yyval->child[0] = yyvsp[-2]; // Condition
+            yyval->child[1] = yyvsp[0]; // Loop Body
+            yyval->lineno = lineno;
+        }
+#line 1620 "y.tab.c"
+    break;
+
+  case 35: /* return_stmt: RETURN SEMI  */
+#line 255 "cminus.y"
+        {
+            yyval = newStmtNode(ReturnK);
+            yyval->lineno = lineno;
+        }
+#line 1629 "y.tab.c"
+    break;
+
+  case 36: /* return_stmt: RETURN expression SEMI  */
+#line 260 "cminus.y"
+        {
+            yyval = newStmtNode(ReturnK);
+            yyval->child[0] = yyvsp[-1]; // Return Value
+            yyval->lineno = lineno;
+        }
+#line 1639 "y.tab.c"
+    break;
+
+  case 37: /* expression: var ASSIGN expression  */
+#line 269 "cminus.y"
+        {
+            yyval = newExpNode(AssignK);
+            yyval->child[0] = yyvsp[-2]; 
+            yyval->child[1] = yyvsp[0]; 
+            yyval->lineno = lineno;
+        }
+#line 1650 "y.tab.c"
+    break;
+
+  case 38: /* expression: simple_expression  */
+#line 276 "cminus.y"
+    {
+        yyval = yyvsp[0];
+    }
+#line 1658 "y.tab.c"
+    break;
+
+  case 39: /* var: identifier  */
+#line 282 "cminus.y"
+        {
+            yyval = newExpNode(IdK);
+            yyval->attr.name = yyvsp[0]->attr.name;
+            yyval->lineno = yyvsp[0]->lineno;
+        }
+#line 1668 "y.tab.c"
+    break;
+
+  case 40: /* var: identifier LBRACE expression RBRACE  */
+#line 288 "cminus.y"
+        {
+            yyval = newExpNode(IdK);
+            yyval->attr.name = copyString(yyvsp[-3]->attr.name);
+            yyval->child[0] = yyvsp[-1];
+            yyval->child[0]->attr.name = yyvsp[-1]->attr.name;
+            yyval->lineno = lineno;
+        }
+#line 1680 "y.tab.c"
+    break;
+
+  case 41: /* simple_expression: additive_expression relop additive_expression  */
+#line 299 "cminus.y"
+        {
+            yyval = newExpNode(OpK);
+            yyval->attr.op = yyvsp[-1]->attr.op; 
+            yyval->child[0] = yyvsp[-2]; 
+            yyval->child[1] = yyvsp[0]; 
+            yyval->lineno = yyvsp[-2]->lineno;
+        }
+#line 1692 "y.tab.c"
+    break;
+
+  case 42: /* simple_expression: additive_expression  */
+#line 307 "cminus.y"
+        {
+            yyval = yyvsp[0];
+        }
+#line 1700 "y.tab.c"
+    break;
+
+  case 43: /* relop: EQ  */
+#line 313 "cminus.y"
+         { 
+        yyval = newExpNode(OpK);
+        yyval->attr.op = EQ;
+        }
+#line 1709 "y.tab.c"
+    break;
+
+  case 44: /* relop: NE  */
+#line 317 "cminus.y"
+         { 
+        yyval = newExpNode(OpK);
+        yyval->attr.op = NE; }
+#line 1717 "y.tab.c"
+    break;
+
+  case 45: /* relop: LT  */
+#line 320 "cminus.y"
+         { 
+        yyval = newExpNode(OpK);
+        yyval->attr.op = LT; }
+#line 1725 "y.tab.c"
+    break;
+
+  case 46: /* relop: LE  */
+#line 323 "cminus.y"
+         { 
+        yyval = newExpNode(OpK);
+        yyval->attr.op = LE; }
+#line 1733 "y.tab.c"
+    break;
+
+  case 47: /* relop: GT  */
+#line 326 "cminus.y"
+        { 
+        yyval = newExpNode(OpK);
+        yyval->attr.op = GT; }
+#line 1741 "y.tab.c"
+    break;
+
+  case 48: /* relop: GE  */
+#line 329 "cminus.y"
+         { 
+        yyval = newExpNode(OpK);
+        yyval->attr.op = GE; }
+#line 1749 "y.tab.c"
+    break;
+
+  case 49: /* additive_expression: additive_expression addop term  */
+#line 336 "cminus.y"
+        {
+            yyval = newExpNode(OpK);
+            yyval->attr.op = yyvsp[-1]; 
+            yyval->child[0] = yyvsp[-2]; 
+            yyval->child[1] = yyvsp[0]; 
+            yyval->lineno = yyvsp[-2]->lineno;
+        }
+#line 1761 "y.tab.c"
+    break;
+
+  case 50: /* additive_expression: term  */
+#line 344 "cminus.y"
+        {
+            yyval = yyvsp[0];
+        }
+#line 1769 "y.tab.c"
+    break;
+
+  case 51: /* addop: PLUS  */
+#line 350 "cminus.y"
+           { yyval = PLUS; }
+#line 1775 "y.tab.c"
+    break;
+
+  case 52: /* addop: MINUS  */
+#line 351 "cminus.y"
+            { yyval = MINUS; }
+#line 1781 "y.tab.c"
+    break;
+
+  case 53: /* term: term mulop factor  */
+#line 356 "cminus.y"
+        {
+            yyval = newExpNode(OpK);
+            yyval->attr.op = yyvsp[-1]; // Multiplicative operator
+            yyval->child[0] = yyvsp[-2]; // Left operand
+            yyval->child[1] = yyvsp[0]; // Right operand
+            yyval->lineno = lineno;
+        }
+#line 1793 "y.tab.c"
+    break;
+
+  case 54: /* term: factor  */
+#line 364 "cminus.y"
+        {
+            yyval = yyvsp[0];
+        }
+#line 1801 "y.tab.c"
+    break;
+
+  case 55: /* mulop: TIMES  */
+#line 370 "cminus.y"
+            { yyval = TIMES; }
+#line 1807 "y.tab.c"
+    break;
+
+  case 56: /* mulop: OVER  */
+#line 371 "cminus.y"
+           { yyval = OVER; }
+#line 1813 "y.tab.c"
+    break;
+
+  case 57: /* factor: LPAREN expression RPAREN  */
+#line 376 "cminus.y"
+        {
+            yyval = yyvsp[-1];
+        }
+#line 1821 "y.tab.c"
+    break;
+
+  case 58: /* factor: var  */
+#line 380 "cminus.y"
+        {
+            yyval = yyvsp[0];
+        }
+#line 1829 "y.tab.c"
+    break;
+
+  case 59: /* factor: call  */
+#line 384 "cminus.y"
+        {
+            yyval = yyvsp[0];
+        }
+#line 1837 "y.tab.c"
+    break;
+
+  case 60: /* factor: NUM  */
+#line 388 "cminus.y"
+    {
+        yyval = newExpNode(ConstK);
+        yyval->lineno = lineno;
+        yyval->attr.val = atoi(tokenString);
+        yyval->type = Integer;
+    }
+#line 1848 "y.tab.c"
+    break;
+
+  case 61: /* call: identifier LPAREN args RPAREN  */
+#line 398 "cminus.y"
+        {
+            yyval = newExpNode(CallK);
+            yyval->attr.name = yyvsp[-3]->attr.name;
+            yyval->child[0] = yyvsp[-1]; 
+            yyval->lineno = lineno;
+        }
+#line 1859 "y.tab.c"
+    break;
+
+  case 62: /* args: arg_list  */
+#line 407 "cminus.y"
+               { yyval = yyvsp[0]; }
+#line 1865 "y.tab.c"
+    break;
+
+  case 63: /* args: %empty  */
+#line 409 "cminus.y"
+        {
+            yyval = NULL;
+        }
+#line 1873 "y.tab.c"
+    break;
+
+  case 64: /* arg_list: arg_list COMMA expression  */
+#line 416 "cminus.y"
+        {
+            YYSTYPE t = yyvsp[-2];
+            if (t != NULL) {
+                while (t->sibling != NULL) t = t->sibling;
+                t->sibling = yyvsp[0];
+                yyval = yyvsp[-2];
+            } else yyval = yyvsp[0];
+        }
+#line 1886 "y.tab.c"
+    break;
+
+  case 65: /* arg_list: expression  */
+#line 425 "cminus.y"
+        {
+            yyval = yyvsp[0];
+        }
+#line 1894 "y.tab.c"
+    break;
+
+
+#line 1898 "y.tab.c"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      yyerror (YY_("syntax error"));
+    }
+
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+
+  return yyresult;
+}
+
+#line 434 "cminus.y"
+
+
+int yyerror(char * message)
+{ fprintf(listing,"Syntax error at line %d: %s\n",lineno,message);
+  fprintf(listing,"Current token: ");
+  printToken(yychar,tokenString);
+  Error = TRUE;
+  return 0;
+}
+
+/* yylex calls getToken to make Yacc/Bison output
+ * compatible with ealier versions of the TINY scanner
+ */
+static int yylex(void)
+{  
+    return getToken();
+}
+
+TreeNode * parse(void)
+{ yyparse();
+  return savedTree;
+}
+